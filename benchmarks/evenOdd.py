@@ -0,0 +1,64 @@
+"""
+Benchmark the even-odd preconditioner for iterative solves of M.
+"""
+
+import timeit
+import pickle
+
+import numpy as np
+
+import isle
+
+LEVELS = (0, 1, 2, 3)
+LATTICES = ("four_sites", "c20", "c60_ipr", "graphene_7_5")
+NT = 32
+BETA = 4
+UTILDE = 2
+TOLERANCE = 1e-10
+NREP = 3
+
+
+def level_scaling():
+    "Benchmark iteration count and time to solution with the number of levels."
+
+    iterations = {}
+    times = {}
+    for name in LATTICES:
+        print(f"lat = {name}")
+        lat = isle.LATTICES[name]
+        nx = lat.nx()
+
+        # make random auxilliary field, right hand side, and HFM
+        phi = isle.Vector(np.random.randn(nx*NT)*np.sqrt(UTILDE/NT)+0j)
+        rhs = isle.Vector(np.random.randn(nx*NT) + 1j*np.random.randn(nx*NT))
+        hfm = isle.HubbardFermiMatrixExp(lat.hopping()*BETA/NT, 0, -1)
+
+        # levels=0 is the unpreconditioned system M
+        iterations[name] = []
+        times[name] = []
+        for levels in LEVELS:
+            eo = isle.EvenOddPreconditioner(hfm, phi, isle.Species.PARTICLE, levels)
+            iterations[name].append(eo.solve(rhs, TOLERANCE)[1].iterations)
+            times[name].append(np.min(timeit.repeat(
+                "eo.solve(rhs, TOLERANCE)",
+                globals={"eo": eo, "rhs": rhs, "TOLERANCE": TOLERANCE},
+                number=NREP, repeat=3)) / NREP)
+
+    # save benchmarks to files
+    pickle.dump({"xlabel": "levels",
+                 "ylabel": "iterations",
+                 "xvalues": LEVELS,
+                 "results": iterations},
+                open("evenOdd_iterations.ben", "wb"))
+    pickle.dump({"xlabel": "levels",
+                 "ylabel": "time / s",
+                 "xvalues": LEVELS,
+                 "results": times},
+                open("evenOdd_time.ben", "wb"))
+
+
+def main():
+    level_scaling()
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,54 @@
+"""
+Benchmark delayed updates in local Metropolis sweeps.
+"""
+
+import timeit
+import pickle
+
+import numpy as np
+
+import isle
+
+DELAYS = (1, 2, 4, 8, 16, 32, 64)
+NT = 16
+BETA = 4
+UTILDE = 2
+MAX_STEP = 0.5
+NREP = 3
+
+
+def delay_scaling():
+    "Benchmark scaling with the number of delayed updates."
+
+    times = {}
+    for name in ("c60_ipr", "graphene_7_5"):
+        print(f"lat = {name}")
+        lat = isle.LATTICES[name]
+        lat.nt(NT)
+        nx = lat.nx()
+
+        # make random auxilliary field and local updater
+        phi = isle.Vector(np.random.randn(nx*NT)*np.sqrt(UTILDE/NT)+0j)
+        hfm = isle.HubbardFermiMatrixExp(lat, BETA, 0, -1)
+
+        times[name] = []
+        for delay in DELAYS:
+            updater = isle.LocalUpdate(hfm, UTILDE/NT, 4, delay)
+            times[name].append(np.min(timeit.repeat(
+                "updater.sweep(phi, 1, MAX_STEP, 123)",
+                globals={"updater": updater, "phi": phi, "MAX_STEP": MAX_STEP},
+                number=NREP, repeat=3)) / NREP)
+
+    # save benchmark to file
+    pickle.dump({"xlabel": "delay",
+                 "ylabel": "time / s",
+                 "xvalues": DELAYS,
+                 "results": times},
+                open("localUpdate.ben", "wb"))
+
+
+def main():
+    delay_scaling()
+
+if __name__ == "__main__":
+    main()
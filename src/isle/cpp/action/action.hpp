@@ -5,6 +5,9 @@
 #ifndef ACTION_ACTION_HPP
 #define ACTION_ACTION_HPP
 
+#include <cstdint>
+#include <utility>
+
 #include "../math.hpp"
 
 namespace isle {
@@ -19,6 +22,72 @@ namespace isle {
 
             /// Calculate force for given auxilliary field phi.
             virtual Vector<std::complex<double>> force(const Vector<std::complex<double>> &phi) const = 0;
+
+            /// Evaluate the %Action and calculate the force for given auxilliary field phi.
+            /**
+             * Derived classes should override this function if they can share work
+             * between eval() and force(). The default implementation calls both in turn.
+             * \returns Pair of value of the action and force.
+             */
+            virtual std::pair<std::complex<double>, Vector<std::complex<double>>> evalAndForce(
+                const Vector<std::complex<double>> &phi) const {
+
+                return {eval(phi), force(phi)};
+            }
+
+            /// Return true if the %Action depends on pseudofermion fields.
+            /**
+             * Pseudofermions have to be drawn anew at the beginning of each
+             * molecular dynamics trajectory using refreshPseudofermions().
+             * The default implementation returns false.
+             */
+            virtual bool hasPseudofermions() const {
+                return false;
+            }
+
+            /// Draw new pseudofermion fields for given auxilliary field phi.
+            /**
+             * Changes the value of the %Action, so it has to be re-evaluated afterwards.
+             * The default implementation does nothing.
+             * \param phi Auxilliary field at the beginning of the trajectory.
+             * \param seed Seed for the random number generator.
+             */
+            virtual void refreshPseudofermions(const Vector<std::complex<double>> &UNUSED(phi),
+                                               const std::uint64_t UNUSED(seed)) { }
+
+            /// Evaluate the %Action for many configurations.
+            /**
+             * The default implementation calls eval() for each configuration in turn.
+             * \param phis Auxilliary fields, one configuration per row.
+             * \returns Vector with one value of the action per configuration.
+             */
+            virtual Vector<std::complex<double>> evalBatch(
+                const Matrix<std::complex<double>> &phis) const {
+
+                Vector<std::complex<double>> res(phis.rows());
+                for (std::size_t i = 0; i < phis.rows(); ++i) {
+                    const Vector<std::complex<double>> phi = blaze::trans(blaze::row(phis, i));
+                    res[i] = eval(phi);
+                }
+                return res;
+            }
+
+            /// Calculate force for many configurations.
+            /**
+             * The default implementation calls force() for each configuration in turn.
+             * \param phis Auxilliary fields, one configuration per row.
+             * \returns Matrix of forces with the same shape as `phis`.
+             */
+            virtual Matrix<std::complex<double>> forceBatch(
+                const Matrix<std::complex<double>> &phis) const {
+
+                Matrix<std::complex<double>> res(phis.rows(), phis.columns());
+                for (std::size_t i = 0; i < phis.rows(); ++i) {
+                    const Vector<std::complex<double>> phi = blaze::trans(blaze::row(phis, i));
+                    blaze::row(res, i) = blaze::trans(force(phi));
+                }
+                return res;
+            }
         };
     }  // namespace action
 }  // namespace isle
@@ -1,6 +1,12 @@
 #include "hubbardFermiAction.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <random>
+
 #include "../core.hpp"
+#include "../krylov.hpp"
+#include "../stabilizedProduct.hpp"
 #include "../logging/logging.hpp"
 
 using namespace std::complex_literals;
@@ -8,14 +14,57 @@ using namespace std::complex_literals;
 namespace isle {
     namespace action {
         namespace {
+            /// Multiply F onto a matrix using a workspace for the product.
+            void applyF(const HubbardFermiMatrixExp &hfm, CDMatrix &mat,
+                        const std::size_t t, const CDVector &phi,
+                        const Species species, const bool inv, const Side side,
+                        CDMatrix &workspace) {
+                hfm.applyF(mat, t, phi, species, inv, side, workspace);
+            }
+
+            /// Multiply F onto a matrix, works in place without a workspace.
+            template <typename HFM>
+            void applyF(const HFM &hfm, CDMatrix &mat,
+                        const std::size_t t, const CDVector &phi,
+                        const Species species, const bool inv, const Side side,
+                        CDMatrix &UNUSED(workspace)) {
+                hfm.applyF(mat, t, phi, species, inv, side);
+            }
+
+            /// Multiply the pair F K onto a matrix, K is the identity for EXP discretization.
+            void applyFK(const HubbardFermiMatrixExp &hfm, CDMatrix &mat,
+                         const std::size_t t, const CDVector &phi,
+                         const Species species, const bool inv, const Side side,
+                         CDMatrix &workspace) {
+                hfm.applyF(mat, t, phi, species, inv, side, workspace);
+            }
+
+            /// Multiply the pair F K onto a matrix.
+            void applyFK(const HubbardFermiMatrixDia &hfm, CDMatrix &mat,
+                         const std::size_t t, const CDVector &phi,
+                         const Species species, const bool inv, const Side side,
+                         CDMatrix &UNUSED(workspace)) {
+                hfm.applyFK(mat, t, phi, species, inv, side);
+            }
+
+            /// Multiply the pair F K onto a matrix, K is the identity for CHECKERBOARD discretization.
+            void applyFK(const HubbardFermiMatrixCheckerboard &hfm, CDMatrix &mat,
+                         const std::size_t t, const CDVector &phi,
+                         const Species species, const bool inv, const Side side,
+                         CDMatrix &UNUSED(workspace)) {
+                hfm.applyF(mat, t, phi, species, inv, side);
+            }
+
             /// Calculate force w/o -i using the DIRECT_SINGLE algorithm for either particles or holes.
             /*
              * Constructs all partial A^-1 to the left of (1+A^-1)^-1 first ('left').
              * Constructs rest on the fly ('right', contains (1+A^-1)^-1).
+             * Stores log(det(1+A^-1)) in logdetOnePlusAinv unless it is nullptr.
              */
             template <typename HFM, typename KMatrix>
             CDVector forceDirectSinglePart(const HFM &hfm, const CDVector &phi,
-                                           const KMatrix &k, const Species species) {
+                                           const KMatrix &k, const Species species,
+                                           std::complex<double> *const logdetOnePlusAinv) {
 
                 const auto nx = hfm.nx();
                 const auto nt = getNt(phi, nx);
@@ -28,21 +77,24 @@ namespace isle {
                 lefts.reserve(nt-1);  // not storing full A^-1 here
 
                 // first term for tau = nt-2
-                auto f = hfm.F(nt-1, phi, species, true);
-                lefts.emplace_back(f*k);
+                lefts.emplace_back(hfm.F(nt-1, phi, species, true)*k);
                 // other terms
+                CDMatrix workspace;
                 for (std::size_t t = nt-2; t != 0; --t) {
-                    hfm.F(f, t, phi, species, true);
-                    lefts.emplace_back(f*k*lefts.back());
+                    lefts.emplace_back(lefts.back());
+                    applyFK(hfm, lefts.back(), t, phi, species, true, Side::LEFT, workspace);
                 }
                 // full A^-1
-                hfm.F(f, 0, phi, species, true);
-                const CDMatrix Ainv = f * k * lefts.back();
+                CDMatrix Ainv = lefts.back();
+                applyFK(hfm, Ainv, 0, phi, species, true, Side::LEFT, workspace);
 
                 // start right with (1+A^-1)^-1
                 CDMatrix right = IdMatrix<std::complex<double>>(nx) + Ainv;
                 auto ipiv = std::make_unique<int[]>(right.rows());
-                invert(right, ipiv);
+                blaze::getrf(right, ipiv.get());
+                if (logdetOnePlusAinv)
+                    *logdetOnePlusAinv = logdetFromLU(right, ipiv.get());
+                blaze::getri(right, ipiv.get());
 
                 CDVector force(nx*nt);  // the result
 
@@ -51,57 +103,347 @@ namespace isle {
 
                 // all sites except tau = nt-1
                 for (std::size_t tau = 0; tau < nt-1; ++tau) {
-                    hfm.F(f, tau, phi, species, true);
-                    right = right * f * k;
+                    applyFK(hfm, right, tau, phi, species, true, Side::RIGHT, workspace);
                     spacevec(force, tau, nx) = blaze::diagonal(lefts[nt-1-tau-1]*right);
                 }
 
                 return force;
             }
 
+            /// Multiply a matrix by K^-1 from the left, K is the identity for EXP discretization.
+            void leftMultiplyKinv(const HubbardFermiMatrixExp &UNUSED(hfm),
+                                  const Species UNUSED(species),
+                                  CDMatrix &UNUSED(mat)) { }
+
+            /// Multiply a matrix by K^-1 from the left, K is the identity for CHECKERBOARD discretization.
+            void leftMultiplyKinv(const HubbardFermiMatrixCheckerboard &UNUSED(hfm),
+                                  const Species UNUSED(species),
+                                  CDMatrix &UNUSED(mat)) { }
+
+            /// Multiply a matrix by K^-1 from the left.
+            void leftMultiplyKinv(const HubbardFermiMatrixDia &hfm,
+                                  const Species species,
+                                  CDMatrix &mat) {
+                mat = hfm.Kinv(species) * mat;
+            }
+
+            /// Calculate force w/o -i using a stabilized DIRECT_SINGLE algorithm.
+            /*
+             * The force on time slice tau is diag(1 - G_tau) with the equal time
+             * propagator G_tau = (1 + C_tau)^-1 and the cyclic product
+             * C_tau = P_{tau+1} ... P_{nt-1} P_0 ... P_tau, P_t = F_t^-1 K.
+             * Slices are grouped into chunks of 'interval' slices.
+             * At the last slice of each chunk, G_tau is computed from scratch using a
+             * StabilizedProduct of the chunks. On all other slices, it is obtained by
+             * wrapping G_tau = P_tau^-1 G_{tau-1} P_tau.
+             * Stores log(det(1+A^-1)) in logdetOnePlusAinv unless it is nullptr.
+             */
+            template <typename HFM, typename KMatrix>
+            CDVector forceDirectSinglePartStabilized(const HFM &hfm, const CDVector &phi,
+                                                     const KMatrix &k, const Species species,
+                                                     const std::size_t interval,
+                                                     std::complex<double> *const logdetOnePlusAinv) {
+
+                const auto nx = hfm.nx();
+                const auto nt = getNt(phi, nx);
+
+                // products of transposed P's in each chunk
+                // (G is built from the transposed product because P's multiply from the right)
+                const std::size_t nchunk = (nt + interval - 1) / interval;
+                std::vector<CDMatrix> chunks;
+                chunks.reserve(nchunk);
+                CDMatrix chunk, workspace;
+                for (std::size_t c = 0; c < nchunk; ++c) {
+                    const std::size_t end = std::min((c+1)*interval, nt);
+                    chunk = hfm.F(c*interval, phi, species, true)*k;
+                    for (std::size_t t = c*interval+1; t < end; ++t)
+                        applyFK(hfm, chunk, t, phi, species, true, Side::RIGHT, workspace);
+                    chunks.emplace_back(blaze::trans(chunk));
+                }
+
+                // compute G at the last slice of chunk c from scratch
+                StabilizedProduct prod{nx, 1};
+                const auto greens = [&](const std::size_t c) {
+                    prod.reset();
+                    for (std::size_t i = 1; i <= nchunk; ++i)
+                        prod.leftMultiply(chunks[(c+i) % nchunk]);
+                    return CDMatrix(blaze::trans(prod.invOnePlus()));
+                };
+
+                CDVector force(nx*nt);  // the result
+                const auto storeForce = [&](const std::size_t tau, const CDMatrix &g) {
+                    for (std::size_t x = 0; x < nx; ++x)
+                        force[tau*nx + x] = 1.0 - g(x, x);
+                };
+
+                // first term, tau = nt-1
+                CDMatrix g = greens(nchunk-1);
+                storeForce(nt-1, g);
+                if (logdetOnePlusAinv)
+                    // prod holds the transpose of A^-1 = C_{nt-1}
+                    *logdetOnePlusAinv = prod.logdetOnePlus();
+
+                // all sites except tau = nt-1
+                for (std::size_t tau = 0; tau < nt-1; ++tau) {
+                    if ((tau+1) % interval == 0) {
+                        g = greens(tau / interval);
+                    }
+                    else {
+                        // G_tau = K^-1 F_tau G_{tau-1} F_tau^-1 K
+                        applyF(hfm, g, tau, phi, species, false, Side::LEFT, workspace);
+                        applyFK(hfm, g, tau, phi, species, true, Side::RIGHT, workspace);
+                        leftMultiplyKinv(hfm, species, g);
+                    }
+                    storeForce(tau, g);
+                }
+
+                return force;
+            }
+
+            /// Matrix B in F_t^-1 K = diag(phase_t) B in single precision, B = exp(kappa)^-1 for EXP.
+            CFMatrix singlePrecisionHopping(const HubbardFermiMatrixExp &hfm, const Species species) {
+                return blaze::map(hfm.expKappa(species, true), [](const double x) {
+                    return std::complex<float>{static_cast<float>(x)};
+                });
+            }
+
+            /// Matrix B in F_t^-1 K = diag(phase_t) B in single precision, B = dense Trotterised exp(kappa)^-1.
+            CFMatrix singlePrecisionHopping(const HubbardFermiMatrixCheckerboard &hfm, const Species species) {
+                return blaze::map(hfm.expKappa(species, true), [](const double x) {
+                    return std::complex<float>{static_cast<float>(x)};
+                });
+            }
+
+            /// Matrix B in F_t^-1 K = diag(phase_t) B in single precision, B = K for DIA.
+            FSparseMatrix singlePrecisionHopping(const HubbardFermiMatrixDia &hfm, const Species species) {
+                return blaze::map(hfm.K(species), [](const double x) {
+                    return static_cast<float>(x);
+                });
+            }
+
+            /// Diagonal of F_t^-1 in single precision.
+            CFVector singlePrecisionPhase(const CDVector &phi, const std::size_t t,
+                                          const std::size_t nx, const Species species) {
+                const std::size_t nt = getNt(phi, nx);
+                const std::size_t tm1 = t==0 ? nt-1 : t-1;
+                const auto sign = species == Species::PARTICLE ? -1.i : +1.i;
+                return blaze::map(spacevec(phi, tm1, nx), [sign](const std::complex<double> x) {
+                    return std::complex<float>(std::exp(sign*x));
+                });
+            }
+
+            /// Calculate force w/o -i using the DIRECT_SINGLE algorithm in single precision.
+            /*
+             * Same as the double precision version but all nx x nx matrices are
+             * in complex<float>.
+             * Uses F_t^-1 K = diag(phase_t) B with a constant B in both discretizations.
+             * Only the result is converted back to double.
+             */
+            template <typename HFM>
+            CDVector forceDirectSinglePartFloat(const HFM &hfm, const CDVector &phi,
+                                                const Species species) {
+
+                const auto nx = hfm.nx();
+                const auto nt = getNt(phi, nx);
+
+                if (nt < 2)
+                    throw std::invalid_argument("nt < 2 in HubbardFermiAction algorithm DIRECT_SINGLE not supported");
+
+                const auto b = singlePrecisionHopping(hfm, species);
+                std::vector<CFVector> phases(nt);
+                for (std::size_t t = 0; t < nt; ++t)
+                    phases[t] = singlePrecisionPhase(phi, t, nx, species);
+
+                // build A^-1 and partial products on the left of (1+A^-1)^-1
+                std::vector<CFMatrix> lefts;  // in reverse order
+                lefts.reserve(nt-1);  // not storing full A^-1 here
+
+                // first term for tau = nt-2
+                lefts.emplace_back(b);
+                scaleRows(lefts.back(), phases[nt-1]);
+                // other terms
+                for (std::size_t t = nt-2; t != 0; --t) {
+                    lefts.emplace_back(b*lefts.back());
+                    scaleRows(lefts.back(), phases[t]);
+                }
+                // full A^-1
+                CFMatrix Ainv = b*lefts.back();
+                scaleRows(Ainv, phases[0]);
+
+                // start right with (1+A^-1)^-1
+                CFMatrix right = IdMatrix<std::complex<float>>(nx) + Ainv;
+                auto ipiv = std::make_unique<int[]>(right.rows());
+                blaze::getrf(right, ipiv.get());
+                blaze::getri(right, ipiv.get());
+
+                CDVector force(nx*nt);  // the result
+                const auto storeForce = [&](const std::size_t tau, const CFMatrix &lhs) {
+                    const CFVector diag = blaze::diagonal(lhs*right);
+                    for (std::size_t x = 0; x < nx; ++x)
+                        force[tau*nx + x] = std::complex<double>(diag[x]);
+                };
+
+                // first term, tau = nt-1
+                storeForce(nt-1, Ainv);
+
+                // all sites except tau = nt-1
+                for (std::size_t tau = 0; tau < nt-1; ++tau) {
+                    scaleColumns(right, phases[tau]);
+                    right = right*b;
+                    storeForce(tau, lefts[nt-1-tau-1]);
+                }
+
+                return force;
+            }
+
+            /// Calculate force w/o -i using the DIRECT_SINGLE algorithm.
+            /*
+             * Is stabilized if interval > 0 and computed in single precision if
+             * singlePrecision is true.
+             * Stores log(det(1+A^-1)) in logdetOnePlusAinv unless it is nullptr,
+             * this is not supported in single precision.
+             */
+            template <typename HFM, typename KMatrix>
+            CDVector forceDirectSinglePart(const HFM &hfm, const CDVector &phi,
+                                           const KMatrix &k, const Species species,
+                                           const std::size_t interval,
+                                           const bool singlePrecision,
+                                           std::complex<double> *const logdetOnePlusAinv=nullptr) {
+                if (singlePrecision) {
+                    if (logdetOnePlusAinv)
+                        throw std::invalid_argument("Cannot compute log(det(1+A^-1)) in single precision force");
+                    return forceDirectSinglePartFloat(hfm, phi, species);
+                }
+                if (interval == 0)
+                    return forceDirectSinglePart(hfm, phi, k, species, logdetOnePlusAinv);
+                return forceDirectSinglePartStabilized(hfm, phi, k, species, interval,
+                                                       logdetOnePlusAinv);
+            }
+
+            /// Sum of log(det(F)) over all time slices without the contribution from phi.
+            std::complex<double> logdetFWithoutPhi(const HubbardFermiMatrixExp &hfm,
+                                                   const Species species,
+                                                   const std::size_t nt) {
+                return -static_cast<double>(nt)*hfm.logdetExpKappa(species, true);
+            }
+
+            /// Sum of log(det(F)) over all time slices without the contribution from phi.
+            std::complex<double> logdetFWithoutPhi(const HubbardFermiMatrixCheckerboard &hfm,
+                                                   const Species species,
+                                                   const std::size_t nt) {
+                return -static_cast<double>(nt)*hfm.logdetExpKappa(species, true);
+            }
+
+            /// Sum of log(det(F)) over all time slices without the contribution from phi.
+            std::complex<double> logdetFWithoutPhi(const HubbardFermiMatrixDia &UNUSED(hfm),
+                                                   const Species UNUSED(species),
+                                                   const std::size_t UNUSED(nt)) {
+                return 0;
+            }
+
+            /// Calculate log(det(M)) and the force w/o -i using the DIRECT_SINGLE algorithm.
+            /*
+             * Uses log(det(M)) = log(det(A)) + log(det(1+A^-1)) in order to
+             * re-use the LU-decomposition of (1+A^-1) from the force.
+             * If the force is computed in single precision, log(det(M)) is computed
+             * separately in double precision.
+             */
+            template <typename HFM, typename KMatrix>
+            std::pair<std::complex<double>, CDVector>
+            logdetMAndForceDirectSinglePart(const HFM &hfm, const CDVector &phi,
+                                            const KMatrix &k, const Species species,
+                                            const std::size_t interval,
+                                            const bool singlePrecision) {
+                if (singlePrecision)
+                    return {logdetM(hfm, phi, species, interval),
+                            forceDirectSinglePart(hfm, phi, k, species, interval, true)};
+
+                std::complex<double> ldet;
+                auto force = forceDirectSinglePart(hfm, phi, k, species, interval, false, &ldet);
+
+                // log(det(A)) = -sum_t log(det(F_t^-1))
+                const double sign = species == Species::PARTICLE ? +1.0 : -1.0;
+                ldet += sign*1.0i*blaze::sum(phi)
+                    + logdetFWithoutPhi(hfm, species, getNt(phi, hfm.nx()));
+                return {toFirstLogBranch(ldet), std::move(force)};
+            }
+
+            /// Compute log(det(Q)) using an LU-decomposition borrowed from qluPool.
+            template <typename HFM>
+            std::complex<double> logdetQPooled(const HFM &hfm, const CDVector &phi,
+                                               const _internal::QLUPool<typename HFM::QLU> &qluPool) {
+                auto lu = qluPool.acquire();
+                getQLU(hfm, phi, lu);
+                const auto ldet = ilogdetQ(lu);
+                qluPool.release(std::move(lu));
+                return ldet;
+            }
+
             /// Calculate force using the DIRECT_SQUARE algorithm for DIA discretization.
+            /*
+             * The LU-decomposition of Q is stored in an instance borrowed from qluPool.
+             * Stores log(det(Q)) in logdetQ unless it is nullptr.
+             */
             CDVector forceDirectSquare(const HubbardFermiMatrixDia &hfm,
-                                       const CDVector &phi) {
+                                       const CDVector &phi,
+                                       const _internal::QLUPool<HubbardFermiMatrixDia::QLU> &qluPool,
+                                       std::complex<double> *const logdetQ=nullptr) {
                 const auto nx = hfm.nx();
                 const auto nt = getNt(phi, nx);
 
-                // invert Q
-                CDMatrix QInv{hfm.Q(phi)};
-                auto ipiv = std::make_unique<int[]>(QInv.rows());
-                invert(QInv, ipiv);
+                // only blocks (tau, tau+1) and (tau+1, tau) of Q^-1 are needed
+                auto lu = qluPool.acquire();
+                getQLU(hfm, phi, lu);
+                std::vector<CDMatrix> QInvUpper, QInvLower;
+                selectedInverseQ(lu, QInvUpper, QInvLower);
+                // lu is not needed anymore, can overwrite it
+                if (logdetQ)
+                    *logdetQ = ilogdetQ(lu);
+                qluPool.release(std::move(lu));
 
                 // calculate force
-                CDVector force(QInv.rows());
+                CDVector force(nx*nt);
                 decltype(hfm.Tplus(0ul, phi)) T;  // sparse or dense matrix
                 for (std::size_t tau = 0; tau < nt; ++tau) {
                     hfm.Tplus(T, loopIdx(tau+1, nt), phi);
-                    spacevec(force, tau, nx) = 1.i*blaze::diagonal(T*spacemat(QInv, tau, loopIdx(tau+1, nt), nx));
+                    spacevec(force, tau, nx) = 1.i*blaze::diagonal(T*QInvUpper[tau]);
                     hfm.Tminus(T, tau, phi);
-                    spacevec(force, tau, nx) -= 1.i*blaze::diagonal(spacemat(QInv, loopIdx(tau+1, nt), tau, nx)*T);
+                    spacevec(force, tau, nx) -= 1.i*blaze::diagonal(QInvLower[tau]*T);
                 }
 
                 return force;
             }
 
             /// Calculate force using the DIRECT_SQUARE algorithm for EXP discretization.
+            /*
+             * The LU-decomposition of Q is stored in an instance borrowed from qluPool.
+             * Stores log(det(Q)) in logdetQ unless it is nullptr.
+             */
             CDVector forceDirectSquare(const HubbardFermiMatrixExp &hfm,
-                                       const CDVector &phi) {
+                                       const CDVector &phi,
+                                       const _internal::QLUPool<HubbardFermiMatrixExp::QLU> &qluPool,
+                                       std::complex<double> *const logdetQ=nullptr) {
                 const auto nx = hfm.nx();
                 const auto nt = getNt(phi, nx);
 
-                // invert Q
-                CDMatrix QInv{hfm.Q(phi)};
-                auto ipiv = std::make_unique<int[]>(QInv.rows());
-                invert(QInv, ipiv);
+                // only blocks (tau, tau+1) and (tau+1, tau) of Q^-1 are needed
+                auto lu = qluPool.acquire();
+                getQLU(hfm, phi, lu);
+                std::vector<CDMatrix> QInvUpper, QInvLower;
+                selectedInverseQ(lu, QInvUpper, QInvLower);
+                // lu is not needed anymore, can overwrite it
+                if (logdetQ)
+                    *logdetQ = ilogdetQ(lu);
+                qluPool.release(std::move(lu));
 
                 // calculate force
-                CDVector force(QInv.rows());
+                CDVector force(nx*nt);
                 decltype(hfm.Tplus(0ul, phi)) T;  // sparse or dense matrix
                 for (std::size_t tau = 0; tau < nt; ++tau) {
                     hfm.Tplus(T, loopIdx(tau+1, nt), phi);
-                    spacevec(force, tau, nx) = 1.i*blaze::diagonal(spacemat(QInv, tau, loopIdx(tau+1, nt), nx)*T);
+                    spacevec(force, tau, nx) = 1.i*blaze::diagonal(QInvUpper[tau]*T);
                     hfm.Tminus(T, tau, phi);
-                    spacevec(force, tau, nx) -= 1.i*blaze::diagonal(T*spacemat(QInv, loopIdx(tau+1, nt), tau, nx));
+                    spacevec(force, tau, nx) -= 1.i*blaze::diagonal(T*QInvLower[tau]);
                 }
 
                 return force;
@@ -161,12 +503,12 @@ namespace isle {
             const CDVector &phi) const {
 
             if (_shortcutForHoles) {
-                const auto ldp = logdetM(_hfm, phi, Species::PARTICLE);
+                const auto ldp = logdetM(_hfm, phi, Species::PARTICLE, _stabilizationInterval);
                 return -toFirstLogBranch(ldp + std::conj(ldp));
             }
             else {
-                return -toFirstLogBranch(logdetM(_hfm, phi, Species::PARTICLE)
-                                         + logdetM(_hfm, phi, Species::HOLE));
+                return -toFirstLogBranch(logdetM(_hfm, phi, Species::PARTICLE, _stabilizationInterval)
+                                         + logdetM(_hfm, phi, Species::HOLE, _stabilizationInterval));
             }
         }
         template <> CDVector
@@ -174,12 +516,32 @@ namespace isle {
             const CDVector &phi) const {
 
             if (_shortcutForHoles) {
-                const auto fp = forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE);
+                const auto fp = forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE,
+                                                      _stabilizationInterval, _singlePrecisionForce);
                 return -1.i*(fp - blaze::conj(fp));
             }
             else {
-                return -1.i*(forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE)
-                         - forceDirectSinglePart(_hfm, phi, _kh, Species::HOLE));
+                return -1.i*(forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE,
+                                                   _stabilizationInterval, _singlePrecisionForce)
+                             - forceDirectSinglePart(_hfm, phi, _kh, Species::HOLE,
+                                                     _stabilizationInterval, _singlePrecisionForce));
+            }
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            if (_shortcutForHoles) {
+                const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+                return {-toFirstLogBranch(ldp + std::conj(ldp)), -1.i*(fp - blaze::conj(fp))};
+            }
+            else {
+                const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+                const auto [ldh, fh] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kh, Species::HOLE, _stabilizationInterval, _singlePrecisionForce);
+                return {-toFirstLogBranch(ldp + ldh), -1.i*(fp - fh)};
             }
         }
 
@@ -188,42 +550,71 @@ namespace isle {
             const CDVector &phi) const {
 
             const CDVector aux = -1.i*phi;
-            return -toFirstLogBranch(logdetM(_hfm, aux, Species::PARTICLE)
-                                     + logdetM(_hfm, aux, Species::HOLE));
+            return -toFirstLogBranch(logdetM(_hfm, aux, Species::PARTICLE, _stabilizationInterval)
+                                     + logdetM(_hfm, aux, Species::HOLE, _stabilizationInterval));
         }
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::force(
             const CDVector &phi) const {
 
             const CDVector aux = -1.i*phi;
-            return (forceDirectSinglePart(_hfm, aux, _kh, Species::HOLE)
-                    - forceDirectSinglePart(_hfm, aux, _kp, Species::PARTICLE));
+            return (forceDirectSinglePart(_hfm, aux, _kh, Species::HOLE,
+                                          _stabilizationInterval, _singlePrecisionForce)
+                    - forceDirectSinglePart(_hfm, aux, _kp, Species::PARTICLE,
+                                            _stabilizationInterval, _singlePrecisionForce));
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const {
+
+            const CDVector aux = -1.i*phi;
+            const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                _hfm, aux, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+            const auto [ldh, fh] = logdetMAndForceDirectSinglePart(
+                _hfm, aux, _kh, Species::HOLE, _stabilizationInterval, _singlePrecisionForce);
+            return {-toFirstLogBranch(ldp + ldh), fh - fp};
         }
 
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::eval(
             const CDVector &phi) const {
 
-            return -logdetQ(_hfm, phi);
+            return -logdetQPooled(_hfm, phi, _qluPool);
         }
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::force(
             const CDVector &phi) const {
 
-            return forceDirectSquare(_hfm, phi);
+            return forceDirectSquare(_hfm, phi, _qluPool);
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            std::complex<double> ldet;
+            CDVector force = forceDirectSquare(_hfm, phi, _qluPool, &ldet);
+            return {-ldet, std::move(force)};
         }
 
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::eval(
             const CDVector &phi) const {
 
-            return -logdetQ(_hfm, -1.i*phi);
+            return -logdetQPooled(_hfm, -1.i*phi, _qluPool);
         }
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::force(
             const CDVector &phi) const {
 
-            return -1.i*forceDirectSquare(_hfm, -1.i*phi);
+            return -1.i*forceDirectSquare(_hfm, -1.i*phi, _qluPool);
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const {
+
+            std::complex<double> ldet;
+            const CDVector force = forceDirectSquare(_hfm, -1.i*phi, _qluPool, &ldet);
+            return {-ldet, -1.i*force};
         }
 
 
@@ -232,12 +623,12 @@ namespace isle {
             const CDVector &phi) const {
 
             if (_shortcutForHoles) {
-                const auto ldp = logdetM(_hfm, phi, Species::PARTICLE);
+                const auto ldp = logdetM(_hfm, phi, Species::PARTICLE, _stabilizationInterval);
                 return -toFirstLogBranch(ldp + std::conj(ldp));
             }
             else {
-                return -toFirstLogBranch(logdetM(_hfm, phi, Species::PARTICLE)
-                                         + logdetM(_hfm, phi, Species::HOLE));
+                return -toFirstLogBranch(logdetM(_hfm, phi, Species::PARTICLE, _stabilizationInterval)
+                                         + logdetM(_hfm, phi, Species::HOLE, _stabilizationInterval));
             }
         }
         template <> CDVector
@@ -245,12 +636,32 @@ namespace isle {
             const CDVector &phi) const {
 
             if (_shortcutForHoles) {
-                const auto fp = forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE);
+                const auto fp = forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE,
+                                                      _stabilizationInterval, _singlePrecisionForce);
                 return -1.i*(fp - blaze::conj(fp));
             }
             else {
-                return -1.i*(forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE)
-                         - forceDirectSinglePart(_hfm, phi, _kh, Species::HOLE));
+                return -1.i*(forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE,
+                                                   _stabilizationInterval, _singlePrecisionForce)
+                             - forceDirectSinglePart(_hfm, phi, _kh, Species::HOLE,
+                                                     _stabilizationInterval, _singlePrecisionForce));
+            }
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            if (_shortcutForHoles) {
+                const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+                return {-toFirstLogBranch(ldp + std::conj(ldp)), -1.i*(fp - blaze::conj(fp))};
+            }
+            else {
+                const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+                const auto [ldh, fh] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kh, Species::HOLE, _stabilizationInterval, _singlePrecisionForce);
+                return {-toFirstLogBranch(ldp + ldh), -1.i*(fp - fh)};
             }
         }
 
@@ -259,42 +670,148 @@ namespace isle {
             const CDVector &phi) const {
 
             const CDVector aux = -1.i*phi;
-            return -toFirstLogBranch(logdetM(_hfm, aux, Species::PARTICLE)
-                                     + logdetM(_hfm, aux, Species::HOLE));
+            return -toFirstLogBranch(logdetM(_hfm, aux, Species::PARTICLE, _stabilizationInterval)
+                                     + logdetM(_hfm, aux, Species::HOLE, _stabilizationInterval));
         }
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::force(
             const CDVector &phi) const {
 
             const CDVector aux = -1.i*phi;
-            return (forceDirectSinglePart(_hfm, aux, _kh, Species::HOLE)
-                    - forceDirectSinglePart(_hfm, aux, _kp, Species::PARTICLE));
+            return (forceDirectSinglePart(_hfm, aux, _kh, Species::HOLE,
+                                          _stabilizationInterval, _singlePrecisionForce)
+                    - forceDirectSinglePart(_hfm, aux, _kp, Species::PARTICLE,
+                                            _stabilizationInterval, _singlePrecisionForce));
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const {
+
+            const CDVector aux = -1.i*phi;
+            const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                _hfm, aux, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+            const auto [ldh, fh] = logdetMAndForceDirectSinglePart(
+                _hfm, aux, _kh, Species::HOLE, _stabilizationInterval, _singlePrecisionForce);
+            return {-toFirstLogBranch(ldp + ldh), fh - fp};
+        }
+
+        template <> std::complex<double>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::eval(
+            const CDVector &phi) const {
+
+            if (_shortcutForHoles) {
+                const auto ldp = logdetM(_hfm, phi, Species::PARTICLE, _stabilizationInterval);
+                return -toFirstLogBranch(ldp + std::conj(ldp));
+            }
+            else {
+                return -toFirstLogBranch(logdetM(_hfm, phi, Species::PARTICLE, _stabilizationInterval)
+                                         + logdetM(_hfm, phi, Species::HOLE, _stabilizationInterval));
+            }
+        }
+        template <> CDVector
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::force(
+            const CDVector &phi) const {
+
+            if (_shortcutForHoles) {
+                const auto fp = forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE,
+                                                      _stabilizationInterval, _singlePrecisionForce);
+                return -1.i*(fp - blaze::conj(fp));
+            }
+            else {
+                return -1.i*(forceDirectSinglePart(_hfm, phi, _kp, Species::PARTICLE,
+                                                   _stabilizationInterval, _singlePrecisionForce)
+                             - forceDirectSinglePart(_hfm, phi, _kh, Species::HOLE,
+                                                     _stabilizationInterval, _singlePrecisionForce));
+            }
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            if (_shortcutForHoles) {
+                const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+                return {-toFirstLogBranch(ldp + std::conj(ldp)), -1.i*(fp - blaze::conj(fp))};
+            }
+            else {
+                const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+                const auto [ldh, fh] = logdetMAndForceDirectSinglePart(
+                    _hfm, phi, _kh, Species::HOLE, _stabilizationInterval, _singlePrecisionForce);
+                return {-toFirstLogBranch(ldp + ldh), -1.i*(fp - fh)};
+            }
+        }
+
+        template <> std::complex<double>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::eval(
+            const CDVector &phi) const {
+
+            const CDVector aux = -1.i*phi;
+            return -toFirstLogBranch(logdetM(_hfm, aux, Species::PARTICLE, _stabilizationInterval)
+                                     + logdetM(_hfm, aux, Species::HOLE, _stabilizationInterval));
+        }
+        template <> CDVector
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::force(
+            const CDVector &phi) const {
+
+            const CDVector aux = -1.i*phi;
+            return (forceDirectSinglePart(_hfm, aux, _kh, Species::HOLE,
+                                          _stabilizationInterval, _singlePrecisionForce)
+                    - forceDirectSinglePart(_hfm, aux, _kp, Species::PARTICLE,
+                                            _stabilizationInterval, _singlePrecisionForce));
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const {
+
+            const CDVector aux = -1.i*phi;
+            const auto [ldp, fp] = logdetMAndForceDirectSinglePart(
+                _hfm, aux, _kp, Species::PARTICLE, _stabilizationInterval, _singlePrecisionForce);
+            const auto [ldh, fh] = logdetMAndForceDirectSinglePart(
+                _hfm, aux, _kh, Species::HOLE, _stabilizationInterval, _singlePrecisionForce);
+            return {-toFirstLogBranch(ldp + ldh), fh - fp};
         }
 
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::eval(
             const CDVector &phi) const {
 
-            return -logdetQ(_hfm, phi);
+            return -logdetQPooled(_hfm, phi, _qluPool);
         }
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::force(
             const CDVector &phi) const {
 
-            return forceDirectSquare(_hfm, phi);
+            return forceDirectSquare(_hfm, phi, _qluPool);
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            std::complex<double> ldet;
+            CDVector force = forceDirectSquare(_hfm, phi, _qluPool, &ldet);
+            return {-ldet, std::move(force)};
         }
 
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::eval(
             const CDVector &phi) const {
 
-            return -logdetQ(_hfm, -1.i*phi);
+            return -logdetQPooled(_hfm, -1.i*phi, _qluPool);
         }
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::force(
             const CDVector &phi) const {
 
-            return -1.i*forceDirectSquare(_hfm, -1.i*phi);
+            return -1.i*forceDirectSquare(_hfm, -1.i*phi, _qluPool);
+        }
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const {
+
+            std::complex<double> ldet;
+            const CDVector force = forceDirectSquare(_hfm, -1.i*phi, _qluPool, &ldet);
+            return {-ldet, -1.i*force};
         }
 
 
@@ -380,6 +897,478 @@ namespace isle {
                     
 
 
+        namespace {
+            /// Throw if the pseudofermion action can not represent both species.
+            void checkPseudofermionParameters(const SparseMatrix<double> &kappaTilde,
+                                              const double muTilde,
+                                              const std::int8_t sigmaKappa) {
+                if (muTilde != 0)
+                    throw std::invalid_argument("HubbardFermiAction with algorithm PSEUDOFERMION "
+                                                "requires muTilde == 0");
+                if (sigmaKappa != +1 && !isBipartite(kappaTilde))
+                    throw std::invalid_argument("HubbardFermiAction with algorithm PSEUDOFERMION "
+                                                "requires sigmaKappa == +1 or a bipartite lattice");
+            }
+
+            /// Draw complex Gaussian noise with <|eta_i|^2> = 1.
+            template <typename RNG>
+            CDVector gaussianNoise(const std::size_t size, RNG &rng) {
+                std::normal_distribution<double> normal{0.0, std::sqrt(0.5)};
+                CDVector eta(size);
+                for (auto &elem : eta)
+                    elem = std::complex<double>{normal(rng), normal(rng)};
+                return eta;
+            }
+
+            /// Multiply the adjoint of the hopping part of F onto a vector, identity for DIA.
+            CDVector applyHoppingAdjoint(const HubbardFermiMatrixDia &UNUSED(hfm),
+                                         const Species UNUSED(species),
+                                         const CDVector &vec) {
+                return vec;
+            }
+
+            /// Multiply the adjoint of the hopping part of F onto a vector.
+            CDVector applyHoppingAdjoint(const HubbardFermiMatrixExp &hfm,
+                                         const Species species,
+                                         const CDVector &vec) {
+                return blaze::trans(hfm.expKappa(species, false))*vec;
+            }
+
+            /// Multiply the adjoint of the hopping part of F onto a vector, the product is symmetric.
+            CDVector applyHoppingAdjoint(const HubbardFermiMatrixCheckerboard &hfm,
+                                         const Species species,
+                                         const CDVector &vec) {
+                CDVector res = vec;
+                hfm.applyExpKappa(res, species, false);
+                return res;
+            }
+
+            /// Calculate 2 Re[u^dagger (dM/dphi) x] for each component of phi.
+            template <typename HFM>
+            CDVector forceBilinear(const HFM &hfm, const CDVector &phi,
+                                   const Species species, const CDVector &u, const CDVector &x) {
+                const std::size_t nx = hfm.nx();
+                const std::size_t nt = getNt(phi, nx);
+                // the sign in the exponential of phi, see F()
+                const auto phaseSign = species == Species::PARTICLE ? +1.0i : -1.0i;
+
+                // only F_{t+1} depends on phi_t, it enters M with a minus sign except for t+1=0
+                CDVector force(nx*nt);
+                for (std::size_t t = 0; t < nt; ++t) {
+                    const std::size_t tp1 = t == nt-1 ? 0 : t+1;
+                    const double sign = tp1 == 0 ? 1.0 : -1.0;
+                    spacevec(force, t, nx) = blaze::real(
+                        2.0*sign*phaseSign
+                        * blaze::conj(applyHoppingAdjoint(hfm, species, spacevec(u, tp1, nx)))
+                        * blaze::exp(phaseSign*spacevec(phi, t, nx)) * spacevec(x, t, nx));
+                }
+                return force;
+            }
+
+            /// Calculate the pseudofermion force from x = (M^dagger M)^-1 chi.
+            template <typename HFM>
+            CDVector forcePseudofermion(const HFM &hfm, const CDVector &phi,
+                                        const Species species, const CDVector &x) {
+                CDVector y;
+                applyM(hfm, phi, species, x, y, false);
+                return forceBilinear(hfm, phi, species, y, x);
+            }
+        }
+
+        template <HFAHopping HOPPING>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::HubbardFermiAction(
+            const SparseMatrix<double> &kappaTilde,
+            const double muTilde, const std::int8_t sigmaKappa,
+            const double tolerance, const std::size_t maxIterations)
+            : _hfm{kappaTilde, muTilde, sigmaKappa},
+              _tolerance{tolerance}, _maxIterations{maxIterations}
+        {
+            checkPseudofermionParameters(kappaTilde, muTilde, sigmaKappa);
+        }
+
+        template <HFAHopping HOPPING>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::HubbardFermiAction(
+            const Lattice &lat, const double beta,
+            const double muTilde, const std::int8_t sigmaKappa,
+            const double tolerance, const std::size_t maxIterations)
+            : _hfm{lat, beta, muTilde, sigmaKappa},
+              _tolerance{tolerance}, _maxIterations{maxIterations}
+        {
+            checkPseudofermionParameters(lat.hopping(), muTilde, sigmaKappa);
+        }
+
+        template <HFAHopping HOPPING>
+        std::complex<double>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::eval(
+            const CDVector &phi) const {
+
+            return std::real(blaze::dot(blaze::conj(_chi), _solve(phi)));
+        }
+
+        template <HFAHopping HOPPING>
+        CDVector
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::force(
+            const CDVector &phi) const {
+
+            return forcePseudofermion(_hfm, phi, Species::PARTICLE, _solve(phi));
+        }
+
+        template <HFAHopping HOPPING>
+        std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            const CDVector x = _solve(phi);
+            return {std::real(blaze::dot(blaze::conj(_chi), x)),
+                    forcePseudofermion(_hfm, phi, Species::PARTICLE, x)};
+        }
+
+        template <HFAHopping HOPPING>
+        void
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::refreshPseudofermions(
+            const CDVector &phi, const std::uint64_t seed) {
+
+            std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                              static_cast<std::uint32_t>(seed >> 32)};
+            std::mt19937_64 rng{seq};
+            applyM(_hfm, phi, Species::PARTICLE, gaussianNoise(phi.size(), rng), _chi, true);
+        }
+
+        template <HFAHopping HOPPING>
+        const CDVector &
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::pseudofermions()
+            const noexcept {
+
+            return _chi;
+        }
+
+        template <HFAHopping HOPPING>
+        void
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::setPseudofermions(
+            const CDVector &chi) {
+
+            _chi = chi;
+        }
+
+        template <HFAHopping HOPPING>
+        CDVector
+        HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>::_solve(
+            const CDVector &phi) const {
+
+            if (_chi.size() != phi.size())
+                throw std::runtime_error("Pseudofermions do not match the configuration, "
+                                         "call refreshPseudofermions first.");
+
+            CDVector tmp;
+            const LinearOperator mdagm = [&](const CDVector &in, CDVector &out) {
+                applyM(_hfm, phi, Species::PARTICLE, in, tmp, false);
+                applyM(_hfm, phi, Species::PARTICLE, tmp, out, true);
+            };
+            CDVector x;
+            conjugateGradient(mdagm, _chi, x, _tolerance, _maxIterations);
+            return x;
+        }
+
+        namespace {
+            /// Throw if the power of a rational action is not supported.
+            double checkedRationalPower(const double power) {
+                if (!(power > 0.0 && power <= 1.0))
+                    throw std::invalid_argument("HubbardFermiAction with algorithm RATIONAL "
+                                                "requires 0 < power <= 1");
+                return power;
+            }
+        }
+
+        template <HFAHopping HOPPING>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::HubbardFermiAction(
+            const SparseMatrix<double> &kappaTilde,
+            const double muTilde, const std::int8_t sigmaKappa,
+            const double power, const double lambdaMin, const double lambdaMax,
+            const double tolerance, const std::size_t maxIterations)
+            : _hfm{kappaTilde, muTilde, sigmaKappa},
+              _power{checkedRationalPower(power)},
+              _action{-power, lambdaMin, lambdaMax, tolerance},
+              _heatbath{power/2-1, lambdaMin, lambdaMax, tolerance},
+              _tolerance{tolerance}, _maxIterations{maxIterations}
+        { }
+
+        template <HFAHopping HOPPING>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::HubbardFermiAction(
+            const Lattice &lat, const double beta,
+            const double muTilde, const std::int8_t sigmaKappa,
+            const double power, const double lambdaMin, const double lambdaMax,
+            const double tolerance, const std::size_t maxIterations)
+            : _hfm{lat, beta, muTilde, sigmaKappa},
+              _power{checkedRationalPower(power)},
+              _action{-power, lambdaMin, lambdaMax, tolerance},
+              _heatbath{power/2-1, lambdaMin, lambdaMax, tolerance},
+              _tolerance{tolerance}, _maxIterations{maxIterations}
+        { }
+
+        template <HFAHopping HOPPING>
+        std::complex<double>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::eval(
+            const CDVector &phi) const {
+
+            return _evalSpecies(phi, Species::PARTICLE, nullptr)
+                + _evalSpecies(phi, Species::HOLE, nullptr);
+        }
+
+        template <HFAHopping HOPPING>
+        CDVector
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::force(
+            const CDVector &phi) const {
+
+            return evalAndForce(phi).second;
+        }
+
+        template <HFAHopping HOPPING>
+        std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            CDVector force(phi.size(), 0);
+            const std::complex<double> action = _evalSpecies(phi, Species::PARTICLE, &force)
+                + _evalSpecies(phi, Species::HOLE, &force);
+            return {action, force};
+        }
+
+        template <HFAHopping HOPPING>
+        void
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::refreshPseudofermions(
+            const CDVector &phi, const std::uint64_t seed) {
+
+            std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                              static_cast<std::uint32_t>(seed >> 32)};
+            std::mt19937_64 rng{seq};
+
+            for (const Species species : {Species::PARTICLE, Species::HOLE}) {
+                CDVector tmp;
+                const LinearOperator mmdag = [&](const CDVector &in, CDVector &out) {
+                    applyM(_hfm, phi, species, in, tmp, true);
+                    applyM(_hfm, phi, species, tmp, out, false);
+                };
+
+                // chi = M^dagger (M M^dagger)^{power/2-1} M eta
+                CDVector meta, aux;
+                applyM(_hfm, phi, species, gaussianNoise(phi.size(), rng), meta, false);
+                _heatbath.apply(mmdag, meta, aux, _tolerance, _maxIterations);
+                applyM(_hfm, phi, species, aux,
+                       species == Species::PARTICLE ? _chiP : _chiH, true);
+            }
+        }
+
+        template <HFAHopping HOPPING>
+        const CDVector &
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::pseudofermions(
+            const Species species) const noexcept {
+
+            return species == Species::PARTICLE ? _chiP : _chiH;
+        }
+
+        template <HFAHopping HOPPING>
+        void
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::setPseudofermions(
+            const Species species, const CDVector &chi) {
+
+            if (species == Species::PARTICLE)
+                _chiP = chi;
+            else
+                _chiH = chi;
+        }
+
+        template <HFAHopping HOPPING>
+        double
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::power()
+            const noexcept {
+
+            return _power;
+        }
+
+        template <HFAHopping HOPPING>
+        const RationalApproximation &
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::actionApproximation()
+            const noexcept {
+
+            return _action;
+        }
+
+        template <HFAHopping HOPPING>
+        const RationalApproximation &
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::heatbathApproximation()
+            const noexcept {
+
+            return _heatbath;
+        }
+
+        template <HFAHopping HOPPING>
+        std::complex<double>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>::_evalSpecies(
+            const CDVector &phi, const Species species, CDVector *const force) const {
+
+            const CDVector &chi = pseudofermions(species);
+            if (chi.size() != phi.size())
+                throw std::runtime_error("Pseudofermions do not match the configuration, "
+                                         "call refreshPseudofermions first.");
+
+            CDVector tmp;
+            const LinearOperator mdagm = [&](const CDVector &in, CDVector &out) {
+                applyM(_hfm, phi, species, in, tmp, false);
+                applyM(_hfm, phi, species, tmp, out, true);
+            };
+            std::vector<CDVector> xs;
+            multiShiftConjugateGradient(mdagm, chi, _action.shifts(), xs,
+                                        _tolerance, _maxIterations);
+
+            // chi^dagger r(M^dagger M) chi
+            CDVector rchi = _action.constant()*chi;
+            for (std::size_t k = 0; k < xs.size(); ++k) {
+                rchi += _action.residues()[k]*xs[k];
+                if (force)
+                    *force += _action.residues()[k]*forcePseudofermion(_hfm, phi, species, xs[k]);
+            }
+            return std::real(blaze::dot(blaze::conj(chi), rchi));
+        }
+
+        namespace {
+            /// Throw if the hopping of the heavy matrix of a Hasenbusch action is not supported.
+            double checkedHoppingScale(const double hoppingScale) {
+                if (!(hoppingScale >= 0.0 && hoppingScale <= 1.0))
+                    throw std::invalid_argument("HubbardFermiAction with algorithm HASENBUSCH "
+                                                "requires 0 <= hoppingScale <= 1");
+                return hoppingScale;
+            }
+        }
+
+        template <HFAHopping HOPPING>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::HubbardFermiAction(
+            const SparseMatrix<double> &kappaTilde,
+            const double muTilde, const std::int8_t sigmaKappa, const double hoppingScale,
+            const double tolerance, const std::size_t maxIterations)
+            : _hfm{kappaTilde, muTilde, sigmaKappa},
+              _hfmHeavy{kappaTilde*checkedHoppingScale(hoppingScale), muTilde, sigmaKappa},
+              _hoppingScale{hoppingScale},
+              _tolerance{tolerance}, _maxIterations{maxIterations}
+        {
+            checkPseudofermionParameters(kappaTilde, muTilde, sigmaKappa);
+        }
+
+        template <HFAHopping HOPPING>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::HubbardFermiAction(
+            const Lattice &lat, const double beta,
+            const double muTilde, const std::int8_t sigmaKappa, const double hoppingScale,
+            const double tolerance, const std::size_t maxIterations)
+            : _hfm{lat, beta, muTilde, sigmaKappa},
+              _hfmHeavy{lat.hopping()*(checkedHoppingScale(hoppingScale)*beta/lat.nt()),
+                        muTilde, sigmaKappa},
+              _hoppingScale{hoppingScale},
+              _tolerance{tolerance}, _maxIterations{maxIterations}
+        {
+            checkPseudofermionParameters(lat.hopping(), muTilde, sigmaKappa);
+        }
+
+        template <HFAHopping HOPPING>
+        std::complex<double>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::eval(
+            const CDVector &phi) const {
+
+            CDVector v;
+            applyM(_hfmHeavy, phi, Species::PARTICLE, _chi, v, true);
+            return std::real(blaze::dot(blaze::conj(v), _solve(phi)));
+        }
+
+        template <HFAHopping HOPPING>
+        CDVector
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::force(
+            const CDVector &phi) const {
+
+            const CDVector x = _solve(phi);
+            return forcePseudofermion(_hfm, phi, Species::PARTICLE, x)
+                - forceBilinear(_hfmHeavy, phi, Species::PARTICLE, _chi, x);
+        }
+
+        template <HFAHopping HOPPING>
+        std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const {
+
+            const CDVector x = _solve(phi);
+            CDVector v;
+            applyM(_hfmHeavy, phi, Species::PARTICLE, _chi, v, true);
+            return {std::real(blaze::dot(blaze::conj(v), x)),
+                    forcePseudofermion(_hfm, phi, Species::PARTICLE, x)
+                    - forceBilinear(_hfmHeavy, phi, Species::PARTICLE, _chi, x)};
+        }
+
+        template <HFAHopping HOPPING>
+        void
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::refreshPseudofermions(
+            const CDVector &phi, const std::uint64_t seed) {
+
+            std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                              static_cast<std::uint32_t>(seed >> 32)};
+            std::mt19937_64 rng{seq};
+
+            // chi = M_rho^{-dagger} M^dagger eta = M_rho (M_rho^dagger M_rho)^{-1} M^dagger eta
+            CDVector mdageta;
+            applyM(_hfm, phi, Species::PARTICLE, gaussianNoise(phi.size(), rng), mdageta, true);
+
+            CDVector tmp;
+            const LinearOperator mdagm = [&](const CDVector &in, CDVector &out) {
+                applyM(_hfmHeavy, phi, Species::PARTICLE, in, tmp, false);
+                applyM(_hfmHeavy, phi, Species::PARTICLE, tmp, out, true);
+            };
+            CDVector x;
+            conjugateGradient(mdagm, mdageta, x, _tolerance, _maxIterations);
+            applyM(_hfmHeavy, phi, Species::PARTICLE, x, _chi, false);
+        }
+
+        template <HFAHopping HOPPING>
+        const CDVector &
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::pseudofermions()
+            const noexcept {
+
+            return _chi;
+        }
+
+        template <HFAHopping HOPPING>
+        void
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::setPseudofermions(
+            const CDVector &chi) {
+
+            _chi = chi;
+        }
+
+        template <HFAHopping HOPPING>
+        double
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::hoppingScale()
+            const noexcept {
+
+            return _hoppingScale;
+        }
+
+        template <HFAHopping HOPPING>
+        CDVector
+        HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>::_solve(
+            const CDVector &phi) const {
+
+            if (_chi.size() != phi.size())
+                throw std::runtime_error("Pseudofermions do not match the configuration, "
+                                         "call refreshPseudofermions first.");
+
+            CDVector v;
+            applyM(_hfmHeavy, phi, Species::PARTICLE, _chi, v, true);
+
+            CDVector tmp;
+            const LinearOperator mdagm = [&](const CDVector &in, CDVector &out) {
+                applyM(_hfm, phi, Species::PARTICLE, in, tmp, false);
+                applyM(_hfm, phi, Species::PARTICLE, tmp, out, true);
+            };
+            CDVector x;
+            conjugateGradient(mdagm, v, x, _tolerance, _maxIterations);
+            return x;
+        }
+
         // instantiate all the templates we need right here
         template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>;
         template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>;
@@ -391,7 +1380,22 @@ namespace isle {
         template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>;
         template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>;
 
+        template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>;
+
         template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::ML_APPROX_FORCE, HFABasis::PARTICLE_HOLE>;
 
+        template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>;
+
+        template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>;
+
+        template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>;
+        template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>;
+
     } // namespace action
 }  // namespace isle
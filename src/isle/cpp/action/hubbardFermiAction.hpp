@@ -6,18 +6,28 @@
 #define ACTION_HUBBARD_FERMI_ACTION_HPP
 
 #include "action.hpp"
+#include "../hubbardFermiMatrixCheckerboard.hpp"
 #include "../hubbardFermiMatrixDia.hpp"
 #include "../hubbardFermiMatrixExp.hpp"
 #include "../lattice.hpp"
+#include "../rationalApproximation.hpp"
+#include "../parallel.hpp"
 #include <torch/script.h>
 #include <memory>
+#include <mutex>
+#include <vector>
 #include <iostream>
 
 
 namespace isle {
     namespace action {
         /// Indicate kind of hopping term for HubbardFermiAction.
-        enum class HFAHopping { DIA, EXP };
+        /**
+         * CHECKERBOARD uses a Trotterised exponential, see HubbardFermiMatrixCheckerboard.
+         * It only supports the algorithms DIRECT_SINGLE, PSEUDOFERMION, RATIONAL,
+         * and HASENBUSCH.
+         */
+        enum class HFAHopping { DIA, EXP, CHECKERBOARD };
 
         /// Indicate basis for HubbardFermiAction.
         enum class HFABasis { PARTICLE_HOLE, SPIN };
@@ -26,7 +36,8 @@ namespace isle {
         /**
          * See documentation in docs/algorithm for more information.
          */
-        enum class HFAAlgorithm { DIRECT_SINGLE, DIRECT_SQUARE, ML_APPROX_FORCE};
+        enum class HFAAlgorithm { DIRECT_SINGLE, DIRECT_SQUARE, ML_APPROX_FORCE, PSEUDOFERMION, RATIONAL,
+                                  HASENBUSCH };
 
         /// \cond DO_NOT_DOCUMENT
         namespace _internal {
@@ -39,6 +50,10 @@ namespace isle {
             struct HFM<HFAHopping::EXP> {
                 using type = HubbardFermiMatrixExp;
             };
+            template <>
+            struct HFM<HFAHopping::CHECKERBOARD> {
+                using type = HubbardFermiMatrixCheckerboard;
+            };
 
             /// Check if the shortcut to compute det(M_hole) is possible.
             template <HFABasis BASIS>
@@ -67,6 +82,65 @@ namespace isle {
             struct KMatrixType<HFAHopping::EXP> {
                 using type = IdMatrix<double>;
             };
+            template <>
+            struct KMatrixType<HFAHopping::CHECKERBOARD> {
+                using type = IdMatrix<double>;
+            };
+
+            /// Pool of LU-decompositions of Q which are reused between evaluations.
+            /**
+             * Each evaluation takes one instance out of the pool and returns it
+             * afterwards, so concurrent evaluations (e.g. in evalBatch) never share
+             * memory while steady-state sequential evaluations do not allocate.
+             * Copies and moves start out with an empty pool.
+             */
+            template <typename QLU>
+            class QLUPool {
+            public:
+                QLUPool() = default;
+                QLUPool(const QLUPool &) : QLUPool{} { }
+                QLUPool &operator=(const QLUPool &) { return *this; }
+                QLUPool(QLUPool &&) : QLUPool{} { }
+                QLUPool &operator=(QLUPool &&) { return *this; }
+                ~QLUPool() = default;
+
+                /// Take an instance out of the pool, is empty if the pool has none left.
+                QLU acquire() const {
+                    std::lock_guard<std::mutex> lock{_mutex};
+                    if (_free.empty())
+                        return QLU{};
+                    QLU lu = std::move(_free.back());
+                    _free.pop_back();
+                    return lu;
+                }
+
+                /// Put an instance back into the pool.
+                void release(QLU &&lu) const {
+                    std::lock_guard<std::mutex> lock{_mutex};
+                    _free.emplace_back(std::move(lu));
+                }
+
+            private:
+                mutable std::mutex _mutex;
+                mutable std::vector<QLU> _free;
+            };
+
+            /// Empty stand-in for QLUPool for algorithms that do not decompose Q.
+            struct NoQLUPool { };
+
+            /// Type of pool of LU-decompositions based on hopping and algorithm.
+            template <HFAHopping HOPPING, HFAAlgorithm ALGORITHM>
+            struct QLUPoolType {
+                using type = NoQLUPool;
+            };
+            template <>
+            struct QLUPoolType<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE> {
+                using type = QLUPool<HubbardFermiMatrixDia::QLU>;
+            };
+            template <>
+            struct QLUPoolType<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE> {
+                using type = QLUPool<HubbardFermiMatrixExp::QLU>;
+            };
         }
         /// \endcond DO_NOT_DOCUMENT
 
@@ -95,6 +169,21 @@ namespace isle {
          *
          * \warning Only supports `nt > 2`.
          *
+         * The products of time slices in algorithm DIRECT_SINGLE lose precision
+         * for large \f$\beta\f$. Pass `stabilizationInterval > 0` to the constructor
+         * in order to compute them with a StabilizedProduct which performs a
+         * QR-decomposition every `stabilizationInterval` time slices.
+         * The parameter is ignored by DIRECT_SQUARE.
+         *
+         * Molecular dynamics only needs the force to be accurate enough for the
+         * integrator to be reversible.
+         * Pass `singlePrecisionForce = true` to compute the products of time slices
+         * and the inversion in the DIRECT_SINGLE force in `std::complex<float>`.
+         * The action itself, which enters the Metropolis accept/reject step,
+         * is always computed in double precision.
+         * DIRECT_SINGLE does not support this option together with
+         * `stabilizationInterval > 0`, DIRECT_SQUARE ignores it.
+         *
          * See <TT>docs/algorithm/hubbardFermiAction.pdf</TT>
          * for description and derivation of the algorithms.
          */
@@ -104,26 +193,38 @@ namespace isle {
             /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
             HubbardFermiAction(const SparseMatrix<double> &kappaTilde,
                                const double muTilde, const std::int8_t sigmaKappa,
-                               const bool allowShortcut)
+                               const bool allowShortcut,
+                               const std::size_t stabilizationInterval=0,
+                               const bool singlePrecisionForce=false)
                 : _hfm{kappaTilde, muTilde, sigmaKappa},
                   _kp{_hfm.K(Species::PARTICLE)},
                   _kh{_hfm.K(Species::HOLE)},
                   _shortcutForHoles{allowShortcut
                                     && _internal::_holeShortcutPossible<BASIS>(
-                                        kappaTilde, muTilde, sigmaKappa)}
-            { }
+                                        kappaTilde, muTilde, sigmaKappa)},
+                  _stabilizationInterval{stabilizationInterval},
+                  _singlePrecisionForce{singlePrecisionForce}
+            {
+                _checkForcePrecision();
+            }
 
             /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
             HubbardFermiAction(const Lattice &lat, const double beta,
                                const double muTilde, const std::int8_t sigmaKappa,
-                               const bool allowShortcut)
+                               const bool allowShortcut,
+                               const std::size_t stabilizationInterval=0,
+                               const bool singlePrecisionForce=false)
                 : _hfm{lat, beta, muTilde, sigmaKappa},
                   _kp{_hfm.K(Species::PARTICLE)},
                   _kh{_hfm.K(Species::HOLE)},
                   _shortcutForHoles{allowShortcut
                                     && _internal::_holeShortcutPossible<BASIS>(
-                                        lat.hopping(), muTilde, sigmaKappa)}
-            { }
+                                        lat.hopping(), muTilde, sigmaKappa)},
+                  _stabilizationInterval{stabilizationInterval},
+                  _singlePrecisionForce{singlePrecisionForce}
+            {
+                _checkForcePrecision();
+            }
 
           
 
@@ -139,13 +240,70 @@ namespace isle {
             /// Calculate force for given auxilliary field phi.
             CDVector force(const CDVector &phi) const override;
 
+            /// Evaluate the %Action and calculate the force for given auxilliary field phi.
+            /**
+             * Shares the LU-decompositions between the action and force.
+             */
+            std::pair<std::complex<double>, CDVector> evalAndForce(const CDVector &phi) const override;
+
+            /// Return the fermion matrix which holds all physical parameters of the action.
+            const typename _internal::HFM<HOPPING>::type &hfm() const noexcept {
+                return _hfm;
+            }
+
+            /// Evaluate the %Action for many configurations, distributed over OpenMP threads.
+            CDVector evalBatch(const CDMatrix &phis) const override {
+                CDVector res(phis.rows());
+                parallelFor(phis.rows(), [&](const std::size_t i) {
+                    const CDVector phi = blaze::trans(blaze::row(phis, i));
+                    res[i] = eval(phi);
+                });
+                return res;
+            }
+
+            /// Calculate force for many configurations, distributed over OpenMP threads.
+            CDMatrix forceBatch(const CDMatrix &phis) const override {
+                _prepareConcurrentAccess();
+                CDMatrix res(phis.rows(), phis.columns());
+                parallelFor(phis.rows(), [&](const std::size_t i) {
+                    const CDVector phi = blaze::trans(blaze::row(phis, i));
+                    blaze::row(res, i) = blaze::trans(force(phi));
+                });
+                return res;
+            }
+
         private:
+            /// Make sure that the options for the force are compatible.
+            void _checkForcePrecision() const {
+                if constexpr (ALGORITHM == HFAAlgorithm::DIRECT_SINGLE) {
+                    if (_singlePrecisionForce && _stabilizationInterval > 0)
+                        throw std::invalid_argument("Single precision force does not support "
+                                                    "stabilizationInterval > 0");
+                }
+            }
+
+            /// Fill all lazily constructed caches of _hfm so threads can share it.
+            void _prepareConcurrentAccess() const {
+                if constexpr (HOPPING == HFAHopping::DIA) {
+                    if (_stabilizationInterval > 0) {
+                        _hfm.Kinv(Species::PARTICLE);
+                        _hfm.Kinv(Species::HOLE);
+                    }
+                }
+            }
+
             /// Stores all necessary parameters.
             const typename _internal::HFM<HOPPING>::type _hfm;
             const typename _internal::KMatrixType<HOPPING>::type _kp;  ///< Matrix K for particles.
             const typename _internal::KMatrixType<HOPPING>::type _kh;  ///< Matrix K for holes.
             /// Can logdetM for holes be computed from logdetM from particles?
             const bool _shortcutForHoles;
+            /// Number of time slices between QR-decompositions, 0 means no stabilization.
+            const std::size_t _stabilizationInterval;
+            /// Compute DIRECT_SINGLE forces in single precision?
+            const bool _singlePrecisionForce;
+            /// LU-decompositions of Q reused by DIRECT_SQUARE, safe to use from multiple threads.
+            typename _internal::QLUPoolType<HOPPING, ALGORITHM>::type _qluPool;
             //torch::jit::script::Module _model;
 
         };
@@ -158,12 +316,18 @@ namespace isle {
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const;
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::eval(
             const CDVector &phi) const;
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const;
 
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::eval(
@@ -171,12 +335,18 @@ namespace isle {
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const;
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::eval(
             const CDVector &phi) const;
         template <> CDVector
         HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const;
 
 
 
@@ -186,12 +356,37 @@ namespace isle {
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const;
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::eval(
             const CDVector &phi) const;
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const;
+
+        template <> std::complex<double>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::eval(
+            const CDVector &phi) const;
+        template <> CDVector
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::force(
+            const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const;
+        template <> std::complex<double>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::eval(
+            const CDVector &phi) const;
+        template <> CDVector
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::force(
+            const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const;
 
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::eval(
@@ -199,12 +394,18 @@ namespace isle {
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>::evalAndForce(
+            const CDVector &phi) const;
         template <> std::complex<double>
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::eval(
             const CDVector &phi) const;
         template <> CDVector
         HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::force(
             const CDVector &phi) const;
+        template <> std::pair<std::complex<double>, CDVector>
+        HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>::evalAndForce(
+            const CDVector &phi) const;
 
         // all the instantiations we will ever need, but actually implement them in the .cpp
         extern template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>;
@@ -217,6 +418,9 @@ namespace isle {
         extern template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>;
         extern template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>;
 
+        extern template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>;
+
         template<>
         class  HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::ML_APPROX_FORCE, HFABasis::PARTICLE_HOLE>:public Action{
             public:
@@ -260,6 +464,319 @@ namespace isle {
                   
         };        
 
+        /// Fermion action for the Hubbard model using pseudofermions.
+        /**
+         * Represents the fermion determinants through a pseudofermion field \f$\chi\f$ as
+         \f[
+         S_{\mathrm{PF}} = \chi^\dagger (M^\dagger M)^{-1} \chi,
+         \quad
+         \det(M^\dagger M) \propto \int \mathcal{D}[\chi^*, \chi]\, e^{-S_{\mathrm{PF}}},
+         \f]
+         * where \f$M = M(\phi, \tilde{\kappa}, 0)\f$ is the matrix for particles.
+         * This equals the regular HubbardFermiAction in the particle/hole basis
+         * only if \f$\det M(-\phi, \sigma_{\tilde{\kappa}}\tilde{\kappa}, 0) = (\det M)^*\f$.
+         * This is the case for real phi, \f$\tilde{\mu} = 0\f$, and either
+         * \f$\sigma_{\tilde{\kappa}} = +1\f$ or a bipartite lattice.
+         * \warning The field configuration is not checked, phi must always be real!
+         *
+         * The pseudofermions are drawn as \f$\chi = M^\dagger\eta\f$ from Gaussian noise
+         * \f$\eta\f$ by refreshPseudofermions() which has to be called at the beginning
+         * of every molecular dynamics trajectory.
+         * Action and force both need \f$x = (M^\dagger M)^{-1}\chi\f$ which is computed using
+         * conjugateGradient() where M is only ever applied to vectors via applyM().
+         * Each iteration therefore costs \f$\mathcal{O}(N_t \mathrm{nnz}(K))\f$
+         * for HFAHopping::DIA and HFAHopping::CHECKERBOARD and \f$\mathcal{O}(N_t N_x^2)\f$
+         * for HFAHopping::EXP instead of the \f$\mathcal{O}(N_t N_x^3)\f$ of the direct algorithms.
+         * The force is \f$2\,\mathrm{Re}\left[(M x)^\dagger\, \partial_\phi M\, x\right]\f$.
+         */
+        template <HFAHopping HOPPING>
+        class HubbardFermiAction<HOPPING, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>
+            : public Action {
+        public:
+            /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
+            /**
+             * \param kappaTilde Hopping matrix.
+             * \param muTilde Chemical potential, must be zero.
+             * \param sigmaKappa Sign of hopping for holes, must be +1 for non-bipartite lattices.
+             * \param tolerance Relative residual at which conjugate gradient stops.
+             * \param maxIterations Maximum number of conjugate gradient iterations.
+             * \throws std::invalid_argument if the parameters are not supported, see above.
+             */
+            HubbardFermiAction(const SparseMatrix<double> &kappaTilde,
+                               double muTilde, std::int8_t sigmaKappa,
+                               double tolerance=1e-10, std::size_t maxIterations=10000);
+
+            /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
+            HubbardFermiAction(const Lattice &lat, double beta,
+                               double muTilde, std::int8_t sigmaKappa,
+                               double tolerance=1e-10, std::size_t maxIterations=10000);
+
+            HubbardFermiAction(const HubbardFermiAction &other) = default;
+            HubbardFermiAction &operator=(const HubbardFermiAction &other) = default;
+            HubbardFermiAction(HubbardFermiAction &&other) = default;
+            HubbardFermiAction &operator=(HubbardFermiAction &&other) = default;
+            ~HubbardFermiAction() override = default;
+
+            /// Evaluate the %Action for given auxilliary field phi and current pseudofermions.
+            std::complex<double> eval(const CDVector &phi) const override;
+
+            /// Calculate force for given auxilliary field phi and current pseudofermions.
+            CDVector force(const CDVector &phi) const override;
+
+            /// Evaluate the %Action and calculate the force sharing a single solve.
+            std::pair<std::complex<double>, CDVector> evalAndForce(const CDVector &phi) const override;
+
+            /// Return true.
+            bool hasPseudofermions() const override {
+                return true;
+            }
+
+            /// Draw new pseudofermions \f$\chi = M^\dagger(\phi) \eta\f$.
+            void refreshPseudofermions(const CDVector &phi, std::uint64_t seed) override;
+
+            /// Return the current pseudofermions \f$\chi\f$.
+            const CDVector &pseudofermions() const noexcept;
+
+            /// Set the pseudofermions \f$\chi\f$ directly.
+            void setPseudofermions(const CDVector &chi);
+
+        private:
+            /// Compute \f$(M^\dagger M)^{-1}\chi\f$.
+            CDVector _solve(const CDVector &phi) const;
+
+            /// Stores all necessary parameters.
+            const typename _internal::HFM<HOPPING>::type _hfm;
+            const double _tolerance;  ///< Tolerance for conjugate gradient.
+            const std::size_t _maxIterations;  ///< Maximum number of CG iterations.
+            CDVector _chi;  ///< Pseudofermions.
+        };
+
+        extern template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>;
+
+        /// Fermion action for fractional powers of the determinants using rational HMC.
+        /**
+         * Represents
+         \f[
+         \prod_{s \in \{p, h\}} \det(M_s^\dagger M_s)^{\alpha}
+         \propto \int \mathcal{D}[\chi^*, \chi]\, e^{-S_{\mathrm{R}}},
+         \quad
+         S_{\mathrm{R}} = \sum_{s \in \{p, h\}} \chi_s^\dagger r(M_s^\dagger M_s) \chi_s,
+         \f]
+         * with one pseudofermion field for particles and one for holes,
+         * \f$0 < \alpha \le 1\f$, and a RationalApproximation
+         * \f$r(x) \approx x^{-\alpha}\f$.
+         * For instance, \f$\alpha = 1/2\f$ gives the phase quenched weight
+         * \f$|\det M_p \det M_h|\f$ for any \f$\tilde{\mu}\f$ and \f$\sigma_{\tilde{\kappa}}\f$.
+         *
+         * The pseudofermions are drawn as
+         * \f$\chi_s = (M_s^\dagger M_s)^{\alpha/2}\eta_s
+         *   = M_s^\dagger (M_s M_s^\dagger)^{\alpha/2-1} M_s\eta_s\f$
+         * from Gaussian noise \f$\eta_s\f$ by refreshPseudofermions() using a second
+         * RationalApproximation for the negative power \f$\alpha/2-1\f$.
+         * Both approximations are constructed once for the spectral range
+         * \f$[\lambda_\mathrm{min}, \lambda_\mathrm{max}]\f$ of \f$M^\dagger M\f$
+         * which must cover the spectra encountered during the simulation.
+         *
+         * Action and force need \f$x_k = (M_s^\dagger M_s + \sigma_k)^{-1}\chi_s\f$
+         * for all poles which are computed with a single
+         * multiShiftConjugateGradient() per species
+         * where M is only ever applied to vectors via applyM().
+         * The force is
+         * \f$\sum_k a_k\, 2\,\mathrm{Re}\left[(M_s x_k)^\dagger\, \partial_\phi M_s\, x_k\right]\f$
+         * summed over both species.
+         */
+        template <HFAHopping HOPPING>
+        class HubbardFermiAction<HOPPING, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>
+            : public Action {
+        public:
+            /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
+            /**
+             * \param kappaTilde Hopping matrix.
+             * \param muTilde Chemical potential.
+             * \param sigmaKappa Sign of hopping for holes.
+             * \param power Power \f$\alpha\f$ of \f$\det(M^\dagger M)\f$, must be in (0, 1].
+             * \param lambdaMin Lower bound on the spectrum of \f$M^\dagger M\f$.
+             * \param lambdaMax Upper bound on the spectrum of \f$M^\dagger M\f$.
+             * \param tolerance Relative error of the rational approximations and
+             *                  relative residual at which multi-shift CG stops.
+             * \param maxIterations Maximum number of conjugate gradient iterations.
+             * \throws std::invalid_argument if the parameters are not supported.
+             */
+            HubbardFermiAction(const SparseMatrix<double> &kappaTilde,
+                               double muTilde, std::int8_t sigmaKappa,
+                               double power, double lambdaMin, double lambdaMax,
+                               double tolerance=1e-10, std::size_t maxIterations=10000);
+
+            /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
+            HubbardFermiAction(const Lattice &lat, double beta,
+                               double muTilde, std::int8_t sigmaKappa,
+                               double power, double lambdaMin, double lambdaMax,
+                               double tolerance=1e-10, std::size_t maxIterations=10000);
+
+            HubbardFermiAction(const HubbardFermiAction &other) = default;
+            HubbardFermiAction &operator=(const HubbardFermiAction &other) = default;
+            HubbardFermiAction(HubbardFermiAction &&other) = default;
+            HubbardFermiAction &operator=(HubbardFermiAction &&other) = default;
+            ~HubbardFermiAction() override = default;
+
+            /// Evaluate the %Action for given auxilliary field phi and current pseudofermions.
+            std::complex<double> eval(const CDVector &phi) const override;
+
+            /// Calculate force for given auxilliary field phi and current pseudofermions.
+            CDVector force(const CDVector &phi) const override;
+
+            /// Evaluate the %Action and calculate the force sharing the solves.
+            std::pair<std::complex<double>, CDVector> evalAndForce(const CDVector &phi) const override;
+
+            /// Return true.
+            bool hasPseudofermions() const override {
+                return true;
+            }
+
+            /// Draw new pseudofermions \f$\chi_s = (M_s^\dagger M_s)^{\alpha/2} \eta_s\f$.
+            void refreshPseudofermions(const CDVector &phi, std::uint64_t seed) override;
+
+            /// Return the current pseudofermions \f$\chi_s\f$ for one species.
+            const CDVector &pseudofermions(Species species) const noexcept;
+
+            /// Set the pseudofermions \f$\chi_s\f$ for one species directly.
+            void setPseudofermions(Species species, const CDVector &chi);
+
+            /// Return the power \f$\alpha\f$.
+            double power() const noexcept;
+
+            /// Return the rational approximation of \f$x^{-\alpha}\f$ used for action and force.
+            const RationalApproximation &actionApproximation() const noexcept;
+
+            /// Return the rational approximation of \f$x^{\alpha/2-1}\f$ used for the heat bath.
+            const RationalApproximation &heatbathApproximation() const noexcept;
+
+        private:
+            /// Compute action and optionally force contribution of one species.
+            std::complex<double> _evalSpecies(const CDVector &phi, Species species,
+                                              CDVector *force) const;
+
+            /// Stores all necessary parameters.
+            const typename _internal::HFM<HOPPING>::type _hfm;
+            const double _power;  ///< Power of det(M^dagger M).
+            const RationalApproximation _action;  ///< Approximation of x^{-power}.
+            const RationalApproximation _heatbath;  ///< Approximation of x^{power/2-1}.
+            const double _tolerance;  ///< Tolerance for multi-shift CG.
+            const std::size_t _maxIterations;  ///< Maximum number of CG iterations.
+            CDVector _chiP;  ///< Pseudofermions for particles.
+            CDVector _chiH;  ///< Pseudofermions for holes.
+        };
+
+        extern template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>;
+
+        /// Ratio of fermion determinants for Hasenbusch mass preconditioning.
+        /**
+         * Splits the pseudofermion action into two factors
+         \f[
+         \det(M^\dagger M) = \det(M_\rho^\dagger M_\rho)
+                             \cdot \frac{\det(M^\dagger M)}{\det(M_\rho^\dagger M_\rho)},
+         \f]
+         * where \f$M = M(\phi, \tilde{\kappa}, 0)\f$ and the 'heavy' matrix
+         * \f$M_\rho = M(\phi, \rho\tilde{\kappa}, 0)\f$ uses a hopping matrix
+         * scaled by \f$0 \le \rho \le 1\f$.
+         * The first factor is HubbardFermiAction with algorithm PSEUDOFERMION
+         * and hopping \f$\rho\tilde{\kappa}\f$, this class represents the second factor as
+         \f[
+         S_{\mathrm{H}} = \chi^\dagger M_\rho (M^\dagger M)^{-1} M_\rho^\dagger \chi.
+         \f]
+         * The same restrictions on the parameters as for PSEUDOFERMION apply.
+         *
+         * The heavy matrix is well conditioned so its force is cheap but large,
+         * while the force of the ratio is expensive but small.
+         * Use both actions in a SumAction and integrate them on different
+         * time scales using multiTimescaleLeapfrog() to take many steps with the heavy
+         * action and only few with the ratio.
+         *
+         * The pseudofermions are drawn as \f$\chi = M_\rho^{-\dagger} M^\dagger\eta\f$
+         * from Gaussian noise \f$\eta\f$ by refreshPseudofermions().
+         * Action and force need \f$x = (M^\dagger M)^{-1} M_\rho^\dagger \chi\f$
+         * which is computed using conjugateGradient().
+         * The force is
+         * \f$2\,\mathrm{Re}\left[(M x)^\dagger\, \partial_\phi M\, x
+         *   - \chi^\dagger\, \partial_\phi M_\rho\, x\right]\f$.
+         */
+        template <HFAHopping HOPPING>
+        class HubbardFermiAction<HOPPING, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>
+            : public Action {
+        public:
+            /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
+            /**
+             * \param kappaTilde Hopping matrix.
+             * \param muTilde Chemical potential, must be zero.
+             * \param sigmaKappa Sign of hopping for holes, must be +1 for non-bipartite lattices.
+             * \param hoppingScale Factor \f$\rho\f$ for the hopping matrix of \f$M_\rho\f$.
+             * \param tolerance Relative residual at which conjugate gradient stops.
+             * \param maxIterations Maximum number of conjugate gradient iterations.
+             * \throws std::invalid_argument if the parameters are not supported.
+             */
+            HubbardFermiAction(const SparseMatrix<double> &kappaTilde,
+                               double muTilde, std::int8_t sigmaKappa, double hoppingScale,
+                               double tolerance=1e-10, std::size_t maxIterations=10000);
+
+            /// Construct from individual parameters of HubbardFermiMatrix[Dia,Exp].
+            HubbardFermiAction(const Lattice &lat, double beta,
+                               double muTilde, std::int8_t sigmaKappa, double hoppingScale,
+                               double tolerance=1e-10, std::size_t maxIterations=10000);
+
+            HubbardFermiAction(const HubbardFermiAction &other) = default;
+            HubbardFermiAction &operator=(const HubbardFermiAction &other) = default;
+            HubbardFermiAction(HubbardFermiAction &&other) = default;
+            HubbardFermiAction &operator=(HubbardFermiAction &&other) = default;
+            ~HubbardFermiAction() override = default;
+
+            /// Evaluate the %Action for given auxilliary field phi and current pseudofermions.
+            std::complex<double> eval(const CDVector &phi) const override;
+
+            /// Calculate force for given auxilliary field phi and current pseudofermions.
+            CDVector force(const CDVector &phi) const override;
+
+            /// Evaluate the %Action and calculate the force sharing a single solve.
+            std::pair<std::complex<double>, CDVector> evalAndForce(const CDVector &phi) const override;
+
+            /// Return true.
+            bool hasPseudofermions() const override {
+                return true;
+            }
+
+            /// Draw new pseudofermions \f$\chi = M_\rho^{-\dagger}(\phi) M^\dagger(\phi) \eta\f$.
+            void refreshPseudofermions(const CDVector &phi, std::uint64_t seed) override;
+
+            /// Return the current pseudofermions \f$\chi\f$.
+            const CDVector &pseudofermions() const noexcept;
+
+            /// Set the pseudofermions \f$\chi\f$ directly.
+            void setPseudofermions(const CDVector &chi);
+
+            /// Return the factor \f$\rho\f$ of the hopping matrix of \f$M_\rho\f$.
+            double hoppingScale() const noexcept;
+
+        private:
+            /// Compute \f$(M^\dagger M)^{-1} M_\rho^\dagger\chi\f$.
+            CDVector _solve(const CDVector &phi) const;
+
+            /// Stores all necessary parameters.
+            const typename _internal::HFM<HOPPING>::type _hfm;
+            /// Parameters of the heavy matrix \f$M_\rho\f$.
+            const typename _internal::HFM<HOPPING>::type _hfmHeavy;
+            const double _hoppingScale;  ///< Factor rho of the hopping matrix of _hfmHeavy.
+            const double _tolerance;  ///< Tolerance for conjugate gradient.
+            const std::size_t _maxIterations;  ///< Maximum number of CG iterations.
+            CDVector _chi;  ///< Pseudofermions.
+        };
+
+        extern template class HubbardFermiAction<HFAHopping::DIA, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::EXP, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>;
+        extern template class HubbardFermiAction<HFAHopping::CHECKERBOARD, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>;
+
     }  // namespace action
 }  // namespace isle
 
@@ -12,6 +12,11 @@ namespace isle {
 	         return -phi/utilde;
         }
 
+        std::pair<std::complex<double>, Vector<std::complex<double>>> HGA::evalAndForce(
+            const Vector<std::complex<double>> &phi) const {
+            return {(phi, phi)/2./utilde, -phi/utilde};
+        }
+
     }  // namespace action
 }  // namespace isle
 
@@ -34,6 +34,10 @@ namespace isle {
 
             /// Calculate force for given auxilliary field phi.
             Vector<std::complex<double>> force(const Vector<std::complex<double>> &phi) const override;
+
+            /// Evaluate the %Action and calculate the force for given auxilliary field phi.
+            std::pair<std::complex<double>, Vector<std::complex<double>>> evalAndForce(
+                const Vector<std::complex<double>> &phi) const override;
         };
     }  // namespace action
 }  // namespace isle
@@ -1,5 +1,8 @@
 #include "sumAction.hpp"
 
+#include <algorithm>
+#include <random>
+
 namespace isle {
     namespace action {
         Action *SumAction::add(Action *const action) {
@@ -40,5 +43,46 @@ namespace isle {
                 res += act->force(phi);
             return res;
         }
+
+        std::pair<std::complex<double>, CDVector> SumAction::evalAndForce(const CDVector &phi) const {
+            std::complex<double> val = 0;
+            CDVector force(phi.size(), 0);
+            for (auto &act : _subActions) {
+                const auto [subVal, subForce] = act->evalAndForce(phi);
+                val += subVal;
+                force += subForce;
+            }
+            return {val, std::move(force)};
+        }
+
+        CDVector SumAction::evalBatch(const CDMatrix &phis) const {
+            CDVector res(phis.rows(), 0);
+            for (auto &act : _subActions)
+                res += act->evalBatch(phis);
+            return res;
+        }
+
+        CDMatrix SumAction::forceBatch(const CDMatrix &phis) const {
+            CDMatrix res(phis.rows(), phis.columns(), 0);
+            for (auto &act : _subActions)
+                res += act->forceBatch(phis);
+            return res;
+        }
+
+        bool SumAction::hasPseudofermions() const {
+            return std::any_of(_subActions.begin(), _subActions.end(),
+                               [](const Action *act) { return act->hasPseudofermions(); });
+        }
+
+        void SumAction::refreshPseudofermions(const CDVector &phi, const std::uint64_t seed) {
+            std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                              static_cast<std::uint32_t>(seed >> 32)};
+            std::vector<std::uint32_t> seeds(2*_subActions.size());
+            seq.generate(seeds.begin(), seeds.end());
+
+            for (std::size_t i = 0; i < _subActions.size(); ++i)
+                _subActions[i]->refreshPseudofermions(
+                    phi, (static_cast<std::uint64_t>(seeds[2*i]) << 32) | seeds[2*i+1]);
+        }
     }
 }
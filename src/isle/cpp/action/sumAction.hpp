@@ -55,6 +55,24 @@ namespace isle {
             /// Calculate sum of forces for given auxilliary field phi.
             CDVector force(const CDVector &phi) const override;
 
+            /// Evaluate the sum of actions and sum of forces for given auxilliary field phi.
+            std::pair<std::complex<double>, CDVector> evalAndForce(const CDVector &phi) const override;
+
+            /// Evaluate the sum of actions for many configurations.
+            CDVector evalBatch(const CDMatrix &phis) const override;
+
+            /// Calculate sum of forces for many configurations.
+            CDMatrix forceBatch(const CDMatrix &phis) const override;
+
+            /// Return true if any of the actions depends on pseudofermion fields.
+            bool hasPseudofermions() const override;
+
+            /// Draw new pseudofermion fields for all actions.
+            /**
+             * Each action gets its own seed derived from `seed`.
+             */
+            void refreshPseudofermions(const CDVector &phi, std::uint64_t seed) override;
+
         private:
             std::vector<Action*> _subActions;  ///< Stores individual summands.
         };
@@ -11,6 +11,9 @@ using namespace isle::action;
 
 namespace bind {
     namespace {
+        /// Return type of Action::evalAndForce, PYBIND11_OVERLOAD can't handle commas.
+        using EvalAndForceResult = std::pair<std::complex<double>, Vector<std::complex<double>>>;
+
         /// Trampoline class for isle::action::Action to allow Python classes to
         /// override its virtual members.
         struct ActionTramp : Action {
@@ -33,6 +36,57 @@ namespace bind {
                     phi
                 );
             }
+
+            EvalAndForceResult evalAndForce(
+                const Vector<std::complex<double>> &phi) const override {
+
+                PYBIND11_OVERLOAD(
+                    EvalAndForceResult,
+                    Action,
+                    evalAndForce,
+                    phi
+                );
+            }
+
+            Vector<std::complex<double>> evalBatch(
+                const Matrix<std::complex<double>> &phis) const override {
+
+                PYBIND11_OVERLOAD(
+                    Vector<std::complex<double>>,
+                    Action,
+                    evalBatch,
+                    phis
+                );
+            }
+
+            Matrix<std::complex<double>> forceBatch(
+                const Matrix<std::complex<double>> &phis) const override {
+
+                PYBIND11_OVERLOAD(
+                    Matrix<std::complex<double>>,
+                    Action,
+                    forceBatch,
+                    phis
+                );
+            }
+
+            bool hasPseudofermions() const override {
+                PYBIND11_OVERLOAD(
+                    bool,
+                    Action,
+                    hasPseudofermions,
+                );
+            }
+
+            void refreshPseudofermions(const Vector<std::complex<double>> &phi,
+                                       const std::uint64_t seed) override {
+                PYBIND11_OVERLOAD(
+                    void,
+                    Action,
+                    refreshPseudofermions,
+                    phi, seed
+                );
+            }
         };
       
 
@@ -54,6 +108,11 @@ namespace bind {
                 .def(py::init<>())
                 .def("eval", &Action::eval)
                 .def("force", &Action::force)
+                .def("evalAndForce", &Action::evalAndForce)
+                .def("evalBatch", &Action::evalBatch, "phis"_a)
+                .def("forceBatch", &Action::forceBatch, "phis"_a)
+                .def("hasPseudofermions", &Action::hasPseudofermions)
+                .def("refreshPseudofermions", &Action::refreshPseudofermions, "phi"_a, "seed"_a)
                 .def("__add__", [](py::object &self, py::object &other) {
                                     SumAction sum;
                                     addAction(sum, self);
@@ -111,12 +170,48 @@ namespace bind {
                         "kappa"_a, "mu"_a, "sigmaKappa"_a, "allowShortcut"_a, "model_path"_a,"utilde"_a)
                     .def("eval", &HFA::eval)
                     .def("force", &HFA::force);
+            } else if constexpr (ALGORITHM == HFAAlgorithm::PSEUDOFERMION) {
+                py::class_<HFA>(mod, name, action)
+                    .def(py::init<SparseMatrix<double>, double, std::int8_t, double, std::size_t>(),
+                        "kappa"_a, "mu"_a, "sigmaKappa"_a,
+                        "tolerance"_a=1e-10, "maxIterations"_a=10000)
+                    .def("eval", &HFA::eval)
+                    .def("force", &HFA::force)
+                    .def("pseudofermions", &HFA::pseudofermions)
+                    .def("setPseudofermions", &HFA::setPseudofermions, "chi"_a);
+            } else if constexpr (ALGORITHM == HFAAlgorithm::RATIONAL) {
+                py::class_<HFA>(mod, name, action)
+                    .def(py::init<SparseMatrix<double>, double, std::int8_t,
+                                  double, double, double, double, std::size_t>(),
+                        "kappa"_a, "mu"_a, "sigmaKappa"_a,
+                        "power"_a, "lambdaMin"_a, "lambdaMax"_a,
+                        "tolerance"_a=1e-10, "maxIterations"_a=10000)
+                    .def("eval", &HFA::eval)
+                    .def("force", &HFA::force)
+                    .def("pseudofermions", &HFA::pseudofermions, "species"_a)
+                    .def("setPseudofermions", &HFA::setPseudofermions, "species"_a, "chi"_a)
+                    .def("power", &HFA::power)
+                    .def("actionApproximation", &HFA::actionApproximation)
+                    .def("heatbathApproximation", &HFA::heatbathApproximation);
+            } else if constexpr (ALGORITHM == HFAAlgorithm::HASENBUSCH) {
+                py::class_<HFA>(mod, name, action)
+                    .def(py::init<SparseMatrix<double>, double, std::int8_t,
+                                  double, double, std::size_t>(),
+                        "kappa"_a, "mu"_a, "sigmaKappa"_a, "hoppingScale"_a,
+                        "tolerance"_a=1e-10, "maxIterations"_a=10000)
+                    .def("eval", &HFA::eval)
+                    .def("force", &HFA::force)
+                    .def("pseudofermions", &HFA::pseudofermions)
+                    .def("setPseudofermions", &HFA::setPseudofermions, "chi"_a)
+                    .def("hoppingScale", &HFA::hoppingScale);
             } else{
                 py::class_<HFA>(mod, name, action)
-                    .def(py::init<SparseMatrix<double>, double, std::int8_t, bool>(),
-                        "kappa"_a, "mu"_a, "sigmaKappa"_a, "allowShortcut"_a)
+                    .def(py::init<SparseMatrix<double>, double, std::int8_t, bool, std::size_t, bool>(),
+                        "kappa"_a, "mu"_a, "sigmaKappa"_a, "allowShortcut"_a,
+                        "stabilizationInterval"_a=0, "singlePrecisionForce"_a=false)
                     .def("eval", &HFA::eval)
-                    .def("force", &HFA::force);
+                    .def("force", &HFA::force)
+                    .def("hfm", &HFA::hfm, py::return_value_policy::reference_internal);
             }
         }
 
@@ -127,52 +222,108 @@ namespace bind {
                                           const HFAHopping hopping,
                                           const HFABasis basis,
                                           const HFAAlgorithm algorithm,
-                                          const bool allowShortcut) {
+                                          const bool allowShortcut,
+                                          const std::size_t stabilizationInterval,
+                                          const bool singlePrecisionForce) {
 
             if (basis == HFABasis::PARTICLE_HOLE) {
+                if (algorithm == HFAAlgorithm::RATIONAL)
+                    throw std::invalid_argument("makeHubbardFermiAction is not implemented for algorithm = HFAAlgorithm.RATIONAL, "
+                                                "construct HubbardFermiAction[Dia,Exp,Checkerboard]RationalOne directly");
+                if (algorithm == HFAAlgorithm::HASENBUSCH)
+                    throw std::invalid_argument("makeHubbardFermiAction is not implemented for algorithm = HFAAlgorithm.HASENBUSCH, "
+                                                "construct HubbardFermiAction[Dia,Exp,Checkerboard]HasenbuschOne directly");
+
                 if (hopping == HFAHopping::DIA) {
                     if (algorithm == HFAAlgorithm::DIRECT_SINGLE) {
                         return py::cast(HubbardFermiAction<HFAHopping::DIA,
                                         HFAAlgorithm::DIRECT_SINGLE,
-                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                                 stabilizationInterval, singlePrecisionForce));
+                    } else if (algorithm == HFAAlgorithm::PSEUDOFERMION) {
+                        return py::cast(HubbardFermiAction<HFAHopping::DIA,
+                                        HFAAlgorithm::PSEUDOFERMION,
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa));
                     } else {  // HFAAlgorithm::DIRECT_SQUARE
                         return py::cast(HubbardFermiAction<HFAHopping::DIA,
                                         HFAAlgorithm::DIRECT_SQUARE,
-                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                                 stabilizationInterval, singlePrecisionForce));
                     }
-                } else {  // HFAHopping::EXP
+                } else if (hopping == HFAHopping::EXP) {
                     if (algorithm == HFAAlgorithm::DIRECT_SINGLE) {
                         return py::cast(HubbardFermiAction<HFAHopping::EXP,
                                         HFAAlgorithm::DIRECT_SINGLE,
-                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                                 stabilizationInterval, singlePrecisionForce));
                     } else if(algorithm == HFAAlgorithm::DIRECT_SQUARE){
                         return py::cast(HubbardFermiAction<HFAHopping::EXP,
                                         HFAAlgorithm::DIRECT_SQUARE,
-                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                                 stabilizationInterval, singlePrecisionForce));
+                    } else if (algorithm == HFAAlgorithm::PSEUDOFERMION) {
+                        return py::cast(HubbardFermiAction<HFAHopping::EXP,
+                                        HFAAlgorithm::PSEUDOFERMION,
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa));
                     } else {
                         throw std::invalid_argument("makeHubbardFermiAction is not implemented for algorithm = HFAAlgorithm.ML_APPROX_FORCE");
                     }
+                } else {  // HFAHopping::CHECKERBOARD
+                    if (algorithm == HFAAlgorithm::DIRECT_SINGLE) {
+                        return py::cast(HubbardFermiAction<HFAHopping::CHECKERBOARD,
+                                        HFAAlgorithm::DIRECT_SINGLE,
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                                 stabilizationInterval, singlePrecisionForce));
+                    } else if (algorithm == HFAAlgorithm::PSEUDOFERMION) {
+                        return py::cast(HubbardFermiAction<HFAHopping::CHECKERBOARD,
+                                        HFAAlgorithm::PSEUDOFERMION,
+                                        HFABasis::PARTICLE_HOLE>(kappaTilde, muTilde, sigmaKappa));
+                    } else {
+                        throw std::invalid_argument("HFAHopping.CHECKERBOARD only supports HFAAlgorithm.DIRECT_SINGLE, "
+                                                    "PSEUDOFERMION, RATIONAL, and HASENBUSCH");
+                    }
                 }
             } else {  // HFABasis::SPIN
+                if (algorithm == HFAAlgorithm::PSEUDOFERMION)
+                    throw std::invalid_argument("HFAAlgorithm.PSEUDOFERMION only supports HFABasis.PARTICLE_HOLE");
+                if (algorithm == HFAAlgorithm::RATIONAL)
+                    throw std::invalid_argument("HFAAlgorithm.RATIONAL only supports HFABasis.PARTICLE_HOLE");
+                if (algorithm == HFAAlgorithm::HASENBUSCH)
+                    throw std::invalid_argument("HFAAlgorithm.HASENBUSCH only supports HFABasis.PARTICLE_HOLE");
+
                 if (hopping == HFAHopping::DIA) {
                     if (algorithm == HFAAlgorithm::DIRECT_SINGLE) {
                         return py::cast(HubbardFermiAction<HFAHopping::DIA,
                                         HFAAlgorithm::DIRECT_SINGLE,
-                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                        stabilizationInterval, singlePrecisionForce));
                     } else {  // HFAAlgorithm::DIRECT_SQUARE
                         return py::cast(HubbardFermiAction<HFAHopping::DIA,
                                         HFAAlgorithm::DIRECT_SQUARE,
-                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                        stabilizationInterval, singlePrecisionForce));
                     }
-                } else {  // HFAHopping::EXP
+                } else if (hopping == HFAHopping::EXP) {
                     if (algorithm == HFAAlgorithm::DIRECT_SINGLE) {
                         return py::cast(HubbardFermiAction<HFAHopping::EXP,
                                         HFAAlgorithm::DIRECT_SINGLE,
-                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                        stabilizationInterval, singlePrecisionForce));
                     } else {  // HFAAlgorithm::DIRECT_SQUARE
                         return py::cast(HubbardFermiAction<HFAHopping::EXP,
                                         HFAAlgorithm::DIRECT_SQUARE,
-                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut));
+                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                        stabilizationInterval, singlePrecisionForce));
+                    }
+                } else {  // HFAHopping::CHECKERBOARD
+                    if (algorithm == HFAAlgorithm::DIRECT_SINGLE) {
+                        return py::cast(HubbardFermiAction<HFAHopping::CHECKERBOARD,
+                                        HFAAlgorithm::DIRECT_SINGLE,
+                                        HFABasis::SPIN>(kappaTilde, muTilde, sigmaKappa, allowShortcut,
+                                                        stabilizationInterval, singlePrecisionForce));
+                    } else {
+                        throw std::invalid_argument("HFAHopping.CHECKERBOARD only supports HFAAlgorithm.DIRECT_SINGLE, "
+                                                    "PSEUDOFERMION, RATIONAL, and HASENBUSCH");
                     }
                 }
             }
@@ -214,7 +365,10 @@ namespace bind {
             py::enum_<HFAAlgorithm>(mod, "HFAAlgorithm")
                 .value("DIRECT_SINGLE", HFAAlgorithm::DIRECT_SINGLE)
                 .value("DIRECT_SQUARE", HFAAlgorithm::DIRECT_SQUARE)
-                .value("ML_APPROX_FORCE", HFAAlgorithm::ML_APPROX_FORCE);
+                .value("ML_APPROX_FORCE", HFAAlgorithm::ML_APPROX_FORCE)
+                .value("PSEUDOFERMION", HFAAlgorithm::PSEUDOFERMION)
+                .value("RATIONAL", HFAAlgorithm::RATIONAL)
+                .value("HASENBUSCH", HFAAlgorithm::HASENBUSCH);
 
             py::enum_<HFABasis>(mod, "HFABasis")
                 .value("PARTICLE_HOLE", HFABasis::PARTICLE_HOLE)
@@ -222,7 +376,8 @@ namespace bind {
 
             py::enum_<HFAHopping>(mod, "HFAHopping")
                 .value("DIA", HFAHopping::DIA)
-                .value("EXP", HFAHopping::EXP);
+                .value("EXP", HFAHopping::EXP)
+                .value("CHECKERBOARD", HFAHopping::CHECKERBOARD);
 
             // bind all specific actions
             bindSpecificHFA<HFAHopping::DIA, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionDiaDirsingleOne", action);
@@ -235,32 +390,54 @@ namespace bind {
             bindSpecificHFA<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionExpDirsquareOne", action);
             bindSpecificHFA<HFAHopping::EXP, HFAAlgorithm::DIRECT_SQUARE, HFABasis::SPIN>(mod, "HubbardFermiActionExpDirsquareZero", action);
 
+            bindSpecificHFA<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionCheckerboardDirsingleOne", action);
+            bindSpecificHFA<HFAHopping::CHECKERBOARD, HFAAlgorithm::DIRECT_SINGLE, HFABasis::SPIN>(mod, "HubbardFermiActionCheckerboardDirsingleZero", action);
+
             bindSpecificHFA<HFAHopping::EXP, HFAAlgorithm::ML_APPROX_FORCE, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionExpMLApproxOne", action);
 
+            bindSpecificHFA<HFAHopping::DIA, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionDiaPseudofermionOne", action);
+            bindSpecificHFA<HFAHopping::EXP, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionExpPseudofermionOne", action);
+            bindSpecificHFA<HFAHopping::CHECKERBOARD, HFAAlgorithm::PSEUDOFERMION, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionCheckerboardPseudofermionOne", action);
+
+            bindSpecificHFA<HFAHopping::DIA, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionDiaRationalOne", action);
+            bindSpecificHFA<HFAHopping::EXP, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionExpRationalOne", action);
+            bindSpecificHFA<HFAHopping::CHECKERBOARD, HFAAlgorithm::RATIONAL, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionCheckerboardRationalOne", action);
+
+            bindSpecificHFA<HFAHopping::DIA, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionDiaHasenbuschOne", action);
+            bindSpecificHFA<HFAHopping::EXP, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionExpHasenbuschOne", action);
+            bindSpecificHFA<HFAHopping::CHECKERBOARD, HFAAlgorithm::HASENBUSCH, HFABasis::PARTICLE_HOLE>(mod, "HubbardFermiActionCheckerboardHasenbuschOne", action);
+
             mod.def("makeHubbardFermiAction",
                     makeHubbardFermiAction,
                     "kappaTilde"_a, "muTilde"_a, "sigmaKappa"_a,
                     "hopping"_a=HFAHopping::DIA,
                     "basis"_a=HFABasis::PARTICLE_HOLE,
                     "algorithm"_a= HFAAlgorithm::DIRECT_SINGLE,
-                    "allowShortcut"_a=false);
+                    "allowShortcut"_a=false,
+                    "stabilizationInterval"_a=0,
+                    "singlePrecisionForce"_a=false);
 
             mod.def("makeHubbardFermiAction",
                     [] (const Lattice &lattice, const double beta,
                         const double muTilde, const std::int8_t sigmaKappa,
                         const HFAHopping hopping, const HFABasis basis,
-                        const HFAAlgorithm algorithm, const bool allowShortcut) {
+                        const HFAAlgorithm algorithm, const bool allowShortcut,
+                        const std::size_t stabilizationInterval,
+                        const bool singlePrecisionForce) {
 
                         return makeHubbardFermiAction(
                             lattice.hopping()*beta/lattice.nt(),
                             muTilde, sigmaKappa,
-                            hopping, basis, algorithm, allowShortcut);
+                            hopping, basis, algorithm, allowShortcut,
+                            stabilizationInterval, singlePrecisionForce);
                     },
                     "lat"_a, "beta"_a, "muTilde"_a, "sigmaKappa"_a,
                     "hopping"_a=HFAHopping::DIA,
                     "basis"_a=HFABasis::PARTICLE_HOLE,
                     "algorithm"_a= HFAAlgorithm::DIRECT_SINGLE,
-                    "allowShortcut"_a=false);
+                    "allowShortcut"_a=false,
+                    "stabilizationInterval"_a=0,
+                    "singlePrecisionForce"_a=false);
 
              mod.def("makeHubbardFermiActionMLApprox",
                     makeHubbardFermiActionMLApprox,
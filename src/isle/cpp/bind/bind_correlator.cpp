@@ -0,0 +1,113 @@
+#include "bind_correlator.hpp"
+
+#include "../correlator.hpp"
+
+using namespace pybind11::literals;
+using namespace isle;
+
+namespace bind {
+    namespace {
+        /// Numpy array holding a propagator, converted to C-contiguous complex if need be.
+        using PropagatorArray = py::array_t<std::complex<double>,
+                                            py::array::c_style | py::array::forcecast>;
+
+        /// Return a pointer to the data of a 4D propagator array and check its shape.
+        const std::complex<double> *propagatorData(
+            const PropagatorArray &propagator,
+            const py::ssize_t nx, const py::ssize_t nt) {
+
+            if (propagator.ndim() != 4 || propagator.shape(0) != nx || propagator.shape(1) != nt
+                || propagator.shape(2) != nx || propagator.shape(3) != nt)
+                throw std::invalid_argument("Propagator must have shape (nx, nt, nx, nt)");
+            return propagator.data();
+        }
+
+        /// Return a pointer to the data of an output array and check its layout.
+        std::complex<double> *outputData(py::array &out) {
+            if (!out.dtype().is(py::dtype::of<std::complex<double>>())
+                || !(out.flags() & py::array::c_style) || !out.writeable())
+                throw std::invalid_argument("Output array must be a writeable, C-contiguous array of complex numbers");
+            return static_cast<std::complex<double>*>(out.mutable_data());
+        }
+
+        /// Return a pointer to the data of an output array and check its shape and layout.
+        std::complex<double> *outputData(py::array &out, const py::ssize_t m, const py::ssize_t nt) {
+            if (out.ndim() != 3 || out.shape(0) != m || out.shape(1) != m || out.shape(2) != nt)
+                throw std::invalid_argument("Output array has wrong shape");
+            return outputData(out);
+        }
+    }
+
+    void bindCorrelators(py::module &mod) {
+        py::enum_<SPCorrelator>(mod, "SPCorrelator")
+            .value("CREATION_DESTRUCTION", SPCorrelator::CREATION_DESTRUCTION)
+            .value("DESTRUCTION_CREATION", SPCorrelator::DESTRUCTION_CREATION);
+
+        mod.def("singleParticleCorrelator",
+                [](PropagatorArray propagator,
+                   const SPCorrelator correlator,
+                   py::array out,
+                   const CDMatrix &transform) {
+                    if (propagator.ndim() != 4)
+                        throw std::invalid_argument("Propagator must have shape (nx, nt, nx, nt)");
+                    const auto nx = propagator.shape(0);
+                    const auto nt = propagator.shape(1);
+                    const auto m = static_cast<py::ssize_t>(
+                        transform.rows() == 0 ? static_cast<std::size_t>(nx) : transform.columns());
+
+                    singleParticleCorrelator(propagatorData(propagator, nx, nt),
+                                             static_cast<std::size_t>(nx), static_cast<std::size_t>(nt),
+                                             correlator, transform, outputData(out, m, nt));
+                },
+                "propagator"_a, "correlator"_a, "out"_a, "transform"_a=CDMatrix{});
+
+        py::enum_<SSCorrelator>(mod, "SSCorrelator")
+            .value("NP_NP", SSCorrelator::NP_NP)
+            .value("NH_NP", SSCorrelator::NH_NP)
+            .value("NP_NH", SSCorrelator::NP_NH)
+            .value("NH_NH", SSCorrelator::NH_NH)
+            .value("SPLUS_SMINUS", SSCorrelator::SPLUS_SMINUS)
+            .value("SMINUS_SPLUS", SSCorrelator::SMINUS_SPLUS)
+            .value("PLUSPLUS_MINUSMINUS", SSCorrelator::PLUSPLUS_MINUSMINUS)
+            .value("MINUSMINUS_PLUSPLUS", SSCorrelator::MINUSMINUS_PLUSPLUS);
+
+        mod.def("spinSpinCorrelators",
+                [](PropagatorArray particle,
+                   PropagatorArray hole,
+                   const std::vector<SSCorrelator> &correlators,
+                   std::vector<py::array> outs,
+                   const CDMatrix &transform) {
+                    if (particle.ndim() != 4)
+                        throw std::invalid_argument("Propagator must have shape (nx, nt, nx, nt)");
+                    const auto nx = particle.shape(0);
+                    const auto nt = particle.shape(1);
+                    const auto m = static_cast<py::ssize_t>(
+                        transform.rows() == 0 ? static_cast<std::size_t>(nx) : transform.columns());
+
+                    std::vector<std::complex<double>*> outPtrs;
+                    outPtrs.reserve(outs.size());
+                    for (auto &out : outs)
+                        outPtrs.push_back(outputData(out, m, nt));
+
+                    spinSpinCorrelators(propagatorData(particle, nx, nt), propagatorData(hole, nx, nt),
+                                        static_cast<std::size_t>(nx), static_cast<std::size_t>(nt),
+                                        correlators, transform, outPtrs);
+                },
+                "particle"_a, "hole"_a, "correlators"_a, "outs"_a, "transform"_a=CDMatrix{});
+
+        mod.def("logdetBatch",
+                [](py::array_t<std::complex<double>, py::array::c_style | py::array::forcecast> matrices,
+                   py::array out) {
+                    const auto ndim = matrices.ndim();
+                    if (ndim < 2 || matrices.shape(ndim-1) != matrices.shape(ndim-2))
+                        throw std::invalid_argument("Matrices must have shape (..., n, n)");
+                    const auto n = static_cast<std::size_t>(matrices.shape(ndim-1));
+                    const auto count = n == 0 ? 0 : static_cast<std::size_t>(matrices.size()) / (n*n);
+                    if (static_cast<std::size_t>(out.size()) != count)
+                        throw std::invalid_argument("Output array must have one element per matrix");
+
+                    logdetBatch(matrices.data(), n, count, n*n, outputData(out));
+                },
+                "matrices"_a, "out"_a);
+    }
+}
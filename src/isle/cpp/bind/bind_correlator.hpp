@@ -0,0 +1,15 @@
+/** \file
+ * \brief Bindings for correlator kernels.
+ */
+
+#ifndef BIND_CORRELATOR_HPP
+#define BIND_CORRELATOR_HPP
+
+#include "bind_core.hpp"
+
+namespace bind {
+    /// Bind kernels to compute correlation functions from propagators.
+    void bindCorrelators(py::module &mod);
+}
+
+#endif  // ndef BIND_CORRELATOR_HPP
@@ -3,9 +3,12 @@
 #include <array>
 
 #include "../species.hpp"
+#include "../hubbardFermiMatrixCheckerboard.hpp"
 #include "../hubbardFermiMatrixDia.hpp"
 #include "../hubbardFermiMatrixExp.hpp"
+#include "../stochasticTrace.hpp"
 
+using namespace pybind11::literals;
 using namespace isle;
 
 namespace bind {
@@ -16,8 +19,21 @@ namespace bind {
             // nothing special in this case
         }
 
-        void bindHoppingSpecific(py::module &, py::class_<HubbardFermiMatrixExp> &hfmd) {
-            hfmd.def("expKappa", &HubbardFermiMatrixExp::expKappa);
+        void bindHoppingSpecific(py::module &mod, py::class_<HubbardFermiMatrixExp> &hfmd) {
+            hfmd.def("expKappa", &HubbardFermiMatrixExp::expKappa)
+                .def("logdetExpKappa", &HubbardFermiMatrixExp::logdetExpKappa, "species"_a, "inv"_a)
+                .def("updateKappaTilde", &HubbardFermiMatrixExp::updateKappaTilde, "kappaTilde"_a)
+                .def("scaleKappaTilde", &HubbardFermiMatrixExp::scaleKappaTilde, "factor"_a)
+                .def("updateMuTilde", &HubbardFermiMatrixExp::updateMuTilde, "muTilde"_a)
+                .def("updateSigmaKappa", &HubbardFermiMatrixExp::updateSigmaKappa, "sigmaKappa"_a);
+
+            // mu only enters expKappa in this discretization
+            mod.def("logTransferMatrixEigenvalues", logTransferMatrixEigenvalues,
+                    "hfm"_a, "phi"_a, "species"_a, "stabilizationInterval"_a=0);
+            mod.def("logdetMScan", logdetMScan,
+                    "logEigenvalues"_a, "nt"_a, "species"_a, "muTildes"_a);
+            mod.def("logCanonicalProjections", logCanonicalProjections,
+                    "logEigenvaluesParticles"_a, "logEigenvaluesHoles"_a);
         }
 
         template <typename HFM>
@@ -41,21 +57,166 @@ namespace bind {
                 .def("sigmaKappa", &HFM::sigmaKappa)
                 ;
 
+            py::class_<typename HFM::QLU>{hfmd, "QLU"}
+                .def(py::init<>())
+                .def("isConsistent", &HFM::QLU::isConsistent)
+                .def("reconstruct", &HFM::QLU::reconstruct)
+                .def("nx", &HFM::QLU::nx)
+                .def("nt", &HFM::QLU::nt);
+
+            mod.def("getQLU", py::overload_cast<const HFM&, const CDVector&>(getQLU),
+                    "hfm"_a, "phi"_a);
+            mod.def("getQLU", py::overload_cast<const HFM&, const CDVector&,
+                    typename HFM::QLU&>(getQLU),
+                    "hfm"_a, "phi"_a, "into"_a);
+            mod.def("logdetQ",
+                    static_cast<std::complex<double>(*)(const typename HFM::QLU&)>(logdetQ),
+                    "lu"_a);
+            mod.def("solveQ", static_cast<CDVector(*)(const typename HFM::QLU&,
+                                                      const CDVector&)>(solveQ),
+                    "lu"_a, "rhs"_a);
+            mod.def("solveQ", static_cast<CDMatrix(*)(const typename HFM::QLU&,
+                                                      const CDMatrix&,
+                                                      std::size_t)>(solveQ),
+                    "lu"_a, "rhss"_a, "nblocks"_a=1);
+
             mod.def("logdetQ",
                     static_cast<std::complex<double>(*)(const HFM&,
-                                                        const CDVector&)>(logdetQ));
+                                                        const CDVector&,
+                                                        QFactorization)>(logdetQ),
+                    "hfm"_a, "phi"_a, "algorithm"_a=QFactorization::LU);
             mod.def("solveQ", static_cast<CDVector(*)(const HFM&,
                                                       const CDVector&,
-                                                      const CDVector&)>(solveQ));
+                                                      const CDVector&,
+                                                      QFactorization)>(solveQ),
+                    "hfm"_a, "phi"_a, "rhs"_a, "algorithm"_a=QFactorization::LU);
 
             mod.def("logdetM", py::overload_cast<
-                    const HFM&, const CDVector &, Species>(logdetM));
+                    const HFM&, const CDVector &, Species, std::size_t>(logdetM),
+                    "hfm"_a, "phi"_a, "species"_a, "stabilizationInterval"_a=0);
+            mod.def("logdetMBatch", py::overload_cast<
+                    const HFM&, const CDMatrix &, Species, std::size_t>(logdetMBatch),
+                    "hfm"_a, "phis"_a, "species"_a, "stabilizationInterval"_a=0);
             mod.def("solveM", py::overload_cast<
-                    const HFM&, const CDVector&, Species, const CDMatrix&>(
-                        solveM));
+                    const HFM&, const CDVector&, Species, const CDMatrix&, std::size_t>(
+                        solveM),
+                    "hfm"_a, "phi"_a, "species"_a, "rhss"_a, "stabilizationInterval"_a=0);
+            mod.def("applyM",
+                    [](const HFM &hfm, const CDVector &phi, const Species species,
+                       const CDVector &in, const bool dagger) {
+                        CDVector out;
+                        applyM(hfm, phi, species, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "species"_a, "in"_a, "dagger"_a=false);
+            mod.def("applyM",
+                    [](const HFM &hfm, const CDVector &phi, const Species species,
+                       const CDMatrix &in, const bool dagger) {
+                        CDMatrix out;
+                        applyM(hfm, phi, species, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "species"_a, "in"_a, "dagger"_a=false);
+            mod.def("applyQ",
+                    [](const HFM &hfm, const CDVector &phi,
+                       const CDVector &in, const bool dagger) {
+                        CDVector out;
+                        applyQ(hfm, phi, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "in"_a, "dagger"_a=false);
+            mod.def("applyQ",
+                    [](const HFM &hfm, const CDVector &phi,
+                       const CDMatrix &in, const bool dagger) {
+                        CDMatrix out;
+                        applyQ(hfm, phi, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "in"_a, "dagger"_a=false);
+            mod.def("allToAllPropagator",
+                    [](const HFM &hfm, const CDVector &phi, const Species species,
+                       py::array_t<std::complex<double>, py::array::c_style> out) {
+                        const auto nx = static_cast<py::ssize_t>(hfm.nx());
+                        const auto nt = static_cast<py::ssize_t>(getNt(phi, hfm.nx()));
+                        if (out.ndim() != 4 || out.shape(0) != nx || out.shape(1) != nt
+                            || out.shape(2) != nx || out.shape(3) != nt)
+                            throw std::invalid_argument("Output array must have shape (nx, nt, nx, nt)");
+                        allToAllPropagator(hfm, phi, species, out.mutable_data());
+                    },
+                    "hfm"_a, "phi"_a, "species"_a, py::arg("out").noconvert());
+            mod.def("stochasticTrace", py::overload_cast<
+                    const HFM&, const CDVector&, Species, const std::vector<CDMatrix>&,
+                    std::size_t, std::uint64_t, NoiseType, Dilution>(stochasticTrace),
+                    "hfm"_a, "phi"_a, "species"_a, "operators"_a, "nnoise"_a, "seed"_a,
+                    "noise"_a=NoiseType::Z2, "dilution"_a=Dilution{});
 
             bindHoppingSpecific(mod, hfmd);
         }
+
+        /// Checkerboard hopping only supports the matrices and Krylov building blocks.
+        void bindCheckerboardHFM(py::module &mod) {
+            using HFM = HubbardFermiMatrixCheckerboard;
+            py::class_<HFM>{mod, "HubbardFermiMatrixCheckerboard"}
+                .def(py::init<DSparseMatrix, double, std::int8_t>())
+                .def(py::init<Lattice, double, double, std::int8_t>())
+                .def("K", py::overload_cast<Species>(&HFM::K, py::const_))
+                .def("F", py::overload_cast<std::size_t, const CDVector&,
+                     Species, bool>(&HFM::F, py::const_))
+                .def("M", py::overload_cast<const CDVector&, Species>(&HFM::M, py::const_))
+                .def("expKappa", &HFM::expKappa, "species"_a, "inv"_a)
+                .def("applyExpKappa",
+                     [](const HFM &hfm, CDVector vec, const Species species, const bool inv) {
+                         hfm.applyExpKappa(vec, species, inv);
+                         return vec;
+                     },
+                     "vec"_a, "species"_a, "inv"_a)
+                .def("nBondClasses", &HFM::nBondClasses)
+                .def("bondClass", &HFM::bondClass, "c"_a)
+                .def("nx", &HFM::nx)
+                .def("kappaTilde", &HFM::kappaTilde)
+                .def("muTilde", &HFM::muTilde)
+                .def("sigmaKappa", &HFM::sigmaKappa)
+                ;
+
+            mod.def("logdetM", py::overload_cast<
+                    const HFM&, const CDVector &, Species, std::size_t>(logdetM),
+                    "hfm"_a, "phi"_a, "species"_a, "stabilizationInterval"_a=0);
+            mod.def("logdetMBatch", py::overload_cast<
+                    const HFM&, const CDMatrix &, Species, std::size_t>(logdetMBatch),
+                    "hfm"_a, "phis"_a, "species"_a, "stabilizationInterval"_a=0);
+            mod.def("applyM",
+                    [](const HFM &hfm, const CDVector &phi, const Species species,
+                       const CDVector &in, const bool dagger) {
+                        CDVector out;
+                        applyM(hfm, phi, species, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "species"_a, "in"_a, "dagger"_a=false);
+            mod.def("applyM",
+                    [](const HFM &hfm, const CDVector &phi, const Species species,
+                       const CDMatrix &in, const bool dagger) {
+                        CDMatrix out;
+                        applyM(hfm, phi, species, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "species"_a, "in"_a, "dagger"_a=false);
+            mod.def("applyQ",
+                    [](const HFM &hfm, const CDVector &phi,
+                       const CDVector &in, const bool dagger) {
+                        CDVector out;
+                        applyQ(hfm, phi, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "in"_a, "dagger"_a=false);
+            mod.def("applyQ",
+                    [](const HFM &hfm, const CDVector &phi,
+                       const CDMatrix &in, const bool dagger) {
+                        CDMatrix out;
+                        applyQ(hfm, phi, in, out, dagger);
+                        return out;
+                    },
+                    "hfm"_a, "phi"_a, "in"_a, "dagger"_a=false);
+        }
     }
 
     void bindHubbardFermiMatrix(py::module &mod) {
@@ -67,7 +228,25 @@ namespace bind {
                      return py::make_iterator(SPECIES_VALUES.cbegin(), SPECIES_VALUES.cend());
                  });
 
+        py::enum_<QFactorization>(mod, "QFactorization")
+            .value("LU", QFactorization::LU)
+            .value("CYCLIC_REDUCTION", QFactorization::CYCLIC_REDUCTION);
+
+        py::enum_<NoiseType>(mod, "NoiseType")
+            .value("Z2", NoiseType::Z2)
+            .value("Z4", NoiseType::Z4)
+            .value("GAUSSIAN", NoiseType::GAUSSIAN);
+
+        py::class_<Dilution>(mod, "Dilution")
+            .def(py::init([](const std::size_t time, const std::size_t space) {
+                         return Dilution{time, space};
+                     }),
+                 "time"_a=1, "space"_a=1)
+            .def_readwrite("time", &Dilution::time)
+            .def_readwrite("space", &Dilution::space);
+
         bindHFM<HubbardFermiMatrixDia>(mod, "HubbardFermiMatrixDia");
         bindHFM<HubbardFermiMatrixExp>(mod, "HubbardFermiMatrixExp");
+        bindCheckerboardHFM(mod);
     }
 }
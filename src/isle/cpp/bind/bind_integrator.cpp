@@ -9,6 +9,9 @@ namespace bind {
     void bindIntegrators(py::module &mod) {
         mod.def("leapfrog", leapfrog, "phi"_a, "pi"_a, "action"_a,
                 "length"_a, "nsteps"_a, "direction"_a=+1);
+        mod.def("multiTimescaleLeapfrog", multiTimescaleLeapfrog,
+                "phi"_a, "pi"_a, "action"_a, "timescales"_a,
+                "length"_a, "nsteps"_a, "direction"_a=+1);
         mod.def("rungeKutta4Flow", rungeKutta4Flow,
                 "phi"_a,
                 "action"_a,
@@ -0,0 +1,64 @@
+#include "bind_krylov.hpp"
+
+#include "../krylov.hpp"
+#include "../evenOddPreconditioner.hpp"
+#include "../rationalApproximation.hpp"
+
+using namespace pybind11::literals;
+using namespace isle;
+
+namespace bind {
+    void bindKrylov(py::module &mod) {
+        py::class_<SolverInfo>(mod, "SolverInfo")
+            .def_readonly("iterations", &SolverInfo::iterations)
+            .def_readonly("residual", &SolverInfo::residual)
+            .def("__repr__", [](const SolverInfo &info) {
+                                 return "SolverInfo(iterations=" + std::to_string(info.iterations)
+                                     + ", residual=" + std::to_string(info.residual) + ")";
+                             })
+            ;
+
+        py::class_<RationalApproximation>(mod, "RationalApproximation")
+            .def(py::init<double, double, double, double>(),
+                 "power"_a, "lambdaMin"_a, "lambdaMax"_a, "tolerance"_a)
+            .def("__call__", &RationalApproximation::operator(), "x"_a)
+            .def("power", &RationalApproximation::power)
+            .def("lambdaMin", &RationalApproximation::lambdaMin)
+            .def("lambdaMax", &RationalApproximation::lambdaMax)
+            .def("constant", &RationalApproximation::constant)
+            .def("residues", &RationalApproximation::residues)
+            .def("shifts", &RationalApproximation::shifts)
+            .def("maxRelativeError", &RationalApproximation::maxRelativeError)
+            ;
+
+        py::class_<EvenOddPreconditioner>(mod, "EvenOddPreconditioner")
+            .def(py::init<const HubbardFermiMatrixDia&, const CDVector&, Species, std::size_t>(),
+                 "hfm"_a, "phi"_a, "species"_a, "levels"_a=1)
+            .def(py::init<const HubbardFermiMatrixExp&, const CDVector&, Species, std::size_t>(),
+                 "hfm"_a, "phi"_a, "species"_a, "levels"_a=1)
+            .def("reduce", &EvenOddPreconditioner::reduce, "rhs"_a)
+            .def("apply", [](const EvenOddPreconditioner &eo, const CDVector &in,
+                             const bool dagger) {
+                              CDVector out;
+                              eo.apply(in, out, dagger);
+                              return out;
+                          },
+                "in"_a, "dagger"_a=false)
+            .def("reconstruct", &EvenOddPreconditioner::reconstruct, "reduced"_a, "rhs"_a)
+            .def("solve", [](const EvenOddPreconditioner &eo, const CDVector &rhs,
+                             const double tolerance, const std::size_t maxIterations) {
+                              CDVector x;
+                              const SolverInfo info = eo.solve(rhs, x, tolerance, maxIterations);
+                              return std::make_tuple(x, info);
+                          },
+                "rhs"_a, "tolerance"_a=1e-10, "maxIterations"_a=10000)
+            .def("solve", py::overload_cast<const CDMatrix&, double, std::size_t>(
+                     &EvenOddPreconditioner::solve, py::const_),
+                 "rhss"_a, "tolerance"_a=1e-10, "maxIterations"_a=10000)
+            .def("nx", &EvenOddPreconditioner::nx)
+            .def("nt", &EvenOddPreconditioner::nt)
+            .def("ntReduced", &EvenOddPreconditioner::ntReduced)
+            .def("levels", &EvenOddPreconditioner::levels)
+            ;
+    }
+}
@@ -0,0 +1,15 @@
+/** \file
+ * \brief Bindings for iterative solvers.
+ */
+
+#ifndef BIND_KRYLOV_HPP
+#define BIND_KRYLOV_HPP
+
+#include "bind_core.hpp"
+
+namespace bind {
+    /// Bind SolverInfo, RationalApproximation, and EvenOddPreconditioner.
+    void bindKrylov(py::module &mod);
+}
+
+#endif  // ndef BIND_KRYLOV_HPP
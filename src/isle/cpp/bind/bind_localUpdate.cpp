@@ -0,0 +1,22 @@
+#include "bind_localUpdate.hpp"
+
+#include "../localUpdate.hpp"
+
+using namespace pybind11::literals;
+using namespace isle;
+
+namespace bind {
+    void bindLocalUpdate(py::module &mod) {
+        py::class_<LocalUpdate>(mod, "LocalUpdate")
+            .def(py::init<const HubbardFermiMatrixDia&, double, std::size_t, std::size_t>(),
+                 "hfm"_a, "utilde"_a, "recomputeInterval"_a=4, "delay"_a=1)
+            .def(py::init<const HubbardFermiMatrixExp&, double, std::size_t, std::size_t>(),
+                 "hfm"_a, "utilde"_a, "recomputeInterval"_a=4, "delay"_a=1)
+            .def("sweep", &LocalUpdate::sweep,
+                 "phi"_a, "nsweeps"_a, "maxStep"_a, "seed"_a)
+            .def("utilde", &LocalUpdate::utilde)
+            .def("recomputeInterval", &LocalUpdate::recomputeInterval)
+            .def("delay", &LocalUpdate::delay)
+            ;
+    }
+}
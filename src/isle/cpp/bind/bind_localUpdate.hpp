@@ -0,0 +1,15 @@
+/** \file
+ * \brief Bindings for local updates.
+ */
+
+#ifndef BIND_LOCAL_UPDATE_HPP
+#define BIND_LOCAL_UPDATE_HPP
+
+#include "bind_core.hpp"
+
+namespace bind {
+    /// Bind class LocalUpdate.
+    void bindLocalUpdate(py::module &mod);
+}
+
+#endif  // ndef BIND_LOCAL_UPDATE_HPP
@@ -1,9 +1,12 @@
 #include "bind_core.hpp"
 
 #include "bind_action.hpp"
+#include "bind_correlator.hpp"
 #include "bind_hubbardFermiMatrix.hpp"
 #include "bind_integrator.hpp"
+#include "bind_krylov.hpp"
 #include "bind_lattice.hpp"
+#include "bind_localUpdate.hpp"
 #include "bind_math.hpp"
 #include "bind_version.hpp"
 
@@ -21,4 +24,7 @@ PYBIND11_MODULE(ISLE_LIBNAME, mod) {
     bind::bindHubbardFermiMatrix(mod);
     bind::bindActions(mod);
     bind::bindIntegrators(mod);
+    bind::bindCorrelators(mod);
+    bind::bindLocalUpdate(mod);
+    bind::bindKrylov(mod);
 }
@@ -0,0 +1,32 @@
+#include "blockStorage.hpp"
+
+#include <algorithm>
+
+namespace isle {
+    BlockStorage::BlockStorage(const std::size_t nx, const std::size_t nblocks)
+        : _nx{nx},
+          _spacing{blaze::nextMultiple<std::size_t>(
+                  nx, blaze::SIMDTrait<std::complex<double>>::size)},
+          _nblocks{nblocks},
+          _data{blaze::allocate<std::complex<double>>(nblocks*nx*_spacing)} {
+
+        // padding elements must be zero for blaze
+        std::fill_n(_data.get(), nblocks*nx*_spacing, std::complex<double>{0.0});
+    }
+
+    BlockStorage::Block BlockStorage::block(const std::size_t i) noexcept(ndebug) {
+#ifndef NDEBUG
+        if (i >= _nblocks)
+            throw std::out_of_range("Block index out of range.");
+#endif
+        return Block(_data.get() + i*_nx*_spacing, _nx, _nx, _spacing);
+    }
+
+    std::size_t BlockStorage::nx() const noexcept {
+        return _nx;
+    }
+
+    std::size_t BlockStorage::nblocks() const noexcept {
+        return _nblocks;
+    }
+}  // namespace isle
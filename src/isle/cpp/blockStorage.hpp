@@ -0,0 +1,61 @@
+/** \file
+ * \brief Contiguous storage for many square matrices of equal size.
+ */
+
+#ifndef BLOCK_STORAGE_HPP
+#define BLOCK_STORAGE_HPP
+
+#include <memory>
+
+#include "math.hpp"
+
+namespace isle {
+
+    /// Contiguous, aligned storage for square complex matrices (blocks) of equal size.
+    /**
+     * All blocks live in one slab of memory which is allocated once at construction.
+     * Individual blocks are accessed through blaze::CustomMatrix views that can be
+     * used like regular dense matrices but never reallocate.
+     * Rows are padded to a multiple of the SIMD width such that every row starts at
+     * an aligned address.
+     *
+     * \warning Views returned by BlockStorage::block() are invalidated when the
+     *          storage is destroyed or assigned to. Moving a BlockStorage keeps them valid.
+     */
+    class BlockStorage {
+    public:
+        /// View on one block.
+        using Block = blaze::CustomMatrix<std::complex<double>, blaze::aligned, blaze::padded>;
+
+        /// Construct without allocating any memory.
+        BlockStorage() noexcept = default;
+
+        /// Allocate memory for `nblocks` blocks of size `nx x nx` and set all elements to zero.
+        BlockStorage(std::size_t nx, std::size_t nblocks);
+
+        /// Return a view on block number i.
+        Block block(std::size_t i) noexcept(ndebug);
+
+        /// Size of each block.
+        std::size_t nx() const noexcept;
+
+        /// Number of blocks.
+        std::size_t nblocks() const noexcept;
+
+    private:
+        /// Release memory obtained from blaze::allocate.
+        struct Deleter {
+            void operator()(std::complex<double> *ptr) const noexcept {
+                blaze::deallocate(ptr);
+            }
+        };
+
+        std::size_t _nx = 0;  ///< Number of rows and columns of each block.
+        std::size_t _spacing = 0;  ///< Distance between rows in memory.
+        std::size_t _nblocks = 0;  ///< Number of blocks.
+        std::unique_ptr<std::complex<double>[], Deleter> _data;  ///< The slab.
+    };
+
+}  // namespace isle
+
+#endif  // ndef BLOCK_STORAGE_HPP
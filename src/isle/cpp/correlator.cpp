@@ -0,0 +1,219 @@
+#include "correlator.hpp"
+
+#include <algorithm>
+
+#include "parallel.hpp"
+
+namespace isle {
+    namespace {
+        /// Return the number of columns of the result of a transformation.
+        std::size_t transformedSize(const CDMatrix &transform, const std::size_t nx) {
+            if (transform.rows() == 0)
+                return nx;
+            if (transform.rows() != nx)
+                throw std::invalid_argument("Number of rows of transform does not match nx.");
+            return transform.columns();
+        }
+
+        /// Write T^dagger corr T (or corr if transform is empty) into out[(x*m + y)*nt + tau].
+        void storeTransformed(const CDMatrix &corr, const CDMatrix &transform,
+                              const std::size_t tau, const std::size_t nt,
+                              std::complex<double> *const out) {
+            const auto store = [tau, nt, out](const auto &mat) {
+                const std::size_t m = mat.rows();
+                for (std::size_t x = 0; x < m; ++x)
+                    for (std::size_t y = 0; y < m; ++y)
+                        out[(x*m + y)*nt + tau] = mat(x, y);
+            };
+
+            if (transform.rows() == 0)
+                store(corr);
+            else
+                store(CDMatrix(blaze::ctrans(transform)*corr*transform));
+        }
+
+        /// log(det()) of a fixed size matrix by LU-decomposition with partial pivoting.
+        template <std::size_t N>
+        std::complex<double> smallLogdet(const std::complex<double> *const matrix) {
+            blaze::StaticMatrix<std::complex<double>, N, N> lu;
+            for (std::size_t i = 0; i < N; ++i)
+                for (std::size_t j = 0; j < N; ++j)
+                    lu(i, j) = matrix[i*N + j];
+
+            std::complex<double> res = 0;
+            bool negDetP = false;  // if true det(P) == -1, else det(P) == +1
+            for (std::size_t k = 0; k < N; ++k) {
+                std::size_t pivot = k;
+                for (std::size_t i = k+1; i < N; ++i) {
+                    if (std::abs(lu(i, k)) > std::abs(lu(pivot, k)))
+                        pivot = i;
+                }
+                if (lu(pivot, k) == 0.0)
+                    return std::log(std::complex<double>{0.0});  // singular
+                if (pivot != k) {
+                    for (std::size_t j = k; j < N; ++j)
+                        std::swap(lu(k, j), lu(pivot, j));
+                    negDetP = !negDetP;
+                }
+
+                res += std::log(lu(k, k));
+                for (std::size_t i = k+1; i < N; ++i) {
+                    const std::complex<double> factor = lu(i, k) / lu(k, k);
+                    for (std::size_t j = k+1; j < N; ++j)
+                        lu(i, j) -= factor*lu(k, j);
+                }
+            }
+            return toFirstLogBranch(res + (negDetP ? std::complex<double>{0, pi<double>} : 0));
+        }
+
+        /// Propagator elements for sink (x,f) and source (y,i).
+        struct Elements {
+            std::complex<double> pxy, pyx, pxx, pyy;  ///< Particle propagator.
+            std::complex<double> hxy, hyx, hxx, hyy;  ///< Hole propagator.
+            double delta;  ///< delta_{xy} delta_{fi}
+        };
+
+        /// Contract propagator elements into a two-body correlator, see spinSpinCorrelators().
+        std::complex<double> contract(const SSCorrelator correlator, const Elements &e) noexcept {
+            switch (correlator) {
+            case SSCorrelator::NP_NP:
+                return (1.0-e.pxx)*(1.0-e.pyy) + e.pxy*(e.delta-e.pyx);
+            case SSCorrelator::NH_NP:
+                return (1.0-e.hxx)*(1.0-e.pyy);
+            case SSCorrelator::NP_NH:
+                return (1.0-e.pxx)*(1.0-e.hyy);
+            case SSCorrelator::NH_NH:
+                return (1.0-e.hxx)*(1.0-e.hyy) + e.hxy*(e.delta-e.hyx);
+            case SSCorrelator::SPLUS_SMINUS:
+                return e.pxy*e.hxy;
+            case SSCorrelator::SMINUS_SPLUS:
+                return e.delta*(1.0-e.pyx-e.hyx) + e.pyx*e.hyx;
+            case SSCorrelator::PLUSPLUS_MINUSMINUS:
+                return e.hxy*(e.delta-e.pyx);
+            case SSCorrelator::MINUSMINUS_PLUSPLUS:
+                return e.pxy*(e.delta-e.hyx);
+            }
+            return 0;
+        }
+    }
+
+    void singleParticleCorrelator(const std::complex<double> *const propagator,
+                                  const std::size_t nx, const std::size_t nt,
+                                  const SPCorrelator correlator,
+                                  const CDMatrix &transform,
+                                  std::complex<double> *const out) {
+        transformedSize(transform, nx);  // check shape
+
+        // G_{x,t; y,tp}
+        const auto G = [propagator, nx, nt](const std::size_t x, const std::size_t t,
+                                            const std::size_t y, const std::size_t tp) {
+            return propagator[((x*nt + t)*nx + y)*nt + tp];
+        };
+
+        parallelFor(nt, [&](const std::size_t tau) {
+            CDMatrix corr(nx, nx, std::complex<double>{0.0});
+            for (std::size_t t = 0; t < nt; ++t) {
+                // time slice t+tau w/ anti-periodic boundary condition
+                const bool wraps = t+tau >= nt;
+                const std::size_t tt = wraps ? t+tau-nt : t+tau;
+                const double weight = (wraps ? -1.0 : 1.0) / static_cast<double>(nt);
+
+                if (correlator == SPCorrelator::DESTRUCTION_CREATION) {
+                    for (std::size_t x = 0; x < nx; ++x)
+                        for (std::size_t y = 0; y < nx; ++y)
+                            corr(x, y) += weight*G(x, tt, y, t);
+                }
+                else {
+                    for (std::size_t y = 0; y < nx; ++y)
+                        for (std::size_t x = 0; x < nx; ++x)
+                            corr(x, y) -= weight*G(y, t, x, tt);
+                }
+            }
+            // the delta contributes only at equal times
+            if (correlator == SPCorrelator::CREATION_DESTRUCTION && tau == 0)
+                corr += IdMatrix<std::complex<double>>(nx);
+
+            storeTransformed(corr, transform, tau, nt, out);
+        });
+    }
+
+    void spinSpinCorrelators(const std::complex<double> *const particle,
+                             const std::complex<double> *const hole,
+                             const std::size_t nx, const std::size_t nt,
+                             const std::vector<SSCorrelator> &correlators,
+                             const CDMatrix &transform,
+                             const std::vector<std::complex<double> *> &outs) {
+        if (correlators.size() != outs.size())
+            throw std::invalid_argument("Number of correlators and outputs does not match.");
+        transformedSize(transform, nx);  // check shape
+        const std::size_t ncorr = correlators.size();
+
+        const auto idx = [nx, nt](const std::size_t x, const std::size_t t,
+                                  const std::size_t y, const std::size_t tp) {
+            return ((x*nt + t)*nx + y)*nt + tp;
+        };
+
+        // Each tau writes to its own slots of the outputs and loops over all source
+        // times, so threads only need ncorr matrices of size nx^2 each.
+        parallelFor(nt, [&](const std::size_t tau) {
+            std::vector<CDMatrix> acc(ncorr, CDMatrix(nx, nx, std::complex<double>{0.0}));
+            Elements e;
+            for (std::size_t i = 0; i < nt; ++i) {  // source time
+                const std::size_t f = (i+tau) % nt;  // sink time, bosonic => periodic
+                for (std::size_t x = 0; x < nx; ++x) {
+                    e.pxx = particle[idx(x, f, x, f)];
+                    e.hxx = hole[idx(x, f, x, f)];
+                    for (std::size_t y = 0; y < nx; ++y) {
+                        e.pxy = particle[idx(x, f, y, i)];
+                        e.pyx = particle[idx(y, i, x, f)];
+                        e.pyy = particle[idx(y, i, y, i)];
+                        e.hxy = hole[idx(x, f, y, i)];
+                        e.hyx = hole[idx(y, i, x, f)];
+                        e.hyy = hole[idx(y, i, y, i)];
+                        e.delta = (x == y && tau == 0) ? 1.0 : 0.0;
+
+                        for (std::size_t c = 0; c < ncorr; ++c)
+                            acc[c](x, y) += contract(correlators[c], e);
+                    }
+                }
+            }
+
+            // average and transform
+            for (std::size_t c = 0; c < ncorr; ++c) {
+                acc[c] /= static_cast<double>(nt);
+                storeTransformed(acc[c], transform, tau, nt, outs[c]);
+            }
+        });
+    }
+
+    void logdetBatch(const std::complex<double> *const matrices,
+                     const std::size_t n, const std::size_t count, const std::size_t stride,
+                     std::complex<double> *const out) {
+        if (count > 1 && stride < n*n)
+            throw std::invalid_argument("Stride of matrices must be at least n*n.");
+
+        const auto batch = [=](const auto kernel) {
+            parallelFor(count, [=](const std::size_t k) {
+                out[k] = kernel(matrices + k*stride);
+            });
+        };
+
+        switch (n) {
+        case 1: batch(smallLogdet<1>); break;
+        case 2: batch(smallLogdet<2>); break;
+        case 3: batch(smallLogdet<3>); break;
+        case 4: batch(smallLogdet<4>); break;
+        case 5: batch(smallLogdet<5>); break;
+        case 6: batch(smallLogdet<6>); break;
+        case 7: batch(smallLogdet<7>); break;
+        case 8: batch(smallLogdet<8>); break;
+        default:
+            batch([n](const std::complex<double> *const matrix) {
+                CDMatrix mat(n, n);
+                for (std::size_t i = 0; i < n; ++i)
+                    std::copy(matrix + i*n, matrix + (i+1)*n, mat.data(i));
+                return ilogdet(mat);
+            });
+        }
+    }
+}  // namespace isle
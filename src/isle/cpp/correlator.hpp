@@ -0,0 +1,142 @@
+/** \file
+ * \brief Contractions of propagators into time averaged correlation functions.
+ */
+
+#ifndef CORRELATOR_HPP
+#define CORRELATOR_HPP
+
+#include <vector>
+
+#include "math.hpp"
+
+namespace isle {
+
+    /// Select a single particle correlator, see singleParticleCorrelator().
+    enum class SPCorrelator {
+        /// \f$C_{xy}(\tau) = \frac{1}{N_t}\sum_t \langle a^\dagger_{x,t+\tau} a_{y,t}\rangle\f$
+        CREATION_DESTRUCTION,
+        /// \f$C_{xy}(\tau) = \frac{1}{N_t}\sum_t \langle a_{x,t+\tau} a^\dagger_{y,t}\rangle\f$
+        DESTRUCTION_CREATION
+    };
+
+    /// Compute a time averaged single particle correlator from an all-to-all propagator.
+    /**
+     * Computes
+     \f[
+     C_{xy}(\tau) = \frac{1}{N_t} \sum_t \pm G_{x,t+\tau; y,t}
+     \f]
+     * for SPCorrelator::DESTRUCTION_CREATION and
+     \f[
+     C_{xy}(\tau) = \frac{1}{N_t} \sum_t \pm (\delta - G)_{y,t; x,t+\tau}
+     \f]
+     * for SPCorrelator::CREATION_DESTRUCTION.
+     * The sign is negative if \f$t+\tau\f$ wraps around the temporal boundary
+     * (anti-periodic boundary conditions).
+     *
+     * If `transform` is not empty, the result is transformed as
+     * \f$C(\tau) \rightarrow T^\dagger C(\tau) T\f$ for every \f$\tau\f$.
+     *
+     * The different \f$\tau\f$ are processed in parallel.
+     *
+     * \param propagator All-to-all propagator in the layout produced by allToAllPropagator(),
+     *                   i.e. \f$G_{x,t; y,t'}\f$ is element `((x*nt + t)*nx + y)*nt + t'`.
+     * \param nx Number of spatial lattice sites.
+     * \param nt Number of time slices.
+     * \param correlator Select which correlator to compute.
+     * \param transform Transformation matrix T of shape `(nx, m)`, may be empty.
+     * \param out Result \f$C_{xy}(\tau)\f$ is written to `out[(x*m + y)*nt + tau]`
+     *            where `m` is `nx` if transform is empty.
+     *            The memory does not have to be initialized.
+     */
+    void singleParticleCorrelator(const std::complex<double> *propagator,
+                                  std::size_t nx, std::size_t nt,
+                                  SPCorrelator correlator,
+                                  const CDMatrix &transform,
+                                  std::complex<double> *out);
+
+
+    /// Select a two-body correlator, see spinSpinCorrelators().
+    /**
+     * Names follow `meas.SpinSpinCorrelator`, i.e. `SINK_SOURCE` where
+     * \f$n^p = a^\dagger a\f$ and \f$n^h = b^\dagger b\f$ are the number operators,
+     * \f$S^+ = a^\dagger b\f$, \f$S^- = b^\dagger a\f$, and
+     * `PLUSPLUS`/`MINUSMINUS` the bilinears with charge \f$\pm 2\f$.
+     */
+    enum class SSCorrelator {
+        NP_NP,  ///< \f$\langle n^p n^p\rangle\f$
+        NH_NP,  ///< \f$\langle n^h n^p\rangle\f$
+        NP_NH,  ///< \f$\langle n^p n^h\rangle\f$
+        NH_NH,  ///< \f$\langle n^h n^h\rangle\f$
+        SPLUS_SMINUS,  ///< \f$\langle S^+ S^-\rangle\f$
+        SMINUS_SPLUS,  ///< \f$\langle S^- S^+\rangle\f$
+        PLUSPLUS_MINUSMINUS,  ///< Charge +2 at the sink, -2 at the source.
+        MINUSMINUS_PLUSPLUS  ///< Charge -2 at the sink, +2 at the source.
+    };
+
+    /// Compute time averaged Wick-contracted two-body correlators from all-to-all propagators.
+    /**
+     * With particle and hole propagators \f$P, H\f$ and for sink \f$(x,t+\tau)\f$
+     * and source \f$(y,t)\f$, the contractions are
+     *  - `NP_NP`: \f$(1-P_{xx})(1-P_{yy}) + P_{xy}(\delta_{yx}-P_{yx})\f$
+     *  - `NH_NP`: \f$(1-H_{xx})(1-P_{yy})\f$
+     *  - `NP_NH`: \f$(1-P_{xx})(1-H_{yy})\f$
+     *  - `NH_NH`: \f$(1-H_{xx})(1-H_{yy}) + H_{xy}(\delta_{yx}-H_{yx})\f$
+     *  - `SPLUS_SMINUS`: \f$P_{xy}H_{xy}\f$
+     *  - `SMINUS_SPLUS`: \f$\delta_{yx}(1-P_{yx}-H_{yx}) + P_{yx}H_{yx}\f$
+     *  - `PLUSPLUS_MINUSMINUS`: \f$H_{xy}(\delta_{yx}-P_{yx})\f$
+     *  - `MINUSMINUS_PLUSPLUS`: \f$P_{xy}(\delta_{yx}-H_{yx})\f$
+     *
+     * where \f$P_{xy}\f$ is short for \f$P_{x,t+\tau; y,t}\f$, \f$P_{yx}\f$ for
+     * \f$P_{y,t; x,t+\tau}\f$, \f$P_{xx}\f$ for \f$P_{x,t+\tau; x,t+\tau}\f$, etc.
+     * The results are averaged over source times \f$t\f$ with periodic boundary conditions
+     * as the operators are bosonic.
+     * Factors \f$(-\sigma_\kappa)^{x+y}\f$ square away in all of these contractions and
+     * need not be applied.
+     *
+     * The different \f$\tau\f$ are processed in parallel and each of them streams over
+     * all source times, adding every contribution into its output directly.
+     * The four-index contractions are never stored and the only intermediate memory
+     * is one \f$N_x \times N_x\f$ matrix per correlator and thread.
+     * If `transform` is not empty, every result is transformed as
+     * \f$C(\tau) \rightarrow T^\dagger C(\tau) T\f$.
+     *
+     * \param particle Particle propagator, layout as in singleParticleCorrelator().
+     * \param hole Hole propagator, layout as in singleParticleCorrelator().
+     * \param nx Number of spatial lattice sites.
+     * \param nt Number of time slices.
+     * \param correlators Correlators to compute.
+     * \param transform Transformation matrix T of shape `(nx, m)`, may be empty.
+     * \param outs One output per element of `correlators`, layout as in
+     *             singleParticleCorrelator().
+     */
+    void spinSpinCorrelators(const std::complex<double> *particle,
+                             const std::complex<double> *hole,
+                             std::size_t nx, std::size_t nt,
+                             const std::vector<SSCorrelator> &correlators,
+                             const CDMatrix &transform,
+                             const std::vector<std::complex<double> *> &outs);
+
+
+    /// Compute \f$\log\det\f$ of every matrix in a stack of small square matrices.
+    /**
+     * Matrix `k` is stored row-major with contiguous rows of length `n`
+     * starting at `matrices + k*stride`.
+     * For \f$n \le 8\f$, the LU-decomposition is done on fixed size matrices
+     * with fully unrolled loops, larger matrices are handled by ilogdet().
+     * The matrices are distributed over threads.
+     *
+     * \param matrices Pointer to the first element of the first matrix.
+     * \param n Number of rows and columns of each matrix.
+     * \param count Number of matrices.
+     * \param stride Distance in elements between the starts of consecutive matrices,
+     *               must be at least `n*n`.
+     * \param out `out[k]` is set to \f$\log\det\f$ of matrix `k`,
+     *            projected onto the first branch of the logarithm.
+     */
+    void logdetBatch(const std::complex<double> *matrices,
+                     std::size_t n, std::size_t count, std::size_t stride,
+                     std::complex<double> *out);
+
+}  // namespace isle
+
+#endif  // ndef CORRELATOR_HPP
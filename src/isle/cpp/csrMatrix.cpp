@@ -0,0 +1,70 @@
+#include "csrMatrix.hpp"
+
+#include <algorithm>
+
+namespace isle {
+    CSRMatrix::CSRMatrix(const DSparseMatrix &mat)
+        : rows{mat.rows()}, columns{mat.columns()}, rowStart(mat.rows()+1) {
+
+        columnIndices.reserve(mat.nonZeros());
+        values.reserve(mat.nonZeros());
+
+        rowStart[0] = 0;
+        for (std::size_t i = 0; i < mat.rows(); ++i) {
+            for (auto it = mat.begin(i); it != mat.end(i); ++it) {
+                columnIndices.push_back(it->index());
+                values.push_back(it->value());
+            }
+            rowStart[i+1] = values.size();
+        }
+    }
+
+    std::size_t CSRMatrix::nonZeros() const noexcept {
+        return values.size();
+    }
+
+    void multScaledCSR(const CDMatrix &mat, const CDVector &phase,
+                       const CSRMatrix &csr, CDMatrix &res) {
+#ifndef NDEBUG
+        if (mat.columns() != phase.size() || phase.size() != csr.rows)
+            throw std::invalid_argument("Matrix dimensions do not match in multScaledCSR.");
+#endif
+
+        res.resize(mat.rows(), csr.columns, false);
+        for (std::size_t r = 0; r < mat.rows(); ++r) {
+            const std::complex<double> *const in = mat.data(r);
+            std::complex<double> *const out = res.data(r);
+            std::fill(out, out+csr.columns, std::complex<double>{0.0});
+
+            // out = sum_j in[j]*phase[j] * csr[j, :]
+            for (std::size_t j = 0; j < csr.rows; ++j) {
+                const std::complex<double> s = in[j]*phase[j];
+                for (std::size_t k = csr.rowStart[j]; k < csr.rowStart[j+1]; ++k)
+                    out[csr.columnIndices[k]] += s*csr.values[k];
+            }
+        }
+    }
+
+    void multCSRScaled(const CDVector &phase, const CSRMatrix &csr,
+                       const CDMatrix &mat, CDMatrix &res) {
+#ifndef NDEBUG
+        if (phase.size() != csr.rows || csr.columns != mat.rows())
+            throw std::invalid_argument("Matrix dimensions do not match in multCSRScaled.");
+#endif
+
+        const std::size_t ncol = mat.columns();
+        res.resize(csr.rows, ncol, false);
+        for (std::size_t i = 0; i < csr.rows; ++i) {
+            std::complex<double> *const out = res.data(i);
+            std::fill(out, out+ncol, std::complex<double>{0.0});
+
+            // out = phase[i] * sum_k csr[i, k] * mat[k, :], contiguous in mat and out
+            for (std::size_t k = csr.rowStart[i]; k < csr.rowStart[i+1]; ++k) {
+                const std::complex<double> s = phase[i]*csr.values[k];
+                const std::complex<double> *const in = mat.data(csr.columnIndices[k]);
+                for (std::size_t c = 0; c < ncol; ++c)
+                    out[c] += s*in[c];
+            }
+        }
+    }
+}  // namespace isle
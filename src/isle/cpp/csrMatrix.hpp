@@ -0,0 +1,66 @@
+/** \file
+ * \brief Sparse matrix in a fixed CSR layout and fused kernels for products with it.
+ */
+
+#ifndef CSR_MATRIX_HPP
+#define CSR_MATRIX_HPP
+
+#include <vector>
+
+#include "math.hpp"
+
+namespace isle {
+
+    /// Real sparse matrix in compressed sparse row (CSR) format.
+    /**
+     * Unlike blaze::CompressedMatrix, the structure is fixed after construction and
+     * stored in plain contiguous arrays.
+     * This allows for simple kernels which fuse the product with the sparse matrix
+     * with a diagonal scaling, see multScaledCSR() and multCSRScaled().
+     */
+    struct CSRMatrix {
+        std::size_t rows = 0;  ///< Number of rows.
+        std::size_t columns = 0;  ///< Number of columns.
+        /// Index into columnIndices and values of the first element in each row
+        /// plus one past the end, i.e. `rows+1` elements.
+        std::vector<std::size_t> rowStart;
+        std::vector<std::size_t> columnIndices;  ///< Column index of each non-zero element.
+        std::vector<double> values;  ///< Value of each non-zero element.
+
+        /// Construct an empty matrix.
+        CSRMatrix() = default;
+
+        /// Copy structure and values from a blaze sparse matrix.
+        explicit CSRMatrix(const DSparseMatrix &mat);
+
+        /// Number of non-zero elements.
+        std::size_t nonZeros() const noexcept;
+    };
+
+    /// Compute `res = mat * diag(phase) * csr`.
+    /**
+     * Runs in a single pass over `mat` and costs \f$\mathcal{O}(\mathrm{nnz}\cdot n)\f$
+     * where n is the number of rows of `mat`.
+     * \param mat Dense matrix, must not alias `res`.
+     * \param phase Diagonal of the matrix between `mat` and `csr`.
+     * \param csr Sparse matrix.
+     * \param res Result, resized if need be.
+     */
+    void multScaledCSR(const CDMatrix &mat, const CDVector &phase,
+                       const CSRMatrix &csr, CDMatrix &res);
+
+    /// Compute `res = diag(phase) * csr * mat`.
+    /**
+     * Runs in a single pass over `mat` and costs \f$\mathcal{O}(\mathrm{nnz}\cdot n)\f$
+     * where n is the number of columns of `mat`.
+     * \param phase Diagonal of the matrix multiplied from the left.
+     * \param csr Sparse matrix.
+     * \param mat Dense matrix, must not alias `res`.
+     * \param res Result, resized if need be.
+     */
+    void multCSRScaled(const CDVector &phase, const CSRMatrix &csr,
+                       const CDMatrix &mat, CDMatrix &res);
+
+}  // namespace isle
+
+#endif  // ndef CSR_MATRIX_HPP
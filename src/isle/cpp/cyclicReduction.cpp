@@ -0,0 +1,153 @@
+#include "cyclicReduction.hpp"
+
+#include <memory>
+
+#include "parallel.hpp"
+
+namespace isle {
+    namespace {
+        /// Invert a matrix in place and return log(det()) of the original matrix.
+        std::complex<double> invertAndLogdet(CDMatrix &mat) {
+            auto ipiv = std::make_unique<int[]>(mat.rows());
+            blaze::getrf(mat, ipiv.get());
+            const auto ldet = logdetFromLU(mat, ipiv.get());
+            blaze::getri(mat, ipiv.get());
+            return ldet;
+        }
+    }
+
+    CyclicReduction::CyclicReduction(std::vector<CDMatrix> diag,
+                                     std::vector<CDMatrix> lower,
+                                     std::vector<CDMatrix> upper)
+        : _nx{diag.empty() ? 0 : diag[0].rows()}, _nt{diag.size()}, _logdet{0} {
+
+        if (_nt == 0)
+            throw std::invalid_argument("CyclicReduction needs at least one block.");
+        if (lower.size() != _nt || upper.size() != _nt)
+            throw std::invalid_argument("Numbers of blocks on the diagonals of matrix do not match.");
+
+        // reduce until there is only one block left
+        while (diag.size() > 1) {
+            const std::size_t n = diag.size();
+            const std::size_t nelim = n / 2;  // number of odd rows
+            const std::size_t nkeep = n - nelim;  // number of even rows
+
+            Level level;
+            level.n = n;
+            level.dinv.resize(nelim);
+            level.lower.resize(nelim);
+            level.upper.resize(nelim);
+            level.wl.resize(nkeep);
+            level.wr.resize(nkeep);
+
+            // invert diagonal blocks of odd rows
+            std::vector<std::complex<double>> ldets(nelim);
+            parallelFor(nelim, [&](const std::size_t k) {
+                const std::size_t i = 2*k + 1;
+                level.dinv[k] = std::move(diag[i]);
+                ldets[k] = invertAndLogdet(level.dinv[k]);
+                level.lower[k] = std::move(lower[i]);
+                level.upper[k] = std::move(upper[i]);
+            });
+            for (const auto ldet : ldets)
+                _logdet += ldet;
+
+            // Schur complement on even rows
+            std::vector<CDMatrix> newDiag(nkeep), newLower(nkeep), newUpper(nkeep);
+            parallelFor(nkeep, [&](const std::size_t k) {
+                const std::size_t j = 2*k;
+                const std::size_t l = (j + n - 1) % n;  // left neighbour
+                const std::size_t r = (j + 1) % n;  // right neighbour
+
+                newDiag[k] = std::move(diag[j]);
+
+                if (l % 2 == 1) {
+                    level.wl[k] = lower[j] * level.dinv[l/2];
+                    newDiag[k] -= level.wl[k] * level.upper[l/2];
+                    newLower[k] = -level.wl[k] * level.lower[l/2];
+                }
+                else
+                    newLower[k] = std::move(lower[j]);
+
+                if (r % 2 == 1) {
+                    level.wr[k] = upper[j] * level.dinv[r/2];
+                    newDiag[k] -= level.wr[k] * level.lower[r/2];
+                    newUpper[k] = -level.wr[k] * level.upper[r/2];
+                }
+                else
+                    newUpper[k] = std::move(upper[j]);
+            });
+
+            _levels.emplace_back(std::move(level));
+            diag = std::move(newDiag);
+            lower = std::move(newLower);
+            upper = std::move(newUpper);
+        }
+
+        // both neighbours of the last block are the block itself
+        _baseInv = diag[0] + lower[0] + upper[0];
+        _logdet = toFirstLogBranch(_logdet + invertAndLogdet(_baseInv));
+    }
+
+    std::complex<double> CyclicReduction::logdet() const noexcept {
+        return _logdet;
+    }
+
+    CDVector CyclicReduction::solve(const CDVector &rhs) const {
+        if (rhs.size() != _nx*_nt)
+            throw std::invalid_argument("Right hand side does not have correct size (spacetime vector)");
+
+        const std::size_t nx = _nx;
+
+        // reduce right hand side, keep rhs of each level for back substitution
+        std::vector<CDVector> rhss;
+        rhss.reserve(_levels.size()+1);
+        rhss.emplace_back(rhs);
+        for (const auto &level : _levels) {
+            const CDVector &b = rhss.back();
+            const std::size_t n = level.n;
+            CDVector reduced(level.wl.size()*nx);
+            parallelFor(level.wl.size(), [&](const std::size_t k) {
+                const std::size_t j = 2*k;
+                spacevec(reduced, k, nx) = spacevec(b, j, nx);
+                if (level.wl[k].rows() != 0)
+                    spacevec(reduced, k, nx) -= level.wl[k] * spacevec(b, (j+n-1)%n, nx);
+                if (level.wr[k].rows() != 0)
+                    spacevec(reduced, k, nx) -= level.wr[k] * spacevec(b, (j+1)%n, nx);
+            });
+            rhss.emplace_back(std::move(reduced));
+        }
+
+        // solve final system
+        CDVector x = _baseInv * rhss.back();
+
+        // back substitution, level by level
+        for (std::size_t lvl = _levels.size(); lvl != 0; --lvl) {
+            const Level &level = _levels[lvl-1];
+            const CDVector &b = rhss[lvl-1];
+            const std::size_t n = level.n;
+
+            CDVector full(n*nx);
+            for (std::size_t k = 0; k < level.wl.size(); ++k)
+                spacevec(full, 2*k, nx) = spacevec(x, k, nx);
+            // neighbours of odd rows are even and have been set above
+            parallelFor(level.dinv.size(), [&](const std::size_t k) {
+                const std::size_t i = 2*k + 1;
+                spacevec(full, i, nx) = level.dinv[k] * (spacevec(b, i, nx)
+                                                         - level.lower[k]*spacevec(full, i-1, nx)
+                                                         - level.upper[k]*spacevec(full, (i+1)%n, nx));
+            });
+            x = std::move(full);
+        }
+
+        return x;
+    }
+
+    std::size_t CyclicReduction::nt() const noexcept {
+        return _nt;
+    }
+
+    std::size_t CyclicReduction::nx() const noexcept {
+        return _nx;
+    }
+}  // namespace isle
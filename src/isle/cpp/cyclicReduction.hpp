@@ -0,0 +1,94 @@
+/** \file
+ * \brief Block cyclic reduction of periodic block tridiagonal matrices.
+ */
+
+#ifndef CYCLIC_REDUCTION_HPP
+#define CYCLIC_REDUCTION_HPP
+
+#include <vector>
+
+#include "math.hpp"
+
+namespace isle {
+
+    /// Select an algorithm to factorise matrix Q of a %HubbardFermiMatrix.
+    enum class QFactorization {
+        LU,  ///< Sequential LU-decomposition over time slices, see getQLU().
+        CYCLIC_REDUCTION  ///< Block cyclic reduction, see CyclicReduction.
+    };
+
+    /// Factorisation of a periodic block tridiagonal matrix by block cyclic reduction.
+    /**
+     * Handles matrices of the form
+     \f[
+     Q = \begin{pmatrix}
+     D_0     & C_0    &        &         & A_0    \\
+     A_1     & D_1    & C_1    &         &        \\
+             & \ddots & \ddots & \ddots  &        \\
+             &        & A_{n-2}& D_{n-2} & C_{n-2}\\
+     C_{n-1} &        &        & A_{n-1} & D_{n-1}
+     \end{pmatrix}
+     \f]
+     * with \f$n\f$ blocks of size \f$N_x \times N_x\f$ in each dimension.
+     * For \f$n \le 2\f$, the off-diagonal blocks that end up in the same position are added up.
+     *
+     * Each level of the reduction eliminates all odd rows.
+     * The remaining even rows form a new periodic block tridiagonal system of half the size.
+     * This is repeated until only a single block is left.
+     * All blocks of one level are independent of each other and are processed in parallel,
+     * so the factorisation has a depth of \f$\mathcal{O}(\log n)\f$ instead of
+     * \f$\mathcal{O}(n)\f$ for the sequential LU-decomposition.
+     * The total amount of work is about twice that of the sequential algorithm.
+     */
+    class CyclicReduction {
+    public:
+        /// Factorise a matrix given by its blocks.
+        /**
+         * \param diag Blocks on the diagonal \f$D_i\f$.
+         * \param lower Blocks on the lower subdiagonal \f$A_i\f$ (row i, column i-1).
+         * \param upper Blocks on the upper subdiagonal \f$C_i\f$ (row i, column i+1).
+         * \throws std::invalid_argument if the number of blocks does not match.
+         */
+        CyclicReduction(std::vector<CDMatrix> diag,
+                        std::vector<CDMatrix> lower,
+                        std::vector<CDMatrix> upper);
+
+        /// Return \f$\log(\det(Q))\f$ projected onto the first branch of the logarithm.
+        std::complex<double> logdet() const noexcept;
+
+        /// Solve \f$Q x = b\f$.
+        /**
+         * \param rhs Right hand side b.
+         * \return Solution x.
+         */
+        CDVector solve(const CDVector &rhs) const;
+
+        /// Number of blocks in each dimension of the original matrix.
+        std::size_t nt() const noexcept;
+
+        /// Size of each block.
+        std::size_t nx() const noexcept;
+
+    private:
+        /// Data of one level of the reduction.
+        struct Level {
+            std::size_t n;  ///< Number of block rows in this level.
+            std::vector<CDMatrix> dinv;  ///< \f$D_i^{-1}\f$ of eliminated rows (index i/2).
+            std::vector<CDMatrix> lower;  ///< \f$A_i\f$ of eliminated rows (index i/2).
+            std::vector<CDMatrix> upper;  ///< \f$C_i\f$ of eliminated rows (index i/2).
+            /// \f$A_j D_{j-1}^{-1}\f$ of kept rows (index j/2), empty if row j-1 is kept.
+            std::vector<CDMatrix> wl;
+            /// \f$C_j D_{j+1}^{-1}\f$ of kept rows (index j/2), empty if row j+1 is kept.
+            std::vector<CDMatrix> wr;
+        };
+
+        std::size_t _nx;  ///< Size of the blocks.
+        std::size_t _nt;  ///< Number of blocks.
+        std::vector<Level> _levels;  ///< All levels, starting with the original matrix.
+        CDMatrix _baseInv;  ///< Inverse of the final 1x1 block system.
+        std::complex<double> _logdet;  ///< log(det(Q)).
+    };
+
+}  // namespace isle
+
+#endif  // ndef CYCLIC_REDUCTION_HPP
@@ -0,0 +1,195 @@
+#include "evenOddPreconditioner.hpp"
+
+using namespace std::complex_literals;
+
+namespace isle {
+    namespace {
+        /// Throw if nt cannot be halved levels times.
+        std::size_t checkedLevels(const std::size_t nt, const std::size_t levels) {
+            if (levels >= 8*sizeof(std::size_t) || nt % (std::size_t{1} << levels) != 0)
+                throw std::invalid_argument("Number of time slices must be divisible by 2^levels"
+                                            " in EvenOddPreconditioner.");
+            return levels;
+        }
+    }
+
+    EvenOddPreconditioner::EvenOddPreconditioner(const HubbardFermiMatrixDia &hfm,
+                                                 const CDVector &phi,
+                                                 const Species species,
+                                                 const std::size_t levels)
+        : _nx{hfm.nx()}, _nt{getNt(phi, hfm.nx())},
+          _levels{checkedLevels(_nt, levels)},
+          _hopping(hfm.Kinv(species)), _phases(_nt, _nx),
+          _invertDiagonal{true}
+    {
+        for (std::size_t t = 0; t < _nt; ++t)
+            blaze::row(_phases, t) = blaze::trans(hfm.phaseF(t, phi, species, false));
+    }
+
+    EvenOddPreconditioner::EvenOddPreconditioner(const HubbardFermiMatrixExp &hfm,
+                                                 const CDVector &phi,
+                                                 const Species species,
+                                                 const std::size_t levels)
+        : _nx{hfm.nx()}, _nt{getNt(phi, hfm.nx())},
+          _levels{checkedLevels(_nt, levels)},
+          _hopping(hfm.expKappa(species, false)), _phases(_nt, _nx),
+          _invertDiagonal{false}
+    {
+        // the sign in the exponential of phi, see HubbardFermiMatrixExp::F()
+        const auto phaseSign = species == Species::PARTICLE ? +1.0i : -1.0i;
+        for (std::size_t t = 0; t < _nt; ++t) {
+            const std::size_t tm1 = t == 0 ? _nt-1 : t-1;
+            blaze::row(_phases, t) = blaze::trans(blaze::exp(phaseSign*spacevec(phi, tm1, _nx)));
+        }
+    }
+
+    CDVector EvenOddPreconditioner::_chain(const std::size_t t, const std::size_t n,
+                                           CDVector v) const {
+        // apply L_{t-n+1} first
+        for (std::size_t i = n; i > 0; --i) {
+            const std::size_t tp = (t + _nt - (i-1)) % _nt;
+            v = _hopping * (blaze::trans(blaze::row(_phases, tp)) * v);
+        }
+        return v;
+    }
+
+    CDVector EvenOddPreconditioner::_chainAdjoint(const std::size_t t, const std::size_t n,
+                                                  CDVector v) const {
+        // apply L_t^dagger first
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t tp = (t + _nt - i) % _nt;
+            v = blaze::conj(blaze::trans(blaze::row(_phases, tp))) * (blaze::ctrans(_hopping) * v);
+        }
+        return v;
+    }
+
+    CDVector EvenOddPreconditioner::_reduceLevels(const CDVector &rhs,
+                                                  const std::size_t levels) const {
+        if (rhs.size() != _nx*_nt)
+            throw std::invalid_argument("Right hand side of EvenOddPreconditioner does not have size nx*nt.");
+
+        CDVector r(_nx*_nt);
+        for (std::size_t t = 0; t < _nt; ++t) {
+            if (_invertDiagonal)
+                spacevec(r, t, _nx) = _hopping*spacevec(rhs, t, _nx);
+            else
+                spacevec(r, t, _nx) = spacevec(rhs, t, _nx);
+        }
+
+        for (std::size_t level = 0; level < levels; ++level) {
+            const std::size_t step = std::size_t{1} << level;
+            for (std::size_t t = 0; t < _nt; t += 2*step) {
+                // r_t += s_t L_t ... L_{t-step+1} r_{t-step}
+                const double sign = t == 0 ? -1.0 : 1.0;
+                spacevec(r, t, _nx) += sign*_chain(t, step, spacevec(r, (t+_nt-step) % _nt, _nx));
+            }
+        }
+        return r;
+    }
+
+    CDVector EvenOddPreconditioner::reduce(const CDVector &rhs) const {
+        const CDVector r = _reduceLevels(rhs, _levels);
+        const std::size_t step = std::size_t{1} << _levels;
+        CDVector reduced(_nx*ntReduced());
+        for (std::size_t i = 0; i < ntReduced(); ++i)
+            spacevec(reduced, i, _nx) = spacevec(r, i*step, _nx);
+        return reduced;
+    }
+
+    void EvenOddPreconditioner::apply(const CDVector &in, CDVector &out,
+                                      const bool dagger) const {
+        const std::size_t NT = ntReduced();
+        if (in.size() != _nx*NT)
+            throw std::invalid_argument("Input vector of EvenOddPreconditioner::apply does not have size nx*ntReduced.");
+        out.resize(_nx*NT, false);
+
+        const std::size_t step = std::size_t{1} << _levels;
+        for (std::size_t i = 0; i < NT; ++i) {
+            if (!dagger) {
+                // out_i = in_i - s_t L_t ... L_{t-step+1} in_{i-1}
+                const std::size_t im1 = i == 0 ? NT-1 : i-1;
+                const double sign = i == 0 ? -1.0 : 1.0;
+                spacevec(out, i, _nx) = spacevec(in, i, _nx)
+                    - sign*_chain(i*step, step, spacevec(in, im1, _nx));
+            }
+            else {
+                // out_i = in_i - s_t (L_t ... L_{t-step+1})^dagger in_{i+1} with t = (i+1)*step
+                const std::size_t ip1 = i == NT-1 ? 0 : i+1;
+                const double sign = i == NT-1 ? -1.0 : 1.0;
+                spacevec(out, i, _nx) = spacevec(in, i, _nx)
+                    - sign*_chainAdjoint(ip1*step, step, spacevec(in, ip1, _nx));
+            }
+        }
+    }
+
+    CDVector EvenOddPreconditioner::reconstruct(const CDVector &reduced,
+                                                const CDVector &rhs) const {
+        if (reduced.size() != _nx*ntReduced())
+            throw std::invalid_argument("Reduced solution of EvenOddPreconditioner does not have size nx*ntReduced.");
+
+        // the last level only touches the remaining slices which are known already
+        const CDVector r = _reduceLevels(rhs, _levels == 0 ? 0 : _levels-1);
+
+        CDVector x(_nx*_nt);
+        const std::size_t fullStep = std::size_t{1} << _levels;
+        for (std::size_t i = 0; i < ntReduced(); ++i)
+            spacevec(x, i*fullStep, _nx) = spacevec(reduced, i, _nx);
+
+        // forward substitution on eliminated slices, level by level
+        for (std::size_t level = _levels; level > 0; --level) {
+            const std::size_t step = std::size_t{1} << (level-1);
+            for (std::size_t t = step; t < _nt; t += 2*step) {
+                // x_t = r_t + L_t ... L_{t-step+1} x_{t-step}, never t=0
+                spacevec(x, t, _nx) = spacevec(r, t, _nx)
+                    + _chain(t, step, spacevec(x, t-step, _nx));
+            }
+        }
+        return x;
+    }
+
+    SolverInfo EvenOddPreconditioner::solve(const CDVector &rhs, CDVector &x,
+                                            const double tolerance,
+                                            const std::size_t maxIterations) const {
+        // solve S^dagger S y = S^dagger b'
+        CDVector aux;
+        const CDVector reduced = reduce(rhs);
+        CDVector sdagb;
+        apply(reduced, sdagb, true);
+
+        const LinearOperator sdags = [this, &aux](const CDVector &in, CDVector &out) {
+            apply(in, aux, false);
+            apply(aux, out, true);
+        };
+        const SolverInfo info = conjugateGradient(sdags, sdagb, x, tolerance, maxIterations);
+        x = reconstruct(x, rhs);
+        return info;
+    }
+
+    CDMatrix EvenOddPreconditioner::solve(const CDMatrix &rhss, const double tolerance,
+                                          const std::size_t maxIterations) const {
+        CDMatrix res(rhss.rows(), rhss.columns());
+        CDVector x;
+        for (std::size_t i = 0; i < rhss.rows(); ++i) {
+            x.resize(0);
+            solve(CDVector(blaze::trans(blaze::row(rhss, i))), x, tolerance, maxIterations);
+            blaze::row(res, i) = blaze::trans(x);
+        }
+        return res;
+    }
+
+    std::size_t EvenOddPreconditioner::nx() const noexcept {
+        return _nx;
+    }
+
+    std::size_t EvenOddPreconditioner::nt() const noexcept {
+        return _nt;
+    }
+
+    std::size_t EvenOddPreconditioner::ntReduced() const noexcept {
+        return _nt >> _levels;
+    }
+
+    std::size_t EvenOddPreconditioner::levels() const noexcept {
+        return _levels;
+    }
+}  // namespace isle
@@ -0,0 +1,151 @@
+/** \file
+ * \brief Even-odd reduction of time slices for iterative solves of M.
+ */
+
+#ifndef EVEN_ODD_PRECONDITIONER_HPP
+#define EVEN_ODD_PRECONDITIONER_HPP
+
+#include "math.hpp"
+#include "krylov.hpp"
+#include "hubbardFermiMatrixDia.hpp"
+#include "hubbardFermiMatrixExp.hpp"
+
+namespace isle {
+    /// Schur complement of the fermion matrix M on every other time slice.
+    /**
+     * Multiplying M by the inverse of its diagonal blocks (\f$K^{-1}\f$ for
+     * HubbardFermiMatrixDia, nothing for HubbardFermiMatrixExp) gives
+     \f[
+     (M' x)_t = x_t - s_t L_t x_{t-1},
+     \f]
+     * with \f$s_0 = -1\f$ from the anti-periodic boundary, \f$s_t = 1\f$ otherwise,
+     * and \f$L_t = K^{-1} F_t\f$ or \f$L_t = F_t\f$, respectively.
+     * The equations for odd slices can be solved for \f$x_t\f$ in terms of
+     * \f$x_{t-1}\f$ and inserting them into the equations for even slices leaves
+     \f[
+     (S x)_t = x_t - s_t L_t L_{t-1} x_{t-2}, \quad t \text{ even},
+     \f]
+     * which has the same form as \f$M'\f$ but only half as many time slices.
+     * This is repeated for `levels` levels, each level halving the number of slices again.
+     * The solution on the eliminated slices is reconstructed from the reduced
+     * solution by forward substitution.
+     *
+     * S is never constructed, applying it costs about as much as applying M.
+     * But the vectors only have \f$N_t / 2^\mathrm{levels}\f$ time slices and
+     * the spectrum of S is better suited for Krylov solvers, see
+     * `benchmarks/evenOdd.py`.
+     * Do not use too many levels, at most a handful,
+     * the products of many \f$L_t\f$ are badly conditioned.
+     * `levels=0` only applies the inverse of the diagonal blocks.
+     *
+     * The solution of \f$M x = b\f$ proceeds in three steps:
+     *  1. Compute the reduced right hand side via reduce().
+     *  2. Solve \f$S y = \mathrm{reduce}(b)\f$ using e.g. conjugateGradient() on
+     *     \f$S^\dagger S\f$ and apply() to access S.
+     *  3. Get the full solution via reconstruct().
+     *
+     * solve() does all three using conjugateGradient().
+     */
+    class EvenOddPreconditioner {
+    public:
+        /// Set up the Schur complement of M.
+        /**
+         * \param hfm Represents matrix M.
+         * \param phi Gauge configuration needed to construct M.
+         * \param species Select whether to use particles or holes.
+         * \param levels Number of times the number of time slices is halved.
+         * \throws std::invalid_argument if the number of time slices is not
+         *         divisible by \f$2^\mathrm{levels}\f$.
+         */
+        EvenOddPreconditioner(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                              Species species, std::size_t levels=1);
+
+        /// Set up the Schur complement of M.
+        /**
+         * \see EvenOddPreconditioner(const HubbardFermiMatrixDia&, const CDVector&, Species, std::size_t)
+         */
+        EvenOddPreconditioner(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                              Species species, std::size_t levels=1);
+
+        /// Compute the right hand side of the reduced system.
+        /**
+         * \param rhs Right hand side b of \f$M x = b\f$ on all time slices.
+         * \returns Right hand side of \f$S y = b'\f$ on the remaining time slices.
+         * \throws std::invalid_argument if `rhs` does not have size nx*nt.
+         */
+        CDVector reduce(const CDVector &rhs) const;
+
+        /// Apply the Schur complement \f$S\f$ or \f$S^\dagger\f$ to a vector.
+        /**
+         * \param in Vector on the remaining time slices.
+         * \param out Set to \f$S \cdot \mathrm{in}\f$ or \f$S^\dagger \cdot \mathrm{in}\f$.
+         *            Must not be the same object as `in`.
+         * \param dagger If `true`, apply \f$S^\dagger\f$ instead of \f$S\f$.
+         * \throws std::invalid_argument if `in` does not match the size of S.
+         */
+        void apply(const CDVector &in, CDVector &out, bool dagger=false) const;
+
+        /// Reconstruct the solution of \f$M x = b\f$ on all time slices.
+        /**
+         * \param reduced Solution y of the reduced system \f$S y = \mathrm{reduce}(b)\f$.
+         * \param rhs Right hand side b of \f$M x = b\f$, the same as passed to reduce().
+         * \returns Solution x on all time slices.
+         */
+        CDVector reconstruct(const CDVector &reduced, const CDVector &rhs) const;
+
+        /// Solve \f$M x = b\f$ using conjugateGradient() on \f$S^\dagger S\f$.
+        /**
+         * \param rhs Right hand side b.
+         * \param x Initial guess for the reduced solution on input, full solution on output.
+         *          If `x` does not have the size of the reduced system, start from zero.
+         * \param tolerance Tolerance for the relative residual of the reduced normal equations.
+         * \param maxIterations Maximum number of iterations.
+         * \returns Number of iterations and final relative residual.
+         * \throws std::runtime_error if the solver does not converge within `maxIterations`.
+         */
+        SolverInfo solve(const CDVector &rhs, CDVector &x,
+                         double tolerance, std::size_t maxIterations) const;
+
+        /// Solve \f$M x = b\f$ for multiple right hand sides.
+        /**
+         * Uses the same layout as solveM(), i.e. right hand side i is `rhss(i, t*nx+x)`.
+         * \see solve(const CDVector&, CDVector&, double, std::size_t) const
+         */
+        CDMatrix solve(const CDMatrix &rhss, double tolerance, std::size_t maxIterations) const;
+
+        /// Return the number of spatial lattice sites.
+        std::size_t nx() const noexcept;
+
+        /// Return the number of time slices of M.
+        std::size_t nt() const noexcept;
+
+        /// Return the number of time slices of the reduced system.
+        std::size_t ntReduced() const noexcept;
+
+        /// Return the number of levels of the reduction.
+        std::size_t levels() const noexcept;
+
+    private:
+        /// Perform the first `levels` levels of the reduction of the right hand side.
+        /**
+         * Slices eliminated at some level are not touched by later levels,
+         * so the result holds the right hand sides of all levels at once.
+         */
+        CDVector _reduceLevels(const CDVector &rhs, std::size_t levels) const;
+
+        /// Compute \f$L_t L_{t-1} \cdots L_{t-n+1} v\f$.
+        CDVector _chain(std::size_t t, std::size_t n, CDVector v) const;
+
+        /// Compute \f$(L_t L_{t-1} \cdots L_{t-n+1})^\dagger v\f$.
+        CDVector _chainAdjoint(std::size_t t, std::size_t n, CDVector v) const;
+
+        std::size_t _nx;  ///< Number of spatial lattice sites.
+        std::size_t _nt;  ///< Number of time slices of M.
+        std::size_t _levels;  ///< Number of levels of the reduction.
+        CDMatrix _hopping;  ///< \f$K^{-1}\f$ or \f$e^{\tilde{\kappa}}\f$.
+        CDMatrix _phases;  ///< Row t holds the phases of \f$L_t\f$.
+        bool _invertDiagonal;  ///< If `true`, the diagonal blocks of M are the inverse of _hopping.
+    };
+}  // namespace isle
+
+#endif  // ndef EVEN_ODD_PRECONDITIONER_HPP
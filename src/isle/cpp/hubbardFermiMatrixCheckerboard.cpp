@@ -0,0 +1,535 @@
+#include "hubbardFermiMatrixCheckerboard.hpp"
+
+#include <cmath>
+
+#include "parallel.hpp"
+#include "stabilizedProduct.hpp"
+#include "logging/logging.hpp"
+
+using namespace std::complex_literals;
+
+namespace isle {
+    namespace {
+        /// Multiply x and y by [[cosh, s*sinh], [s*sinh, cosh]].
+        template <typename T>
+        void rotate(T &x, T &y, const double cosh, const double sinh) noexcept {
+            const T aux = x;
+            x = cosh*x + sinh*y;
+            y = sinh*aux + cosh*y;
+        }
+    }
+
+/*
+ * -------------------------- HubbardFermiMatrixCheckerboard --------------------------
+ */
+
+    HubbardFermiMatrixCheckerboard::HubbardFermiMatrixCheckerboard(
+        const DSparseMatrix &kappaTilde,
+        const double muTilde,
+        const std::int8_t sigmaKappa)
+        : _kappa{kappaTilde}, _mu{muTilde}, _sigmaKappa{sigmaKappa}
+    {
+        if (kappaTilde.rows() != kappaTilde.columns())
+            throw std::invalid_argument("Hopping matrix is not square.");
+        if (sigmaKappa != +1 && sigmaKappa != -1)
+            getLogger("HubbardFermiMatrixCheckerboard").warning("sigmaKappa should be either -1 or +1.");
+        if (sigmaKappa == +1 && !isBipartite(kappaTilde))
+            getLogger("HubbardFermiMatrixCheckerboard").warning("sigmaKappa should be -1 because the lattice is not bipartite.");
+        _setup();
+    }
+
+    HubbardFermiMatrixCheckerboard::HubbardFermiMatrixCheckerboard(
+        const Lattice &lat,
+        const double beta,
+        const double muTilde,
+        const std::int8_t sigmaKappa)
+        : HubbardFermiMatrixCheckerboard{lat.hopping()*beta/lat.nt(), muTilde, sigmaKappa} { }
+
+    void HubbardFermiMatrixCheckerboard::_setup() {
+        const std::size_t NX = nx();
+        // const access, non-const element access would insert zeros into _kappa
+        const DSparseMatrix &kappa = _kappa;
+
+        // greedy colouring, put each bond into the first class where both sites are free
+        _bondClasses.clear();
+        std::vector<std::vector<bool>> occupied;
+        for (std::size_t x = 0; x < NX; ++x) {
+            for (auto it = kappa.cbegin(x); it != kappa.cend(x); ++it) {
+                const std::size_t y = it->index();
+                if (y <= x)
+                    continue;  // each bond only once, diagonal is handled below
+                if (kappa(y, x) != it->value())
+                    throw std::invalid_argument("Hopping matrix is not symmetric.");
+
+                std::size_t c = 0;
+                while (c < occupied.size() && (occupied[c][x] || occupied[c][y]))
+                    ++c;
+                if (c == occupied.size()) {
+                    occupied.emplace_back(NX, false);
+                    _bondClasses.emplace_back();
+                }
+                occupied[c][x] = occupied[c][y] = true;
+                _bondClasses[c].push_back(Bond{x, y,
+                                               std::cosh(it->value()/2),
+                                               std::sinh(it->value()/2)});
+            }
+        }
+
+        for (const Species species : {Species::PARTICLE, Species::HOLE}) {
+            for (const bool inv : {false, true}) {
+                const double muSign = (species == Species::PARTICLE) == inv ? +1.0 : -1.0;
+                const double kappaSign = _hoppingSign(species, inv);
+                DVector diag(NX);
+                for (std::size_t x = 0; x < NX; ++x)
+                    diag[x] = std::exp(kappaSign*kappa(x, x) + muSign*_mu);
+                _diagonal[(species == Species::PARTICLE ? 0 : 2) + (inv ? 1 : 0)] = std::move(diag);
+            }
+        }
+    }
+
+    double HubbardFermiMatrixCheckerboard::_hoppingSign(const Species species,
+                                                        const bool inv) const noexcept {
+        const double sign = species == Species::PARTICLE ? 1.0 : static_cast<double>(_sigmaKappa);
+        return inv ? -sign : sign;
+    }
+
+    const DVector &HubbardFermiMatrixCheckerboard::_diagonalFactor(const Species species,
+                                                                   const bool inv) const {
+        return _diagonal[(species == Species::PARTICLE ? 0 : 2) + (inv ? 1 : 0)];
+    }
+
+    void HubbardFermiMatrixCheckerboard::applyExpKappa(CDVector &vec, const Species species,
+                                                       const bool inv) const {
+#ifndef NDEBUG
+        if (vec.size() != nx())
+            throw std::invalid_argument("Vector in applyExpKappa does not have size nx.");
+#endif
+        const double sign = _hoppingSign(species, inv);
+
+        // the product is a palindrome, so the order is the same for left and right
+        for (const auto &bonds : _bondClasses)
+            for (const Bond &bond : bonds)
+                rotate(vec[bond.x], vec[bond.y], bond.cosh, sign*bond.sinh);
+        vec *= _diagonalFactor(species, inv);
+        for (auto c = _bondClasses.rbegin(); c != _bondClasses.rend(); ++c)
+            for (const Bond &bond : *c)
+                rotate(vec[bond.x], vec[bond.y], bond.cosh, sign*bond.sinh);
+    }
+
+    void HubbardFermiMatrixCheckerboard::applyExpKappa(CDMatrix &mat, const Species species,
+                                                       const bool inv, const Side side) const {
+        const std::size_t NX = nx();
+        const double sign = _hoppingSign(species, inv);
+
+        if (side == Side::LEFT) {
+#ifndef NDEBUG
+            if (mat.rows() != NX)
+                throw std::invalid_argument("Matrix in applyExpKappa does not have nx rows.");
+#endif
+            // rotate pairs of rows, inner loop runs along the rows to match row-major storage
+            const auto rotateRows = [&](const std::vector<Bond> &bonds) {
+                for (const Bond &bond : bonds)
+                    for (std::size_t j = 0; j < mat.columns(); ++j)
+                        rotate(mat(bond.x, j), mat(bond.y, j), bond.cosh, sign*bond.sinh);
+            };
+            for (const auto &bonds : _bondClasses)
+                rotateRows(bonds);
+            scaleRows(mat, _diagonalFactor(species, inv));
+            for (auto c = _bondClasses.rbegin(); c != _bondClasses.rend(); ++c)
+                rotateRows(*c);
+        }
+        else {
+#ifndef NDEBUG
+            if (mat.columns() != NX)
+                throw std::invalid_argument("Matrix in applyExpKappa does not have nx columns.");
+#endif
+            // the product is symmetric, so mat*E applies E to every row
+            CDVector row;
+            for (std::size_t i = 0; i < mat.rows(); ++i) {
+                row = blaze::trans(blaze::row(mat, i));
+                applyExpKappa(row, species, inv);
+                blaze::row(mat, i) = blaze::trans(row);
+            }
+        }
+    }
+
+    DMatrix HubbardFermiMatrixCheckerboard::expKappa(const Species species, const bool inv) const {
+        CDMatrix aux = IdMatrix<std::complex<double>>(nx());
+        applyExpKappa(aux, species, inv, Side::LEFT);
+        return blaze::real(aux);
+    }
+
+    std::complex<double> HubbardFermiMatrixCheckerboard::logdetExpKappa(const Species species,
+                                                                        const bool inv) const {
+        // the bond factors all have determinant cosh^2 - sinh^2 = 1
+        return blaze::sum(blaze::log(_diagonalFactor(species, inv)));
+    }
+
+    void HubbardFermiMatrixCheckerboard::K(DSparseMatrix &k, const Species UNUSED(species)) const {
+        k = IdMatrix<double>(nx());
+    }
+
+    IdMatrix<double> HubbardFermiMatrixCheckerboard::K(const Species UNUSED(species)) const {
+        return IdMatrix<double>(nx());
+    }
+
+    DMatrix HubbardFermiMatrixCheckerboard::Kinv(const Species UNUSED(species)) const {
+        return IdMatrix<double>(nx());
+    }
+
+    std::complex<double> HubbardFermiMatrixCheckerboard::logdetKinv(Species UNUSED(species)) const {
+        return 0;
+    }
+
+    void HubbardFermiMatrixCheckerboard::F(CDMatrix &f,
+                                           const std::size_t tp, const CDVector &phi,
+                                           const Species species, const bool inv) const {
+        const std::size_t NX = nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t tm1 = tp==0 ? NT-1 : tp-1;  // t' - 1
+
+        // the sign in the exponential of phi, see HubbardFermiMatrixExp::F()
+        auto const sign = ((species == Species::PARTICLE && !inv)
+                           || (species == Species::HOLE && inv))
+            ? +1.0i
+            : -1.0i;
+
+        f.resize(NX, NX, false);
+        blaze::reset(f);
+        blaze::diagonal(f) = blaze::exp(sign*spacevec(phi, tm1, NX));
+
+        if (inv)
+            // f = e^phi * e^kappa  (up to signs in exponents)
+            applyExpKappa(f, species, inv, Side::RIGHT);
+        else
+            // f = e^kappa * e^phi  (up to signs in exponents)
+            applyExpKappa(f, species, inv, Side::LEFT);
+    }
+
+    CDMatrix HubbardFermiMatrixCheckerboard::F(const std::size_t tp, const CDVector &phi,
+                                               const Species species, const bool inv) const {
+        CDMatrix f;
+        F(f, tp, phi, species, inv);
+        return f;
+    }
+
+    void HubbardFermiMatrixCheckerboard::applyF(CDMatrix &mat,
+                                                const std::size_t tp, const CDVector &phi,
+                                                const Species species, const bool inv,
+                                                const Side side) const {
+        const std::size_t NX = nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t tm1 = tp==0 ? NT-1 : tp-1;  // t' - 1
+#ifndef NDEBUG
+        if (mat.rows() != NX || mat.columns() != NX)
+            throw std::invalid_argument("Matrix in applyF does not have size nx x nx.");
+#endif
+
+        // the sign in the exponential of phi, see F()
+        auto const sign = ((species == Species::PARTICLE && !inv)
+                           || (species == Species::HOLE && inv))
+            ? +1.0i
+            : -1.0i;
+        const CDVector phase = blaze::exp(sign*spacevec(phi, tm1, NX));
+
+        if (inv) {
+            // F^{-1} = e^phi * e^kappa  (up to signs in exponents)
+            if (side == Side::LEFT) {
+                applyExpKappa(mat, species, inv, Side::LEFT);
+                scaleRows(mat, phase);
+            }
+            else {
+                scaleColumns(mat, phase);
+                applyExpKappa(mat, species, inv, Side::RIGHT);
+            }
+        }
+        else {
+            // F = e^kappa * e^phi  (up to signs in exponents)
+            if (side == Side::LEFT) {
+                scaleRows(mat, phase);
+                applyExpKappa(mat, species, inv, Side::LEFT);
+            }
+            else {
+                applyExpKappa(mat, species, inv, Side::RIGHT);
+                scaleColumns(mat, phase);
+            }
+        }
+    }
+
+    void HubbardFermiMatrixCheckerboard::M(CDSparseMatrix &m,
+                                           const CDVector &phi,
+                                           const Species species) const {
+        const std::size_t NX = nx();
+        const std::size_t NT = getNt(phi, NX);
+        m = IdMatrix<double>(NX*NT);
+
+        // zeroth row w/ explicit boundary condition
+        auto f = F(0, phi, species);
+        spacemat(m, 0, NT-1, NX) = f;
+
+        // other rows
+        for (std::size_t tp = 1; tp < NT; ++tp) {
+            F(f, tp, phi, species);
+            spacemat(m, tp, tp-1, NX) = -f;
+        }
+    }
+
+    CDSparseMatrix HubbardFermiMatrixCheckerboard::M(const CDVector &phi,
+                                                     const Species species) const {
+        CDSparseMatrix m;
+        M(m, phi, species);
+        return m;
+    }
+
+    void HubbardFermiMatrixCheckerboard::updateKappaTilde(const SparseMatrix<double> &kappaTilde) {
+        _kappa = kappaTilde;
+        _setup();
+    }
+
+    void HubbardFermiMatrixCheckerboard::updateMuTilde(const double muTilde) {
+        _mu = muTilde;
+        _setup();
+    }
+
+    const SparseMatrix<double> &HubbardFermiMatrixCheckerboard::kappaTilde() const noexcept {
+        return _kappa;
+    }
+
+    double HubbardFermiMatrixCheckerboard::muTilde() const noexcept {
+        return _mu;
+    }
+
+    std::int8_t HubbardFermiMatrixCheckerboard::sigmaKappa() const noexcept {
+        return _sigmaKappa;
+    }
+
+    std::size_t HubbardFermiMatrixCheckerboard::nx() const noexcept {
+        return _kappa.rows();
+    }
+
+    std::size_t HubbardFermiMatrixCheckerboard::nBondClasses() const noexcept {
+        return _bondClasses.size();
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>>
+    HubbardFermiMatrixCheckerboard::bondClass(const std::size_t c) const {
+        std::vector<std::pair<std::size_t, std::size_t>> res;
+        for (const Bond &bond : _bondClasses.at(c))
+            res.emplace_back(bond.x, bond.y);
+        return res;
+    }
+
+
+/*
+ * -------------------------- free functions --------------------------
+ */
+
+    namespace {
+        // Use version log(det(1+hat{A})).
+        std::complex<double> logdetM_p(const HubbardFermiMatrixCheckerboard &hfm,
+                                       const CDVector &phi) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+            const auto species = Species::PARTICLE;
+
+            // first factor F
+            CDMatrix B = hfm.F(0, phi, species, false);
+            // other factors
+            for (std::size_t t = 1; t < NT; ++t) {
+                hfm.applyF(B, t, phi, species, false, Side::LEFT);
+            }
+
+            B += IdMatrix<std::complex<double>>(NX);
+            return toFirstLogBranch(ilogdet(B));
+        }
+
+        // Same as logdetM_p but build hat{A} as a StabilizedProduct.
+        std::complex<double> logdetM_pStabilized(const HubbardFermiMatrixCheckerboard &hfm,
+                                                 const CDVector &phi,
+                                                 const std::size_t interval) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+            const auto species = Species::PARTICLE;
+
+            StabilizedProduct B{NX, interval};
+            CDMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, species, false);
+                B.leftMultiply(f);
+            }
+
+            return B.logdetOnePlus();
+        }
+
+        // Use version -i Phi - N_t log(det(e^{-sigmaKappa*kappa-mu})) + log(det(1+hat{A}^{-1})).
+        std::complex<double> logdetM_h(const HubbardFermiMatrixCheckerboard &hfm,
+                                       const CDVector &phi) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+
+            // build product of F^{-1}
+            CDMatrix aux = hfm.F(0, phi, Species::HOLE, true);  // the matrix under the determinant
+            for (std::size_t t = 1; t < NT; ++t) {
+                hfm.applyF(aux, t, phi, Species::HOLE, true, Side::RIGHT);
+            }
+            aux += IdMatrix<std::complex<double>>(NX);
+
+            // add Phi and return
+            return toFirstLogBranch(-static_cast<double>(NT)*hfm.logdetExpKappa(Species::HOLE, true)
+                                    - 1.0i*blaze::sum(phi)
+                                    + ilogdet(aux));
+        }
+
+        // Same as logdetM_h but build hat{A}^{-1} as a StabilizedProduct.
+        std::complex<double> logdetM_hStabilized(const HubbardFermiMatrixCheckerboard &hfm,
+                                                 const CDVector &phi,
+                                                 const std::size_t interval) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+
+            // F^{-1} are multiplied from the right, so build the transpose of hat{A}^{-1}
+            StabilizedProduct aux{NX, interval};
+            CDMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, Species::HOLE, true);
+                aux.leftMultiply(blaze::trans(f));
+            }
+
+            return toFirstLogBranch(-static_cast<double>(NT)*hfm.logdetExpKappa(Species::HOLE, true)
+                                    - 1.0i*blaze::sum(phi)
+                                    + aux.logdetOnePlus());
+        }
+    }
+
+    std::complex<double> logdetM(const HubbardFermiMatrixCheckerboard &hfm,
+                                 const CDVector &phi, const Species species,
+                                 const std::size_t stabilizationInterval) {
+        switch (species) {
+        case Species::PARTICLE:
+            return stabilizationInterval == 0
+                ? logdetM_p(hfm, phi)
+                : logdetM_pStabilized(hfm, phi, stabilizationInterval);
+        case Species::HOLE:
+            return stabilizationInterval == 0
+                ? logdetM_h(hfm, phi)
+                : logdetM_hStabilized(hfm, phi, stabilizationInterval);
+        }
+        // Strictly speaking impossible to reach but gcc complains.
+        throw std::invalid_argument("Unknown species");
+    }
+
+    CDVector logdetMBatch(const HubbardFermiMatrixCheckerboard &hfm, const CDMatrix &phis,
+                          const Species species, const std::size_t stabilizationInterval) {
+        CDVector res(phis.rows());
+        parallelFor(phis.rows(), [&](const std::size_t i) {
+            const CDVector phi = blaze::trans(blaze::row(phis, i));
+            res[i] = logdetM(hfm, phi, species, stabilizationInterval);
+        });
+        return res;
+    }
+
+    void applyM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                const Species species, const CDVector &in, CDVector &out,
+                const bool dagger) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        if (in.size() != NX*NT)
+            throw std::invalid_argument("Input vector of applyM does not have size nx*nt.");
+        out.resize(NX*NT, false);
+
+        // the sign in the exponential of phi, see F()
+        const auto phaseSign = species == Species::PARTICLE ? +1.0i : -1.0i;
+
+        CDVector aux(NX);
+        for (std::size_t t = 0; t < NT; ++t) {
+            if (!dagger) {
+                // out_t = in_t - e^kappa e^phi_{t-1} in_{t-1}, sign flipped for t=0
+                const std::size_t tm1 = t == 0 ? NT-1 : t-1;
+                const double sign = t == 0 ? -1.0 : 1.0;
+                aux = blaze::exp(phaseSign*spacevec(phi, tm1, NX)) * spacevec(in, tm1, NX);
+                hfm.applyExpKappa(aux, species, false);
+                spacevec(out, t, NX) = spacevec(in, t, NX) - sign*aux;
+            }
+            else {
+                // out_t = in_t - (e^phi_t)^* e^kappa in_{t+1}, sign flipped for t=NT-1
+                // e^kappa is real symmetric, so it is its own adjoint
+                const std::size_t tp1 = t == NT-1 ? 0 : t+1;
+                const double sign = t == NT-1 ? -1.0 : 1.0;
+                aux = spacevec(in, tp1, NX);
+                hfm.applyExpKappa(aux, species, false);
+                spacevec(out, t, NX) = spacevec(in, t, NX)
+                    - sign*blaze::conj(blaze::exp(phaseSign*spacevec(phi, t, NX))) * aux;
+            }
+        }
+    }
+
+    void applyM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                const Species species, const CDMatrix &in, CDMatrix &out,
+                const bool dagger) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t NV = in.rows();
+        if (in.columns() != NX*NT)
+            throw std::invalid_argument("Input vectors of applyM do not have size nx*nt.");
+        out.resize(NV, NX*NT, false);
+
+        // the sign in the exponential of phi, see F()
+        const auto phaseSign = species == Species::PARTICLE ? +1.0i : -1.0i;
+
+        // vectors are rows, so all matrices are applied from the right and transposed
+        CDMatrix aux(NV, NX);
+        for (std::size_t t = 0; t < NT; ++t) {
+            auto outt = blaze::submatrix(out, 0, t*NX, NV, NX);
+            if (!dagger) {
+                const std::size_t tm1 = t == 0 ? NT-1 : t-1;
+                const double sign = t == 0 ? -1.0 : 1.0;
+                aux = blaze::submatrix(in, 0, tm1*NX, NV, NX);
+                scaleColumns(aux, CDVector(blaze::exp(phaseSign*spacevec(phi, tm1, NX))));
+                hfm.applyExpKappa(aux, species, false, Side::RIGHT);
+                outt = blaze::submatrix(in, 0, t*NX, NV, NX) - sign*aux;
+            }
+            else {
+                const std::size_t tp1 = t == NT-1 ? 0 : t+1;
+                const double sign = t == NT-1 ? -1.0 : 1.0;
+                aux = blaze::submatrix(in, 0, tp1*NX, NV, NX);
+                hfm.applyExpKappa(aux, species, false, Side::RIGHT);
+                scaleColumns(aux, CDVector(blaze::conj(blaze::exp(phaseSign*spacevec(phi, t, NX)))));
+                outt = blaze::submatrix(in, 0, t*NX, NV, NX) - sign*aux;
+            }
+        }
+    }
+
+    void applyQ(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                const CDVector &in, CDVector &out, const bool dagger) {
+        // Q = M_p M_h^T and M^T x = (M^dagger x^*)^*
+        CDVector aux;
+        if (!dagger) {
+            applyM(hfm, phi, Species::HOLE, CDVector(blaze::conj(in)), aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::PARTICLE, aux, out, false);
+        }
+        else {
+            applyM(hfm, phi, Species::PARTICLE, in, aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::HOLE, aux, out, false);
+            out = blaze::conj(out);
+        }
+    }
+
+    void applyQ(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                const CDMatrix &in, CDMatrix &out, const bool dagger) {
+        // Q = M_p M_h^T and M^T x = (M^dagger x^*)^*
+        CDMatrix aux;
+        if (!dagger) {
+            applyM(hfm, phi, Species::HOLE, CDMatrix(blaze::conj(in)), aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::PARTICLE, aux, out, false);
+        }
+        else {
+            applyM(hfm, phi, Species::PARTICLE, in, aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::HOLE, aux, out, false);
+            out = blaze::conj(out);
+        }
+    }
+}  // namespace isle
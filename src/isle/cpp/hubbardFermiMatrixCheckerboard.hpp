@@ -0,0 +1,274 @@
+/** \file
+ * \brief Hubbard model fermion matrices with a checkerboard decomposition of the hopping exponential.
+ */
+
+#ifndef HUBBARD_FERMI_MATRIX_CHECKERBOARD_HPP
+#define HUBBARD_FERMI_MATRIX_CHECKERBOARD_HPP
+
+#include <array>
+#include <vector>
+
+#include "math.hpp"
+#include "lattice.hpp"
+#include "species.hpp"
+
+namespace isle {
+
+    /// Represents a fermion matrix \f$\hat{M}\f$ with a checkerboard approximation of the hopping exponential.
+    /**
+     * Has the same structure as HubbardFermiMatrixExp but replaces
+     * \f$e^{\tilde{\kappa}-\tilde{\mu}}\f$ by a symmetric Trotter product over
+     * 'colour classes' of bonds.
+     * The bonds of the lattice (non-zero off-diagonal elements of \f$\tilde{\kappa}\f$)
+     * are split into classes \f$c = 0, \ldots, C-1\f$ such that no two bonds in the same class
+     * share a site.
+     * The exponential of the hopping matrix restricted to a class, \f$\tilde{\kappa}_c\f$,
+     * is therefore a product of independent \f$2\times 2\f$ matrices
+     \f[
+     \exp\begin{pmatrix}0 & \tilde{\kappa}_{xy} \\ \tilde{\kappa}_{xy} & 0\end{pmatrix}
+     = \begin{pmatrix}\cosh\tilde{\kappa}_{xy} & \sinh\tilde{\kappa}_{xy} \\
+                      \sinh\tilde{\kappa}_{xy} & \cosh\tilde{\kappa}_{xy}\end{pmatrix}
+     \f]
+     * on the pairs of sites (x, y) of the bonds.
+     * The hopping exponential is approximated by
+     \f[
+     e^{\tilde{\kappa}-\tilde{\mu}} \approx
+     e^{\tilde{\kappa}_0/2} \cdots e^{\tilde{\kappa}_{C-1}/2}\,
+     e^{\mathrm{diag}(\tilde{\kappa})-\tilde{\mu}}\,
+     e^{\tilde{\kappa}_{C-1}/2} \cdots e^{\tilde{\kappa}_0/2},
+     \f]
+     * and likewise for holes and the inverses.
+     * This product is real symmetric and has the same determinant as the exact exponential.
+     * The error is \f$\mathcal{O}(\tilde{\kappa}^3)\f$ per time slice, so the same as the
+     * discretization error of HubbardFermiMatrixDia and HubbardFermiMatrixExp.
+     * The bonds are coloured greedily, bipartite lattices with coordination number z
+     * usually need z classes, e.g. 3 for the honeycomb lattice.
+     *
+     * Applying the hopping exponential to a vector costs \f$\mathcal{O}(N_x)\f$ operations
+     * instead of \f$\mathcal{O}(N_x^2)\f$ and to a matrix \f$\mathcal{O}(N_x^2)\f$ instead of
+     * \f$\mathcal{O}(N_x^3)\f$.
+     * The exponential is never stored as a dense matrix, only the \f$\cosh\f$ and \f$\sinh\f$
+     * of the bonds are.
+     *
+     * \sa
+     * Free functions operating on `%HubbardFermiMatrixCheckerboard`:
+     *  - std::complex<double> logdetM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi, Species species, std::size_t stabilizationInterval)
+     *  - CDVector logdetMBatch(const HubbardFermiMatrixCheckerboard &hfm, const CDMatrix &phis, Species species, std::size_t stabilizationInterval)
+     *  - void applyM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi, Species species, const CDVector &in, CDVector &out, bool dagger)
+     *  - void applyQ(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi, const CDVector &in, CDVector &out, bool dagger)
+     */
+    class HubbardFermiMatrixCheckerboard {
+    public:
+        /// Store all necessary parameters and split the bonds into classes.
+        /**
+         * \param kappaTilde Hopping matrix \f$\tilde{\kappa}\f$, must be symmetric.
+         * \param muTilde Chemical potential \f$\tilde{\mu}\f$.
+         * \param sigmaKappa Sign of hopping matrix in hole matrix.
+         * \throws std::invalid_argument if `kappaTilde` is not square.
+         */
+        HubbardFermiMatrixCheckerboard(const SparseMatrix<double> &kappaTilde,
+                                       double muTilde, std::int8_t sigmaKappa);
+
+        HubbardFermiMatrixCheckerboard(const Lattice &lat, double beta,
+                                       double muTilde, std::int8_t sigmaKappa);
+
+        HubbardFermiMatrixCheckerboard(const HubbardFermiMatrixCheckerboard &) = default;
+        HubbardFermiMatrixCheckerboard &operator=(const HubbardFermiMatrixCheckerboard &) = default;
+        HubbardFermiMatrixCheckerboard(HubbardFermiMatrixCheckerboard &&) = default;
+        HubbardFermiMatrixCheckerboard &operator=(HubbardFermiMatrixCheckerboard &&) = default;
+        ~HubbardFermiMatrixCheckerboard() = default;
+
+        /// Multiply the approximated hopping exponential onto a vector in place.
+        /**
+         * \param vec Vector of size nx.
+         * \param species Select whether to apply \f$e^{\tilde{\kappa}-\tilde{\mu}}\f$
+         *                or \f$e^{\sigma_{\tilde{\kappa}}\tilde{\kappa}+\tilde{\mu}}\f$.
+         * \param inv If `true`, apply the inverse.
+         */
+        void applyExpKappa(CDVector &vec, Species species, bool inv) const;
+
+        /// Multiply the approximated hopping exponential onto a matrix in place.
+        /**
+         * \param mat Matrix with nx rows for `side == Side::LEFT`
+         *            or nx columns for `side == Side::RIGHT`.
+         * \param species Select whether to apply the exponential for particles or holes.
+         * \param inv If `true`, apply the inverse.
+         * \param side Select whether to multiply from the left or right.
+         */
+        void applyExpKappa(CDMatrix &mat, Species species, bool inv, Side side) const;
+
+        /// Return the approximated hopping exponential as a dense matrix.
+        /**
+         * Only meant for testing and debugging, costs \f$\mathcal{O}(N_x^2)\f$.
+         * \see HubbardFermiMatrixExp::expKappa()
+         */
+        DMatrix expKappa(Species species, bool inv) const;
+
+        /// Return log(det(expKappa(species, inv)), this is exact.
+        std::complex<double> logdetExpKappa(Species species, bool inv) const;
+
+        /// Store the diagonal block K of matrix M in the parameter, this is the identity.
+        void K(DSparseMatrix &k, Species species) const;
+
+        /// Return the diagonal block matrix K of matrix M, this is the identity.
+        IdMatrix<double> K(Species species) const;
+
+        /// Return the inverse of the diagonal block matrix K of matrix M, this is the identity.
+        DMatrix Kinv(Species species) const;
+
+        /// Return log(det(K^-1)) = 0.
+        std::complex<double> logdetKinv(Species species) const;
+
+        /// Store an off-diagonal block F of matrix M in the parameter.
+        /**
+         * \param f Any old content is erased and the matrix is
+         *          resized if need be.
+         * \param tp Temporal row index t'.
+         * \param phi Auxilliary field.
+         * \param species Select whether to construct for particles or holes.
+         * \param inv If `true` constructs the inverse of F.
+         */
+        void F(CDMatrix &f, std::size_t tp, const CDVector &phi,
+               Species species, bool inv=false) const;
+
+        /// Return an off-diagonal block matrix F of matrix M.
+        /**
+         * \param tp Temporal row index t'.
+         * \param phi Auxilliary field.
+         * \param species Select whether to construct for particles or holes.
+         * \param inv If `true` constructs the inverse of F.
+         */
+        CDMatrix F(std::size_t tp, const CDVector &phi,
+                   Species species, bool inv=false) const;
+
+        /// Multiply an off-diagonal block F of matrix M onto a matrix in place.
+        /**
+         * Computes `mat = F*mat` or `mat = mat*F` in \f$\mathcal{O}(N_x^2)\f$ operations.
+         * \see HubbardFermiMatrixExp::applyF()
+         */
+        void applyF(CDMatrix &mat, std::size_t tp, const CDVector &phi,
+                    Species species, bool inv, Side side) const;
+
+        /// Store the matrix \f$M\f$ in the parameter.
+        /**
+         * \param m Any old content is erased and the matrix is
+         *          resized if need be.
+         * \param phi Auxilliary field.
+         * \param species Select whether to construct for particles or holes.
+         */
+        void M(CDSparseMatrix &m, const CDVector &phi, Species species) const;
+
+        /// Return the matrix \f$M\f$.
+        /**
+         * \param phi Auxilliary field.
+         * \param species Select whether to construct for particles or holes.
+         */
+        CDSparseMatrix M(const CDVector &phi, Species species) const;
+
+        /// Update the hopping matrix and split the bonds into classes again.
+        void updateKappaTilde(const DSparseMatrix &kappaTilde);
+
+        /// Update the chemical potential.
+        void updateMuTilde(double muTilde);
+
+        /// Return hopping matrix.
+        const DSparseMatrix &kappaTilde() const noexcept;
+
+        /// Return chemical potential.
+        double muTilde() const noexcept;
+
+        /// Return sign of kappa in hole matrix.
+        std::int8_t sigmaKappa() const noexcept;
+
+        /// Spatial size of the lattice.
+        std::size_t nx() const noexcept;
+
+        /// Return the number of colour classes of bonds.
+        std::size_t nBondClasses() const noexcept;
+
+        /// Return the pairs of sites of all bonds in colour class c.
+        std::vector<std::pair<std::size_t, std::size_t>> bondClass(std::size_t c) const;
+
+    private:
+        /// A single bond with the factors of its half step.
+        struct Bond {
+            std::size_t x;  ///< First site.
+            std::size_t y;  ///< Second site.
+            double cosh;  ///< cosh(kappaTilde_xy / 2).
+            double sinh;  ///< sinh(kappaTilde_xy / 2).
+        };
+
+        /// Split the bonds into classes and compute the diagonal factors.
+        void _setup();
+
+        /// Return the sign of the hopping matrix in the exponent.
+        double _hoppingSign(Species species, bool inv) const noexcept;
+
+        /// Return one of _diagonal.
+        const DVector &_diagonalFactor(Species species, bool inv) const;
+
+        DSparseMatrix _kappa;  ///< Hopping matrix (tilde).
+        double _mu;  ///< Chemical potential.
+        std::int8_t _sigmaKappa;  ///< Sign of kappa in M^dag.
+
+        /// Bonds split into classes without shared sites.
+        std::vector<std::vector<Bond>> _bondClasses;
+        /// exp(+-diag(kappaTilde) -+ muTilde) for the central factor,
+        /// order: particles, particles inverse, holes, holes inverse.
+        std::array<DVector, 4> _diagonal;
+    };
+
+
+    /// Compute \f$\log(\det(M))\f$.
+    /**
+     * Same algorithm as for HubbardFermiMatrixExp but all products of time slices
+     * are computed with HubbardFermiMatrixCheckerboard::applyF() in
+     * \f$\mathcal{O}(N_t N_x^2)\f$ operations.
+     * Only the final determinant costs \f$\mathcal{O}(N_x^3)\f$.
+     * \see logdetM(const HubbardFermiMatrixExp&, const CDVector&, Species, std::size_t)
+     */
+    std::complex<double> logdetM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                                 Species species, std::size_t stabilizationInterval=0);
+
+    /// Compute \f$\log(\det(M))\f$ for many configurations at once.
+    /**
+     * \see logdetMBatch(const HubbardFermiMatrixExp&, const CDMatrix&, Species, std::size_t)
+     */
+    CDVector logdetMBatch(const HubbardFermiMatrixCheckerboard &hfm, const CDMatrix &phis,
+                          Species species, std::size_t stabilizationInterval=0);
+
+    /// Apply \f$M\f$ or \f$M^\dagger\f$ to a vector without constructing M.
+    /**
+     * Costs \f$\mathcal{O}(N_t N_x)\f$ operations.
+     * \see applyM(const HubbardFermiMatrixExp&, const CDVector&, Species, const CDVector&, CDVector&, bool)
+     */
+    void applyM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                Species species, const CDVector &in, CDVector &out,
+                bool dagger=false);
+
+    /// Apply \f$M\f$ or \f$M^\dagger\f$ to many vectors at once without constructing M.
+    /**
+     * Vectors are stored in the rows of `in` and `out`.
+     * \see applyM(const HubbardFermiMatrixExp&, const CDVector&, Species, const CDMatrix&, CDMatrix&, bool)
+     */
+    void applyM(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                Species species, const CDMatrix &in, CDMatrix &out,
+                bool dagger=false);
+
+    /// Apply \f$Q\f$ or \f$Q^\dagger\f$ to a vector without constructing Q.
+    /**
+     * \see applyQ(const HubbardFermiMatrixExp&, const CDVector&, const CDVector&, CDVector&, bool)
+     */
+    void applyQ(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                const CDVector &in, CDVector &out, bool dagger=false);
+
+    /// Apply \f$Q\f$ or \f$Q^\dagger\f$ to many vectors at once without constructing Q.
+    /**
+     * \see applyQ(const HubbardFermiMatrixExp&, const CDVector&, const CDMatrix&, CDMatrix&, bool)
+     */
+    void applyQ(const HubbardFermiMatrixCheckerboard &hfm, const CDVector &phi,
+                const CDMatrix &in, CDMatrix &out, bool dagger=false);
+
+}  // namespace isle
+
+#endif  // ndef HUBBARD_FERMI_MATRIX_CHECKERBOARD_HPP
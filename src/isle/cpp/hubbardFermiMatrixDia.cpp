@@ -1,9 +1,12 @@
 #include "hubbardFermiMatrixDia.hpp"
 
 #include <memory>
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
+#include "parallel.hpp"
+#include "stabilizedProduct.hpp"
 #include "logging/logging.hpp"
 
 using namespace std::complex_literals;
@@ -51,7 +54,8 @@ namespace isle {
                                                  const std::int8_t sigmaKappa)
         : _kappa{kappaTilde}, _mu{muTilde}, _sigmaKappa{sigmaKappa},
           _kinvp{std::bind(inverseK, std::ref(*this), Species::PARTICLE)},
-          _kinvh{std::bind(inverseK, std::ref(*this), Species::HOLE)}
+          _kinvh{std::bind(inverseK, std::ref(*this), Species::HOLE)},
+          _kCSRp{K(Species::PARTICLE)}, _kCSRh{K(Species::HOLE)}
     {
         if (kappaTilde.rows() != kappaTilde.columns())
             throw std::invalid_argument("Hopping matrix is not square");
@@ -71,7 +75,8 @@ namespace isle {
     HubbardFermiMatrixDia::HubbardFermiMatrixDia(const HubbardFermiMatrixDia &other)
         : _kappa{other._kappa}, _mu{other._mu}, _sigmaKappa{other._sigmaKappa},
           _kinvp{std::bind(inverseK, std::ref(*this), Species::PARTICLE)},
-          _kinvh{std::bind(inverseK, std::ref(*this), Species::HOLE)}
+          _kinvh{std::bind(inverseK, std::ref(*this), Species::HOLE)},
+          _kCSRp{other._kCSRp}, _kCSRh{other._kCSRh}
         { }
 
     HubbardFermiMatrixDia &HubbardFermiMatrixDia::operator=(
@@ -84,6 +89,8 @@ namespace isle {
                                             Species::PARTICLE));
         _kinvh = decltype(_kinvh)(std::bind(inverseK, std::ref(*this),
                                             Species::HOLE));
+        _kCSRp = other._kCSRp;
+        _kCSRh = other._kCSRh;
 
         return *this;
     }
@@ -93,6 +100,11 @@ namespace isle {
         _kinvh.invalidate();
     }
 
+    void HubbardFermiMatrixDia::_updateKCSR() {
+        _kCSRp = CSRMatrix{K(Species::PARTICLE)};
+        _kCSRh = CSRMatrix{K(Species::HOLE)};
+    }
+
     void HubbardFermiMatrixDia::K(DSparseMatrix &k, const Species species) const {
         const std::size_t NX = nx();
 
@@ -137,6 +149,43 @@ namespace isle {
         return f;
     }
 
+    CDVector HubbardFermiMatrixDia::phaseF(const std::size_t tp, const CDVector &phi,
+                                           const Species species, const bool inv) const {
+        const std::size_t NX = nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t tm1 = tp==0 ? NT-1 : tp-1;  // t' - 1
+
+        const auto sign = ((inv && species == Species::PARTICLE) || (species == Species::HOLE && !inv))
+            ? -1.i
+            : +1.i;
+        return blaze::exp(sign*spacevec(phi, tm1, NX));
+    }
+
+    void HubbardFermiMatrixDia::applyF(CDMatrix &mat,
+                                       const std::size_t tp, const CDVector &phi,
+                                       const Species species, const bool inv,
+                                       const Side side) const {
+        const CDVector phase = phaseF(tp, phi, species, inv);
+        if (side == Side::LEFT)
+            scaleRows(mat, phase);
+        else
+            scaleColumns(mat, phase);
+    }
+
+    void HubbardFermiMatrixDia::applyFK(CDMatrix &mat,
+                                        const std::size_t tp, const CDVector &phi,
+                                        const Species species, const bool inv,
+                                        const Side side) const {
+        const CDVector phase = phaseF(tp, phi, species, inv);
+        const CSRMatrix &k = species == Species::PARTICLE ? _kCSRp : _kCSRh;
+        CDMatrix res;
+        if (side == Side::LEFT)
+            multCSRScaled(phase, k, mat, res);
+        else
+            multScaledCSR(mat, phase, k, res);
+        swap(mat, res);
+    }
+
     void HubbardFermiMatrixDia::M(CDSparseMatrix &m,
                                   const CDVector &phi,
                                   const Species species) const {
@@ -247,11 +296,13 @@ namespace isle {
     void HubbardFermiMatrixDia::updateKappaTilde(const SparseMatrix<double> &kappaTilde) {
         _invalidateKCaches();
         _kappa = kappaTilde;
+        _updateKCSR();
     }
 
     void HubbardFermiMatrixDia::updateMuTilde(const double muTilde) {
         _invalidateKCaches();
         _mu = muTilde;
+        _updateKCSR();
     }
 
     const SparseMatrix<double> &HubbardFermiMatrixDia::kappaTilde() const noexcept {
@@ -274,7 +325,9 @@ namespace isle {
  * -------------------------- QLU --------------------------
  */
 
-    HubbardFermiMatrixDia::QLU::QLU(const std::size_t nt) {
+    HubbardFermiMatrixDia::QLU::QLU(const std::size_t nx, const std::size_t nt)
+        : _storage{nx, nt + 2*(nt > 1 ? nt-1 : 0) + 2*(nt > 2 ? nt-2 : 0)} {
+
         dinv.reserve(nt);
         if (nt > 1) {
             u.reserve(nt-1);
@@ -284,6 +337,20 @@ namespace isle {
                 h.reserve(nt-2);
             }
         }
+
+        // interleave blocks of each time slice to keep them close in memory
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < nt; ++i) {
+            dinv.emplace_back(_storage.block(next++));
+            if (i+1 < nt) {
+                u.emplace_back(_storage.block(next++));
+                l.emplace_back(_storage.block(next++));
+            }
+            if (i+2 < nt) {
+                v.emplace_back(_storage.block(next++));
+                h.emplace_back(_storage.block(next++));
+            }
+        }
     }
 
     bool HubbardFermiMatrixDia::QLU::isConsistent() const {
@@ -358,68 +425,70 @@ namespace isle {
         return recon;
     }
 
+    std::size_t HubbardFermiMatrixDia::QLU::nx() const noexcept {
+        return _storage.nx();
+    }
+
+    std::size_t HubbardFermiMatrixDia::QLU::nt() const noexcept {
+        return dinv.size();
+    }
+
 /*
  * -------------------------- free functions --------------------------
  */
 
     namespace {
         /// Special case LU decomposition of Q for nt == 1.
-        HubbardFermiMatrixDia::QLU nt1QLU(const HubbardFermiMatrixDia &hfm,
-                                          const CDVector &phi) {
-            HubbardFermiMatrixDia::QLU lu{1};
-
+        void nt1QLU(const HubbardFermiMatrixDia &hfm,
+                    const CDVector &phi,
+                    HubbardFermiMatrixDia::QLU &lu) {
             // construct d_0
             CDSparseMatrix T = hfm.Tplus(0, phi);
-            lu.dinv.emplace_back(hfm.P() + T);
+            lu.dinv[0] = hfm.P() + T;
             hfm.Tminus(T, 0, phi);
             lu.dinv[0] += T;
 
             // invert d_0
             std::unique_ptr<int[]> ipiv = std::make_unique<int[]>(phi.size());
             invert(lu.dinv[0], ipiv);
-
-            return lu;
         }
 
         /// Special case LU decomposition of Q for nt == 2.
-        HubbardFermiMatrixDia::QLU nt2QLU(const HubbardFermiMatrixDia &hfm,
-                                          const CDVector &phi) {
+        void nt2QLU(const HubbardFermiMatrixDia &hfm,
+                    const CDVector &phi,
+                    HubbardFermiMatrixDia::QLU &lu) {
             const std::size_t nx = hfm.nx();
-            constexpr std::size_t nt = 2;
-            HubbardFermiMatrixDia::QLU lu{nt};
 
             const auto P = hfm.P();  // diagonal block P
             SparseMatrix<std::complex<double>> aux0, aux1; // T^+, T^-, and u
             std::unique_ptr<int[]> ipiv = std::make_unique<int[]>(nx);// pivot indices for inversion
 
             // d_0
-            lu.dinv.emplace_back(P);
+            lu.dinv[0] = P;
             invert(lu.dinv[0], ipiv);
 
             // l_0
             hfm.Tplus(aux0, 1, phi);
             hfm.Tminus(aux1, 1, phi);
-            lu.l.emplace_back((aux0+aux1)*lu.dinv[0]);
+            lu.l[0] = (aux0+aux1)*lu.dinv[0];
 
             // u_0
             hfm.Tplus(aux0, 0, phi);
             hfm.Tminus(aux1, 0, phi);
             aux0 += aux1;  // now aux0 = u_0
-            lu.u.emplace_back(aux0);
+            lu.u[0] = aux0;
 
             // d_1
-            lu.dinv.emplace_back(P - lu.l[0]*aux0);
+            lu.dinv[1] = P - lu.l[0]*aux0;
             invert(lu.dinv[1], ipiv);
-
-            return lu;
         }
 
         /// General case LU decomposition of Q for nt > 2.
-        HubbardFermiMatrixDia::QLU generalQLU(const HubbardFermiMatrixDia &hfm,
-                                              const CDVector &phi) {
+        void generalQLU(const HubbardFermiMatrixDia &hfm,
+                        const CDVector &phi,
+                        HubbardFermiMatrixDia::QLU &lu) {
             const std::size_t nx = hfm.nx();
             const std::size_t nt = getNt(phi, nx);
-            HubbardFermiMatrixDia::QLU lu{nt};
 
             const auto P = hfm.P();  // diagonal block P
             SparseMatrix<std::complex<double>> T;  // subdiagonal blocks T^+ and T^-
@@ -429,70 +498,101 @@ namespace isle {
             std::unique_ptr<int[]> ipiv = std::make_unique<int[]>(nx);
 
             // starting components of d, u, l
-            lu.dinv.emplace_back(P);
-            invert(lu.dinv.back(), ipiv);
+            lu.dinv[0] = P;
+            invert(lu.dinv[0], ipiv);
             hfm.Tminus(u, 0, phi);   // now u = lu.u[0]
-            lu.u.emplace_back(u);
+            lu.u[0] = u;
             hfm.Tplus(T, 1, phi);
-            lu.l.emplace_back(T*lu.dinv.back());
+            lu.l[0] = T*lu.dinv[0];
 
             // v, h
             hfm.Tplus(T, 0, phi);
-            lu.v.emplace_back(T);
+            lu.v[0] = T;
             hfm.Tminus(T, nt-1, phi);
-            lu.h.emplace_back(T*lu.dinv.back());
+            lu.h[0] = T*lu.dinv[0];
 
             // iterate for i in [1, nt-3], 'regular' part of d, u, l, v, h
             for (std::size_t i = 1; i < nt-2; ++i) {
                 // here, u = lu.u[i-1]
-                lu.dinv.emplace_back(P - lu.l[i-1]*u);
-                invert(lu.dinv.back(), ipiv);
+                lu.dinv[i] = P - lu.l[i-1]*u;
+                invert(lu.dinv[i], ipiv);
 
                 hfm.Tplus(T, i+1, phi);
-                lu.l.emplace_back(T*lu.dinv[i]);
-                lu.h.emplace_back(-lu.h[i-1]*u*lu.dinv[i]);
-                lu.v.emplace_back(-lu.l[i-1]*lu.v[i-1]);
+                lu.l[i] = T*lu.dinv[i];
+                lu.h[i] = -lu.h[i-1]*u*lu.dinv[i];
+                lu.v[i] = -lu.l[i-1]*lu.v[i-1];
 
                 hfm.Tminus(u, i, phi);
-                lu.u.emplace_back(u);  // now u = lu.u[i]
+                lu.u[i] = u;  // now u = lu.u[i]
             }
             // from now on u is lu.u[nt-3]
 
             // additional 'regular' step for d
-            lu.dinv.emplace_back(P - lu.l[nt-3]*u);
-            invert(lu.dinv.back(), ipiv);
+            lu.dinv[nt-2] = P - lu.l[nt-3]*u;
+            invert(lu.dinv[nt-2], ipiv);
 
             // final components of u, l
             hfm.Tminus(T, nt-2, phi);
-            lu.u.emplace_back(T - lu.l[nt-3]*lu.v[nt-3]);
+            lu.u[nt-2] = T - lu.l[nt-3]*lu.v[nt-3];
             hfm.Tplus(T, nt-1, phi);
-            lu.l.emplace_back((T - lu.h[nt-3]*u)*lu.dinv[nt-2]);
+            lu.l[nt-2] = (T - lu.h[nt-3]*u)*lu.dinv[nt-2];
 
             // final component of d
-            lu.dinv.emplace_back(P - lu.l[nt-2]*lu.u[nt-2]);
+            lu.dinv[nt-1] = P - lu.l[nt-2]*lu.u[nt-2];
             for (std::size_t i = 0; i < nt-2; ++i)
                 lu.dinv[nt-1] -= lu.h[i]*lu.v[i];
-            invert(lu.dinv.back(), ipiv);
-
-            return lu;
+            invert(lu.dinv[nt-1], ipiv);
         }
     }
 
-    HubbardFermiMatrixDia::QLU getQLU(const HubbardFermiMatrixDia &hfm,
-                                      const CDVector &phi) {
-        switch (phi.size()/hfm.nx()) {
+    void getQLU(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                HubbardFermiMatrixDia::QLU &into) {
+        const std::size_t nx = hfm.nx();
+        const std::size_t nt = getNt(phi, nx);
+        if (into.nx() != nx || into.nt() != nt)
+            into = HubbardFermiMatrixDia::QLU{nx, nt};
+
+        switch (nt) {
         case 1:
-            return nt1QLU(hfm, phi);
+            nt1QLU(hfm, phi, into);
+            break;
         case 2:
-            return nt2QLU(hfm, phi);
+            nt2QLU(hfm, phi, into);
+            break;
         default:
-            return generalQLU(hfm, phi);
+            generalQLU(hfm, phi, into);
+        }
+    }
+
+    HubbardFermiMatrixDia::QLU getQLU(const HubbardFermiMatrixDia &hfm,
+                                      const CDVector &phi) {
+        HubbardFermiMatrixDia::QLU lu;
+        getQLU(hfm, phi, lu);
+        return lu;
+    }
+
+    CyclicReduction getQCR(const HubbardFermiMatrixDia &hfm, const CDVector &phi) {
+        const std::size_t nt = getNt(phi, hfm.nx());
+        std::vector<CDMatrix> diag, lower, upper;
+        diag.reserve(nt);
+        lower.reserve(nt);
+        upper.reserve(nt);
+
+        const CDMatrix P = hfm.P();
+        for (std::size_t t = 0; t < nt; ++t) {
+            diag.emplace_back(P);
+            lower.emplace_back(hfm.Tplus(t, phi));
+            upper.emplace_back(hfm.Tminus(t, phi));
         }
+        return CyclicReduction(std::move(diag), std::move(lower), std::move(upper));
     }
 
     Vector<std::complex<double>> solveQ(const HubbardFermiMatrixDia &hfm,
                                         const CDVector &phi,
-                                        const Vector<std::complex<double>> &rhs) {
+                                        const Vector<std::complex<double>> &rhs,
+                                        const QFactorization algorithm) {
+        if (algorithm == QFactorization::CYCLIC_REDUCTION)
+            return getQCR(hfm, phi).solve(rhs);
         return solveQ(getQLU(hfm, phi), rhs);
     }
 
@@ -536,8 +636,74 @@ namespace isle {
         return x;
     }
 
+    namespace {
+        /// Solve Q x = b for rows [first, first+n) of rhss, x has the same shape as rhss.
+        void solveQRows(const HubbardFermiMatrixDia::QLU &lu, const CDMatrix &rhss,
+                        CDMatrix &x, const std::size_t first, const std::size_t n) {
+            const std::size_t nt = lu.dinv.size();
+            const std::size_t nx = lu.dinv[0].rows();
+            // view on time slice t of the selected right hand sides
+            const auto slice = [first, n, nx](auto &mat, const std::size_t t) {
+                return blaze::submatrix(mat, first, t*nx, n, nx);
+            };
+
+            // solve L*y = rhs, store y in x
+            // rows of rhs are transposed vectors, hence multiply transposed blocks from the right
+            for (std::size_t t = 0; t < nt; ++t)
+                slice(x, t) = slice(rhss, t);
+            for (std::size_t i = 1; i < nt; ++i)
+                slice(x, i) -= slice(x, i-1)*blaze::trans(lu.l[i-1]);
+            for (std::size_t j = 0; j+2 < nt; ++j)
+                slice(x, nt-1) -= slice(x, j)*blaze::trans(lu.h[j]);
+
+            // solve U*x = y in place
+            CDMatrix aux = slice(x, nt-1);
+            slice(x, nt-1) = aux*blaze::trans(lu.dinv[nt-1]);
+            if (nt > 1) {
+                aux = slice(x, nt-2) - slice(x, nt-1)*blaze::trans(lu.u[nt-2]);
+                slice(x, nt-2) = aux*blaze::trans(lu.dinv[nt-2]);
+                // iterate i in [nt-3, 0]
+                for (std::size_t i = nt-3; i != static_cast<std::size_t>(-1); --i) {
+                    aux = slice(x, i) - slice(x, i+1)*blaze::trans(lu.u[i])
+                        - slice(x, nt-1)*blaze::trans(lu.v[i]);
+                    slice(x, i) = aux*blaze::trans(lu.dinv[i]);
+                }
+            }
+        }
+    }
+
+    CDMatrix solveQ(const HubbardFermiMatrixDia::QLU &lu, const CDMatrix &rhss,
+                    const std::size_t nblocks) {
+        const std::size_t nt = lu.dinv.size();
+#ifndef NDEBUG
+        if (!lu.isConsistent())
+            throw std::runtime_error("Components of LU not initialized properly");
+        if (rhss.columns() != lu.dinv[0].rows()*nt)
+            throw std::runtime_error("Right hand sides do not have correct size (spacetime vectors)");
+#endif
+        if (nblocks == 0)
+            throw std::invalid_argument("Number of blocks of right hand sides must be positive");
+
+        const std::size_t nrhs = rhss.rows();
+        CDMatrix x(nrhs, rhss.columns());
+        const std::size_t blockSize = (nrhs + nblocks - 1) / nblocks;
+        if (nblocks == 1 || blockSize == 0)
+            solveQRows(lu, rhss, x, 0, nrhs);
+        else {
+            // blocks write to disjoint rows of x
+            parallelFor((nrhs + blockSize - 1) / blockSize, [&](const std::size_t b) {
+                const std::size_t first = b*blockSize;
+                solveQRows(lu, rhss, x, first, std::min(blockSize, nrhs-first));
+            });
+        }
+        return x;
+    }
+
     std::complex<double> logdetQ(const HubbardFermiMatrixDia &hfm,
-                                 const CDVector &phi) {
+                                 const CDVector &phi,
+                                 const QFactorization algorithm) {
+        if (algorithm == QFactorization::CYCLIC_REDUCTION)
+            return getQCR(hfm, phi).logdet();
         auto lu = getQLU(hfm, phi);
         return ilogdetQ(lu);
     }
@@ -549,9 +715,12 @@ namespace isle {
 #endif
 
         std::complex<double> ldet;
-        // calculate logdet of diagonal blocks
-        for (const auto &dinv : lu.dinv)
-            ldet -= logdet(dinv);
+        // calculate logdet of diagonal blocks, copy into aux to not overwrite lu
+        CDMatrix aux;
+        for (const auto &dinv : lu.dinv) {
+            aux = dinv;
+            ldet -= ilogdet(aux);
+        }
         return toFirstLogBranch(ldet);
     }
 
@@ -568,34 +737,130 @@ namespace isle {
         return toFirstLogBranch(ldet);
     }
 
-    std::complex<double> logdetM(const HubbardFermiMatrixDia &hfm,
-                                 const CDVector &phi, const Species species) {
-        const auto NX = hfm.nx();
-        const auto NT = getNt(phi, NX);
-        const auto &k = hfm.K(species);
-
-        // first K * F^{-1} pair
-        auto f = hfm.F(0, phi, species, true);
-        CDMatrix aux = f*k;  // the matrix under the determinant
-        // other pairs
-        for (std::size_t t = 1; t < NT; ++t) {
-            hfm.F(f, t, phi, species, true);
-            aux = aux*f*k;
+    void selectedInverseQ(const HubbardFermiMatrixDia::QLU &lu,
+                          std::vector<CDMatrix> &upper,
+                          std::vector<CDMatrix> &lower) {
+#ifndef NDEBUG
+        if (!lu.isConsistent())
+            throw std::runtime_error("Components of LU not initialized properly");
+#endif
+
+        const std::size_t nt = lu.dinv.size();
+        upper.resize(nt);
+        lower.resize(nt);
+
+        if (nt == 1) {
+            upper[0] = lu.dinv[0];
+            lower[0] = lu.dinv[0];
+            return;
         }
-        aux += IdMatrix<std::complex<double>>(NX);
+
+        // last block row (row[j] = Qinv_{nt-1, j}) and column (col[i] = Qinv_{i, nt-1})
+        std::vector<CDMatrix> row(nt), col(nt);
+        row[nt-1] = lu.dinv[nt-1];
+        col[nt-1] = row[nt-1];
+        CDMatrix aux;
+        // iterate j in [nt-2, 0]
+        for (std::size_t j = nt-1; j-- > 0; ) {
+            row[j] = -row[j+1]*lu.l[j];
+            aux = lu.u[j]*col[j+1];
+            if (j < nt-2) {
+                row[j] -= row[nt-1]*lu.h[j];
+                aux += lu.v[j]*col[nt-1];
+            }
+            col[j] = -lu.dinv[j]*aux;
+        }
+
+        // sweep along the diagonal, diag = Qinv_{i+1, i+1}
+        CDMatrix diag = row[nt-1];
+        // iterate i in [nt-2, 0]
+        for (std::size_t i = nt-1; i-- > 0; ) {
+            lower[i] = -diag*lu.l[i];
+            aux = lu.u[i]*diag;
+            if (i < nt-2) {
+                lower[i] -= col[i+1]*lu.h[i];
+                aux += lu.v[i]*row[i+1];
+            }
+            upper[i] = -lu.dinv[i]*aux;
+
+            if (i > 0) {  // diagonal block is not needed for i == 0
+                aux = lu.u[i]*lower[i];
+                if (i < nt-2)
+                    aux += lu.v[i]*row[i];
+                diag = lu.dinv[i] - lu.dinv[i]*aux;
+            }
+        }
+
+        // blocks across the boundary
+        upper[nt-1] = std::move(row[0]);
+        lower[nt-1] = std::move(col[0]);
+    }
+
+    namespace {
+        /// Compute log(det(1+A^{-1})) by plain multiplication of all K * F^{-1} pairs.
+        std::complex<double> logdetOnePlusAinv(const HubbardFermiMatrixDia &hfm,
+                                               const CDVector &phi, const Species species) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+            // first K * F^{-1} pair
+            CDMatrix aux = hfm.F(0, phi, species, true)*hfm.K(species);  // the matrix under the determinant
+            // other pairs
+            for (std::size_t t = 1; t < NT; ++t) {
+                hfm.applyFK(aux, t, phi, species, true, Side::RIGHT);
+            }
+            aux += IdMatrix<std::complex<double>>(NX);
+            return ilogdet(aux);
+        }
+
+        /// Compute log(det(1+A^{-1})) using a StabilizedProduct.
+        std::complex<double> logdetOnePlusAinvStabilized(const HubbardFermiMatrixDia &hfm,
+                                                         const CDVector &phi,
+                                                         const Species species,
+                                                         const std::size_t interval) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+            const auto &k = hfm.K(species);
+
+            // pairs are multiplied from the right, so build the transpose of A^{-1}
+            StabilizedProduct aux{NX, interval};
+            CDSparseMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, species, true);
+                aux.leftMultiply(blaze::trans(f*k));
+            }
+            return aux.logdetOnePlus();
+        }
+    }
+
+    std::complex<double> logdetM(const HubbardFermiMatrixDia &hfm,
+                                 const CDVector &phi, const Species species,
+                                 const std::size_t stabilizationInterval) {
+        const auto ldet = stabilizationInterval == 0
+            ? logdetOnePlusAinv(hfm, phi, species)
+            : logdetOnePlusAinvStabilized(hfm, phi, species, stabilizationInterval);
 
         // add Phi and return
         switch (species) {
         case Species::PARTICLE:
-            return toFirstLogBranch(1.0i*blaze::sum(phi) + ilogdet(aux));
+            return toFirstLogBranch(1.0i*blaze::sum(phi) + ldet);
         case Species::HOLE:
-            return toFirstLogBranch(-1.0i*blaze::sum(phi) + ilogdet(aux));
+            return toFirstLogBranch(-1.0i*blaze::sum(phi) + ldet);
         }
 
         // We should never get here unless someone fucks up with the enum!
         throw std::runtime_error("Wrong value for species.");
     }
 
+    CDVector logdetMBatch(const HubbardFermiMatrixDia &hfm, const CDMatrix &phis,
+                          const Species species, const std::size_t stabilizationInterval) {
+        CDVector res(phis.rows());
+        parallelFor(phis.rows(), [&](const std::size_t i) {
+            const CDVector phi = blaze::trans(blaze::row(phis, i));
+            res[i] = logdetM(hfm, phi, species, stabilizationInterval);
+        });
+        return res;
+    }
+
     namespace {
 #ifndef NDEBUG
         void verifyResultOfSolveM(const HubbardFermiMatrixDia &hfm,
@@ -615,7 +880,8 @@ namespace isle {
     }
 
     CDMatrix solveM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
-                    const Species species, const CDMatrix &rhss) {
+                    const Species species, const CDMatrix &rhss,
+                    const std::size_t stabilizationInterval) {
 
         const std::size_t NX = hfm.nx();
         const std::size_t NT = getNt(phi, NX);
@@ -650,14 +916,25 @@ namespace isle {
         for (std::size_t t = 0; t < NT-1; ++t) {
             blaze::getrf(partialAinv[t], &ipiv[t*NX]);
         }
-        // NT-1 is special
-        partialAinv[NT-1] += IdMatrix<std::complex<double>>(NX);
-        blaze::getrf(partialAinv[NT-1], &ipiv[(NT-1)*NX]);
 
         // solve for x
         CDMatrix matLast = blaze::submatrix(res, 0, (NT-1)*NX, NRHS, NX);
-        // transpose because LAPACK wants column-major layout
-        blaze::getrs(partialAinv[NT-1], matLast, 'T', &ipiv[(NT-1)*NX]);
+        if (stabilizationInterval == 0) {
+            // NT-1 is special
+            partialAinv[NT-1] += IdMatrix<std::complex<double>>(NX);
+            blaze::getrf(partialAinv[NT-1], &ipiv[(NT-1)*NX]);
+            // transpose because LAPACK wants column-major layout
+            blaze::getrs(partialAinv[NT-1], matLast, 'T', &ipiv[(NT-1)*NX]);
+        }
+        else {
+            // build transpose of A^{-1} such that invOnePlus gives (1+A^{-1})^{-T} directly
+            StabilizedProduct Ainv{NX, stabilizationInterval};
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(Finv, t, phi, species, true);
+                Ainv.leftMultiply(blaze::trans(Finv*K));
+            }
+            matLast = matLast * Ainv.invOnePlus();
+        }
         blaze::submatrix(res, 0, (NT-1)*NX, NRHS, NX) = matLast;
         for (std::size_t t = 0; t < NT-1; ++t) {
             CDMatrix mat = blaze::submatrix(res, 0, t*NX, NRHS, NX) - matLast;
@@ -672,4 +949,150 @@ namespace isle {
         return res;
     }
 
+    void applyM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                const Species species, const CDVector &in, CDVector &out,
+                const bool dagger) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        if (in.size() != NX*NT)
+            throw std::invalid_argument("Input vector of applyM does not have size nx*nt.");
+        out.resize(NX*NT, false);
+
+        // K is real symmetric, so it is its own adjoint
+        const DSparseMatrix k = hfm.K(species);
+        for (std::size_t t = 0; t < NT; ++t) {
+            if (!dagger) {
+                // out_t = K in_t - F_t in_{t-1}, sign of F flipped for t=0
+                const std::size_t tm1 = t == 0 ? NT-1 : t-1;
+                const double sign = t == 0 ? -1.0 : 1.0;
+                spacevec(out, t, NX) = k*spacevec(in, t, NX)
+                    - sign*hfm.phaseF(t, phi, species, false)*spacevec(in, tm1, NX);
+            }
+            else {
+                // out_t = K in_t - F_{t+1}^dagger in_{t+1}, sign of F flipped for t=NT-1
+                const std::size_t tp1 = t == NT-1 ? 0 : t+1;
+                const double sign = t == NT-1 ? -1.0 : 1.0;
+                spacevec(out, t, NX) = k*spacevec(in, t, NX)
+                    - sign*blaze::conj(hfm.phaseF(tp1, phi, species, false))*spacevec(in, tp1, NX);
+            }
+        }
+    }
+
+    void applyM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                const Species species, const CDMatrix &in, CDMatrix &out,
+                const bool dagger) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t NV = in.rows();
+        if (in.columns() != NX*NT)
+            throw std::invalid_argument("Input vectors of applyM do not have size nx*nt.");
+        out.resize(NV, NX*NT, false);
+
+        // vectors are rows, so all matrices are applied from the right and transposed,
+        // K is symmetric
+        const DSparseMatrix k = hfm.K(species);
+        CDMatrix aux(NV, NX);
+        for (std::size_t t = 0; t < NT; ++t) {
+            auto outt = blaze::submatrix(out, 0, t*NX, NV, NX);
+            if (!dagger) {
+                const std::size_t tm1 = t == 0 ? NT-1 : t-1;
+                const double sign = t == 0 ? -1.0 : 1.0;
+                aux = blaze::submatrix(in, 0, tm1*NX, NV, NX);
+                scaleColumns(aux, hfm.phaseF(t, phi, species, false));
+                outt = blaze::submatrix(in, 0, t*NX, NV, NX)*k - sign*aux;
+            }
+            else {
+                const std::size_t tp1 = t == NT-1 ? 0 : t+1;
+                const double sign = t == NT-1 ? -1.0 : 1.0;
+                aux = blaze::submatrix(in, 0, tp1*NX, NV, NX);
+                scaleColumns(aux, CDVector(blaze::conj(hfm.phaseF(tp1, phi, species, false))));
+                outt = blaze::submatrix(in, 0, t*NX, NV, NX)*k - sign*aux;
+            }
+        }
+    }
+
+    void applyQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                const CDVector &in, CDVector &out, const bool dagger) {
+        // Q = M_p M_h^T and M^T x = (M^dagger x^*)^*
+        CDVector aux;
+        if (!dagger) {
+            applyM(hfm, phi, Species::HOLE, CDVector(blaze::conj(in)), aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::PARTICLE, aux, out, false);
+        }
+        else {
+            applyM(hfm, phi, Species::PARTICLE, in, aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::HOLE, aux, out, false);
+            out = blaze::conj(out);
+        }
+    }
+
+    void applyQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                const CDMatrix &in, CDMatrix &out, const bool dagger) {
+        // Q = M_p M_h^T and M^T x = (M^dagger x^*)^*
+        CDMatrix aux;
+        if (!dagger) {
+            applyM(hfm, phi, Species::HOLE, CDMatrix(blaze::conj(in)), aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::PARTICLE, aux, out, false);
+        }
+        else {
+            applyM(hfm, phi, Species::PARTICLE, in, aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::HOLE, aux, out, false);
+            out = blaze::conj(out);
+        }
+    }
+
+    void allToAllPropagator(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                            const Species species, std::complex<double> *const out) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        const DMatrix &Kinv = hfm.Kinv(species);
+
+        // view on out[x, t, y, t'] for fixed t, columns are (y, t') with t' running fastest
+        using View = blaze::CustomMatrix<std::complex<double>, blaze::unaligned, blaze::unpadded>;
+        const auto timeSlice = [out, NX, NT](const std::size_t t) {
+            return View(out + t*NX*NT, NX, NX*NT, NT*NX*NT);
+        };
+
+        // first block row w/o (1 + B_0 B_{NT-1} ... B_1)^{-1}, columns in the same order as out
+        CDMatrix source(NX, NX*NT);
+        CDMatrix aux;
+        {
+            // R = B_0 B_{NT-1} ... B_{s+1} with B_t = K^{-1} F_t
+            CDMatrix R = Kinv;
+            hfm.applyF(R, 0, phi, species, false, Side::RIGHT);
+            for (std::size_t s = NT-1; s > 0; --s) {
+                aux = -R*Kinv;
+                for (std::size_t x = 0; x < NX; ++x)
+                    for (std::size_t y = 0; y < NX; ++y)
+                        source(x, y*NT+s) = aux(x, y);
+                R = R*Kinv;
+                hfm.applyF(R, s, phi, species, false, Side::RIGHT);
+            }
+            for (std::size_t x = 0; x < NX; ++x)
+                for (std::size_t y = 0; y < NX; ++y)
+                    source(x, y*NT) = Kinv(x, y);
+
+            // R = B_0 B_{NT-1} ... B_1 at this point
+            R += IdMatrix<std::complex<double>>(NX);
+            auto ipiv = std::make_unique<int[]>(NX);
+            invert(R, ipiv);
+            timeSlice(0) = R*source;
+        }
+
+        // propagate forward in time
+        for (std::size_t t = 1; t < NT; ++t) {
+            aux = timeSlice(t-1);
+            hfm.applyF(aux, t, phi, species, false, Side::LEFT);
+            auto slice = timeSlice(t);
+            slice = Kinv*aux;
+            for (std::size_t x = 0; x < NX; ++x)
+                for (std::size_t y = 0; y < NX; ++y)
+                    slice(x, y*NT+t) += Kinv(x, y);
+        }
+    }
+
 }  // namespace isle
@@ -11,6 +11,9 @@
 #include "math.hpp"
 #include "lattice.hpp"
 #include "cache.hpp"
+#include "blockStorage.hpp"
+#include "cyclicReduction.hpp"
+#include "csrMatrix.hpp"
 #include "species.hpp"
 
 namespace isle {
@@ -36,10 +39,13 @@ namespace isle {
      * Free functions operating on `%HubbardFermimatrixDia`:
      *  - std::complex<double> logdetM(const HubbardFermiMatrixDia &hfm, const CDVector &phi, Species species)
      *  - HubbardFermiMatrixDia::LU getQLU(const HubbardFermiMatrixDia &hfm, const CDVector &phi)
-     *  - std::complex<double> logdetQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi)
+     *  - CyclicReduction getQCR(const HubbardFermiMatrixDia &hfm, const CDVector &phi)
+     *  - std::complex<double> logdetQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi, QFactorization algorithm)
      *  - std::complex<double> logdetQ(const HubbardFermiMatrixDia::QLU &lu)
-     *  - Vector<std::complex<double>> solveQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi, const Vector<std::complex<double>> &rhs);
+     *  - Vector<std::complex<double>> solveQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi, const Vector<std::complex<double>> &rhs, QFactorization algorithm);
      *  - Vector<std::complex<double>> solveQ(const HubbardFermiMatrixDia::QLU &lu, const Vector<std::complex<double>> &rhs);
+     *  - CDMatrix solveQ(const HubbardFermiMatrixDia::QLU &lu, const CDMatrix &rhss, std::size_t nblocks)
+     *  - void selectedInverseQ(const HubbardFermiMatrixDia::QLU &lu, std::vector<CDMatrix> &upper, std::vector<CDMatrix> &lower)
      *
      * See HubbardFermiMatrixExp for an alternative discretization.
      */
@@ -106,6 +112,47 @@ namespace isle {
         CDSparseMatrix F(std::size_t tp, const CDVector &phi,
                          Species species, bool inv=false) const;
 
+        /// Multiply an off-diagonal block F of matrix M onto a matrix in place.
+        /**
+         * Computes `mat = F*mat` or `mat = mat*F` without constructing F.
+         * Since F is diagonal, this amounts to a scaling of the rows or columns of `mat`.
+         *
+         * \param mat Matrix to multiply F onto, must be of size `nx x nx`.
+         * \param tp Temporal row index t'.
+         * \param phi Auxilliary field.
+         * \param species Select whether to apply F for particles or holes.
+         * \param inv If `true` applies the inverse of F.
+         * \param side Select whether to multiply F from the left or right.
+         */
+        void applyF(CDMatrix &mat, std::size_t tp, const CDVector &phi,
+                    Species species, bool inv, Side side) const;
+
+        /// Multiply the pair \f$F K\f$ onto a matrix in place.
+        /**
+         * Computes `mat = F*K*mat` or `mat = mat*F*K` in a single pass over `mat`.
+         * F is applied as a vector of phases and K is stored in CSR format,
+         * so this costs \f$\mathcal{O}(\mathrm{nnz}(K) N_x)\f$.
+         *
+         * \param mat Matrix to multiply onto, must be of size `nx x nx`.
+         * \param tp Temporal row index t' of F.
+         * \param phi Auxilliary field.
+         * \param species Select whether to apply F and K for particles or holes.
+         * \param inv If `true` uses the inverse of F (but never of K).
+         * \param side Select whether to multiply from the left or right.
+         */
+        void applyFK(CDMatrix &mat, std::size_t tp, const CDVector &phi,
+                     Species species, bool inv, Side side) const;
+
+        /// Return the diagonal of an off-diagonal block F of matrix M.
+        /**
+         * \param tp Temporal row index t'.
+         * \param phi Auxilliary field.
+         * \param species Select whether to construct for particles or holes.
+         * \param inv If `true` constructs the inverse of F.
+         */
+        CDVector phaseF(std::size_t tp, const CDVector &phi,
+                        Species species, bool inv=false) const;
+
         /// Store the matrix \f$M\f$ in the parameter.
         /**
          * \param m Any old content is erased and the matrix is
@@ -214,22 +261,49 @@ namespace isle {
          *
          * Use HubbardFermiMatrixDia::QLU::isConsistent() to check whether those conditions
          * are satisfied.
+         *
+         * All blocks are views into a single contiguous BlockStorage.
+         * Copying is therefore disabled; pass an existing instance to
+         * `getQLU(hfm, phi, into)` to reuse its memory for a new configuration.
          */
         struct QLU {
-            std::vector<CDMatrix> dinv; ///< \f$d^{-1}\f$, see definition of U.
-            std::vector<CDMatrix> u; ///< See definition of U.
-            std::vector<CDMatrix> v; ///< See definition of U.
-            std::vector<CDMatrix> l; ///< See definition of L.
-            std::vector<CDMatrix> h; ///< See definition of L.
-
-            /// Reserves space for std::vectors but does not construct matrices.
-            explicit QLU(std::size_t nt);
+            std::vector<BlockStorage::Block> dinv; ///< \f$d^{-1}\f$, see definition of U.
+            std::vector<BlockStorage::Block> u; ///< See definition of U.
+            std::vector<BlockStorage::Block> v; ///< See definition of U.
+            std::vector<BlockStorage::Block> l; ///< See definition of L.
+            std::vector<BlockStorage::Block> h; ///< See definition of L.
+
+            /// Construct an empty object, must be resized by getQLU().
+            QLU() = default;
+
+            /// Allocate storage for all blocks and set up views into it.
+            /**
+             * All blocks are stored contiguously in a single allocation.
+             * \param nx Spatial lattice size.
+             * \param nt Temporal lattice size.
+             */
+            QLU(std::size_t nx, std::size_t nt);
+
+            QLU(const QLU &) = delete;
+            QLU &operator=(const QLU &) = delete;
+            QLU(QLU &&) = default;
+            QLU &operator=(QLU &&) = default;
+            ~QLU() = default;
 
             /// Check whether an instance is set up properly, i.e. all vectors have consistent sizes.
             bool isConsistent() const;
 
             /// Reconstruct the fermion matrix as a dense matrix.
             CDMatrix reconstruct() const;
+
+            /// Spatial lattice size, 0 if no storage is allocated.
+            std::size_t nx() const noexcept;
+
+            /// Temporal lattice size, 0 if no storage is allocated.
+            std::size_t nt() const noexcept;
+
+        private:
+            BlockStorage _storage;  ///< Memory for all blocks.
         };
 
     private:
@@ -242,7 +316,14 @@ namespace isle {
         /// K^-1 for holes.
         Cache<DMatrix, std::function<DMatrix()>> _kinvh;
 
+        /// K for particles in CSR format.
+        CSRMatrix _kCSRp;
+        /// K for holes in CSR format.
+        CSRMatrix _kCSRh;
+
         void _invalidateKCaches() noexcept;
+        /// Recompute _kCSRp and _kCSRh from kappa and mu.
+        void _updateKCSR();
     };
 
 
@@ -253,18 +334,38 @@ namespace isle {
     HubbardFermiMatrixDia::QLU getQLU(const HubbardFermiMatrixDia &hfm,
                                       const CDVector &phi);
 
+    /// Perform an LU-decomposition of Q and store the result in an existing object.
+    /**
+     * Reuses the memory of `into` if it has the correct size and reallocates otherwise.
+     * \param hfm Encodes matrix \f$Q\f$.
+     * \param phi Auxilliary field.
+     * \param into Result of the decomposition. Old content is overwritten.
+     */
+    void getQLU(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                HubbardFermiMatrixDia::QLU &into);
+
+    /// Factorise Q by means of a block cyclic reduction.
+    /**
+     * The time slices are processed in parallel, see CyclicReduction.
+     * \param hfm Encodes matrix \f$Q\f$.
+     * \param phi Auxilliary field.
+     */
+    CyclicReduction getQCR(const HubbardFermiMatrixDia &hfm, const CDVector &phi);
+
     /// Solve a system of equations \f$Q x = b\f$.
     /**
      * \param hfm Encodes matrix \f$Q\f$.
      * \param phi Auxilliary field.
      * \param rhs Right hand side \f$b\f$.
+     * \param algorithm Select how to factorise Q.
      * \return Solution \f$x\f$.
      * \see `std::complex<double> solveQ(const HubbardFermiMatrixDia::QLU &lu)` in case you
      *      already have the LU-decomposition of Q.
      */
     Vector<std::complex<double>> solveQ(const HubbardFermiMatrixDia &hfm,
                                         const CDVector &phi,
-                                        const Vector<std::complex<double>> &rhs);
+                                        const Vector<std::complex<double>> &rhs,
+                                        QFactorization algorithm=QFactorization::LU);
 
     /// Solve a system of equations \f$Q x = b\f$; use LU-decomposition directly.
     /**
@@ -275,16 +376,35 @@ namespace isle {
     Vector<std::complex<double>> solveQ(const HubbardFermiMatrixDia::QLU &lu,
                                         const Vector<std::complex<double>> &rhs);
 
-    /// Compute \f$\log(\det(Q))\f$ by means of an LU-decomposition.
+    /// Solve a system of equations \f$Q x = b\f$ for many right hand sides at once.
+    /**
+     * Performs the forward and backward substitutions for all right hand sides
+     * together using matrix-matrix products.
+     *
+     * \note The layout of `rhss` is the same as in solveM(), i.e. the first index is
+     *       the number of the right hand side vector, the second index is space-time.
+     *
+     * \param lu LU-Decomposition of matrix \f$Q\f$.
+     * \param rhss Right hand sides \f$b\f$, shape `(nrhs, nx*nt)`.
+     * \param nblocks Split the right hand sides into this many blocks of rows
+     *                which are solved independently in parallel.
+     * \return Solutions \f$x\f$, same shape as rhss.
+     */
+    CDMatrix solveQ(const HubbardFermiMatrixDia::QLU &lu, const CDMatrix &rhss,
+                    std::size_t nblocks=1);
+
+    /// Compute \f$\log(\det(Q))\f$ by means of an LU-decomposition or cyclic reduction.
     /**
      * \param hfm %HubbardFermiMatrixDia to compute the determinant of.
      * \param phi Auxilliary field.
+     * \param algorithm Select how to factorise Q.
      * \return Value equivalent to `log(det(hfm.Q()))` and projected onto the
      *         first branch of the logarithm.
      * \see `std::complex<double> logdet(const HubbardFermiMatrixDia::QLU &lu)` in case you
      *      already have the LU-decomposition of Q.
      */
-    std::complex<double> logdetQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi);
+    std::complex<double> logdetQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                                 QFactorization algorithm=QFactorization::LU);
 
     /// Compute \f$\log(\det(Q))\f$ given an LU-decomposition.
     /**
@@ -309,6 +429,27 @@ namespace isle {
      */
     std::complex<double> ilogdetQ(HubbardFermiMatrixDia::QLU &lu);
 
+    /// Compute the blocks of \f$Q^{-1}\f$ next to the diagonal given an LU-decomposition.
+    /**
+     * Uses a selected inversion based on the relations \f$U Q^{-1} = L^{-1}\f$ and
+     * \f$Q^{-1} L = U^{-1}\f$ restricted to the triangles where the right hand sides
+     * are trivial.
+     * Because of the sparsity of L and U, this only requires the last block row and column
+     * of \f$Q^{-1}\f$ in addition to the blocks on and next to the diagonal.
+     * Costs \f$\mathcal{O}(N_t N_x^3)\f$ operations and \f$\mathcal{O}(N_t N_x^2)\f$ memory
+     * as opposed to \f$\mathcal{O}(N_t^3 N_x^3)\f$ and \f$\mathcal{O}(N_t^2 N_x^2)\f$
+     * for the full inverse.
+     *
+     * \param lu LU-decomposition of matrix \f$Q\f$.
+     * \param upper Set to blocks \f$(Q^{-1})_{t, t+1}\f$ for \f$t \in [0, N_t-1]\f$.
+     * \param lower Set to blocks \f$(Q^{-1})_{t+1, t}\f$ for \f$t \in [0, N_t-1]\f$.
+     *
+     * Time indices are periodic, i.e. `upper[nt-1]` is block \f$(N_t-1, 0)\f$.
+     */
+    void selectedInverseQ(const HubbardFermiMatrixDia::QLU &lu,
+                          std::vector<CDMatrix> &upper,
+                          std::vector<CDMatrix> &lower);
+
     /// Compute \f$\log(\det(M))\f$.
     /**
      * \todo Is the new form stable for mu != 0?
@@ -316,11 +457,30 @@ namespace isle {
      * \param hfm %HubbardFermiMatrixDia to compute the determinant of.
      * \param phi Auxilliary field.
      * \param species Select whether to use particles or holes.
+     * \param stabilizationInterval If greater than zero, the product of time slices
+     *                              is computed with a StabilizedProduct which performs
+     *                              a QR-decomposition every `stabilizationInterval` slices.
+     *                              Zero means no stabilization.
      * \return Value equivalent to `log(det(hfm.M()))` and projected onto the
      *         first branch of the logarithm.
      */
     std::complex<double> logdetM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
-                                 Species species);
+                                 Species species, std::size_t stabilizationInterval=0);
+
+    /// Compute \f$\log(\det(M))\f$ for many configurations at once.
+    /**
+     * Configurations are distributed over OpenMP threads, all of them share
+     * the same `hfm`.
+     *
+     * \param hfm %HubbardFermiMatrixDia to compute the determinants of.
+     * \param phis Auxilliary fields, one configuration per row,
+     *             i.e. the shape is `(nconf, nx*nt)`.
+     * \param species Select whether to use particles or holes.
+     * \param stabilizationInterval See logdetM().
+     * \return Vector of `nconf` elements, each equivalent to the result of logdetM().
+     */
+    CDVector logdetMBatch(const HubbardFermiMatrixDia &hfm, const CDMatrix &phis,
+                          Species species, std::size_t stabilizationInterval=0);
 
     /// Solve a system of equations \f$M x = b\f$.
     /**
@@ -338,10 +498,89 @@ namespace isle {
      * \param phi Gauge configuration needed to construct M.
      * \param species Select whether to solve for particles or holes.
      * \param rhs Right hand sides b.
+     * \param stabilizationInterval If greater than zero, \f$(1+A^{-1})\f$ is inverted
+     *                              using a StabilizedProduct with a QR-decomposition
+     *                              every `stabilizationInterval` slices.
+     *                              Zero means no stabilization.
      * \returns Results x, same shape as rhs.
      */
     CDMatrix solveM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
-                    const Species species, const CDMatrix &rhss);
+                    const Species species, const CDMatrix &rhss,
+                    std::size_t stabilizationInterval=0);
+
+    /// Apply \f$M\f$ or \f$M^\dagger\f$ to a vector without constructing M.
+    /**
+     * Works slice by slice using only the sparse matrix K and the phases, so this costs
+     * \f$\mathcal{O}(N_t \mathrm{nnz}(K))\f$ operations and no additional memory.
+     *
+     * \param hfm Represents matrix M.
+     * \param phi Gauge configuration needed to construct M.
+     * \param species Select whether to use particles or holes.
+     * \param in Spacetime vector to apply M to.
+     * \param out Set to \f$M \cdot \mathrm{in}\f$ or \f$M^\dagger \cdot \mathrm{in}\f$.
+     *            Must not be the same object as `in`.
+     * \param dagger If `true`, apply \f$M^\dagger\f$ instead of \f$M\f$.
+     * \throws std::invalid_argument if `in` does not match the size of M.
+     */
+    void applyM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                Species species, const CDVector &in, CDVector &out,
+                bool dagger=false);
+
+    /// Apply \f$M\f$ or \f$M^\dagger\f$ to many vectors at once without constructing M.
+    /**
+     * Like applyM(const HubbardFermiMatrixDia&, const CDVector&, Species, const CDVector&, CDVector&, bool)
+     * but for many vectors which are stored in the rows of `in` and `out`, i.e. in the
+     * same layout as in solveM().
+     * The hopping matrix is applied to all vectors with a single matrix-matrix product
+     * per time slice.
+     * \throws std::invalid_argument if the rows of `in` do not match the size of M.
+     */
+    void applyM(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                Species species, const CDMatrix &in, CDMatrix &out,
+                bool dagger=false);
+
+    /// Apply \f$Q\f$ or \f$Q^\dagger\f$ to a vector without constructing Q.
+    /**
+     * Uses \f$Q = M_p M_h^T\f$, i.e. applies M for particles and holes in turn.
+     *
+     * \param hfm Represents matrix Q.
+     * \param phi Gauge configuration needed to construct Q.
+     * \param in Spacetime vector to apply Q to.
+     * \param out Set to \f$Q \cdot \mathrm{in}\f$ or \f$Q^\dagger \cdot \mathrm{in}\f$.
+     *            Must not be the same object as `in`.
+     * \param dagger If `true`, apply \f$Q^\dagger\f$ instead of \f$Q\f$.
+     * \throws std::invalid_argument if `in` does not match the size of Q.
+     */
+    void applyQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                const CDVector &in, CDVector &out, bool dagger=false);
+
+    /// Apply \f$Q\f$ or \f$Q^\dagger\f$ to many vectors at once without constructing Q.
+    /**
+     * Vectors are stored in the rows of `in` and `out`,
+     * see applyM(const HubbardFermiMatrixDia&, const CDVector&, Species, const CDMatrix&, CDMatrix&, bool).
+     */
+    void applyQ(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                const CDMatrix &in, CDMatrix &out, bool dagger=false);
+
+    /// Compute the all-to-all propagator \f$M^{-1}\f$.
+    /**
+     * Writes \f$(M^{-1})_{(t,x),(t',y)}\f$ into `out[x, t, y, t']`, i.e. element
+     * `out[((x*nt + t)*nx + y)*nt + t']` for a C-contiguous array of shape `(nx, nt, nx, nt)`.
+     *
+     * With \f$B_t = K^{-1} F_t\f$, the first block row of \f$M^{-1}\f$ is built from
+     * \f$(1 + B_0 B_{N_t-1} \cdots B_1)^{-1}\f$ and all other block rows follow from
+     * \f$(M^{-1})_{t,t'} = B_t (M^{-1})_{t-1,t'} + \delta_{t,t'} K^{-1}\f$.
+     * This avoids solving against an identity matrix of right hand sides as well as
+     * reordering the result afterwards.
+     *
+     * \param hfm Represents matrix M.
+     * \param phi Gauge configuration needed to construct M.
+     * \param species Select whether to compute the propagator for particles or holes.
+     * \param out Pointer to the result, must have space for `nx*nt*nx*nt` elements.
+     *            The memory does not have to be initialized.
+     */
+    void allToAllPropagator(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                            Species species, std::complex<double> *out);
 
 
 }  // namespace isle
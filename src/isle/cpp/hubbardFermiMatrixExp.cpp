@@ -1,9 +1,13 @@
 #include "hubbardFermiMatrixExp.hpp"
 
 #include <memory>
+#include <algorithm>
+#include <numeric>
 #include <limits>
 #include <cmath>
 
+#include "parallel.hpp"
+#include "stabilizedProduct.hpp"
 #include "logging/logging.hpp"
 
 using namespace std::complex_literals;
@@ -20,29 +24,6 @@ namespace isle {
             if (mat.rows() != target)
                 mat.resize(target, target, false);
         }
-
-        auto computeExponential(const DSparseMatrix &kappa,
-                                const double mu,
-                                const std::int8_t sigmaKappa,
-                                const Species species,
-                                const bool inv) {
-            switch (species) {
-            case Species::PARTICLE:
-                if (inv) {
-                    return expmSym(-kappa + mu*IdMatrix<double>(kappa.rows()));
-                } else {
-                    return expmSym(kappa - mu*IdMatrix<double>(kappa.rows()));
-                }
-            case Species::HOLE:
-                if (inv) {
-                    return expmSym(-sigmaKappa*kappa - mu*IdMatrix<double>(kappa.rows()));
-                } else {
-                    return expmSym(sigmaKappa*kappa + mu*IdMatrix<double>(kappa.rows()));
-                }
-            }
-            // Strictly speaking impossible to reach but gcc complains.
-            throw std::invalid_argument("Unknown species");
-        }
     }
 
 /*
@@ -52,12 +33,7 @@ namespace isle {
     HubbardFermiMatrixExp::HubbardFermiMatrixExp(const DSparseMatrix &kappaTilde,
                                                  const double muTilde,
                                                  const std::int8_t sigmaKappa)
-        : _kappa{kappaTilde}, _mu{muTilde}, _sigmaKappa{sigmaKappa},
-          _expKappap{computeExponential(kappaTilde, muTilde, sigmaKappa, Species::PARTICLE, false)},
-          _expKappapInv{computeExponential(kappaTilde, muTilde, sigmaKappa, Species::PARTICLE, true)},
-          _expKappah{computeExponential(kappaTilde, muTilde, sigmaKappa, Species::HOLE, false)},
-          _expKappahInv{computeExponential(kappaTilde, muTilde, sigmaKappa, Species::HOLE, true)},
-          _logdetExpKappahInv{logdet(_expKappahInv)}
+        : _kappa{kappaTilde}, _mu{muTilde}, _sigmaKappa{sigmaKappa}
     {
         if (kappaTilde.rows() != kappaTilde.columns())
             throw std::invalid_argument("Hopping matrix is not square.");
@@ -65,6 +41,9 @@ namespace isle {
             getLogger("HubbardFermiMatrixExp").warning("sigmaKappa should be either -1 or +1.");
         if (sigmaKappa == +1 && !isBipartite(kappaTilde))
             getLogger("HubbardFermiMatrixExp").warning("sigmaKappa should be -1 because the lattice is not bipartite.");
+
+        _diagonalizeKappa();
+        _updateExpKappa();
     }
 
     HubbardFermiMatrixExp::HubbardFermiMatrixExp(const Lattice &lat,
@@ -94,10 +73,8 @@ namespace isle {
 
     std::complex<double> HubbardFermiMatrixExp::logdetExpKappa(const Species species,
                                                                const bool inv) const {
-        if (species == Species::HOLE && inv) {
-            return _logdetExpKappahInv;
-        }
-        throw std::runtime_error("logdetExpKappa is only implemented for holes and inv=true");
+        const auto ldinv = species == Species::PARTICLE ? _logdetExpKappapInv : _logdetExpKappahInv;
+        return inv ? ldinv : -ldinv;
     }
 
     void HubbardFermiMatrixExp::K(DSparseMatrix &k, const Species UNUSED(species)) const {
@@ -147,6 +124,55 @@ namespace isle {
         return f;
     }
 
+    void HubbardFermiMatrixExp::applyF(CDMatrix &mat,
+                                       const std::size_t tp, const CDVector &phi,
+                                       const Species species, const bool inv,
+                                       const Side side, CDMatrix &workspace) const {
+        const std::size_t NX = nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t tm1 = tp==0 ? NT-1 : tp-1;  // t' - 1
+#ifndef NDEBUG
+        if (mat.rows() != NX || mat.columns() != NX)
+            throw std::invalid_argument("Matrix in applyF does not have size nx x nx.");
+#endif
+        resizeMatrix(workspace, NX);
+
+        // the sign in the exponential of phi, see F()
+        auto const sign = ((species == Species::PARTICLE && !inv)
+                           || (species == Species::HOLE && inv))
+            ? +1.0i
+            : -1.0i;
+        const CDVector phase = blaze::exp(sign*spacevec(phi, tm1, NX));
+        const CDMatrix &ek = _complexExpKappa(species, inv);
+
+        // The product is written straight into workspace so blaze does not need
+        // a temporary to resolve aliasing. Phases are applied to mat or workspace
+        // in place, whichever is not currently read by the product.
+        if (inv) {
+            // F^{-1} = e^phi * e^kappa  (up to signs in exponents)
+            if (side == Side::LEFT) {
+                workspace = ek * mat;
+                scaleRows(workspace, phase);
+            }
+            else {
+                scaleColumns(mat, phase);
+                workspace = mat * ek;
+            }
+        }
+        else {
+            // F = e^kappa * e^phi  (up to signs in exponents)
+            if (side == Side::LEFT) {
+                scaleRows(mat, phase);
+                workspace = ek * mat;
+            }
+            else {
+                workspace = mat * ek;
+                scaleColumns(workspace, phase);
+            }
+        }
+        swap(mat, workspace);
+    }
+
     void HubbardFermiMatrixExp::M(CDSparseMatrix &m,
                                   const CDVector &phi,
                                   const Species species) const {
@@ -240,19 +266,28 @@ namespace isle {
 
 
     void HubbardFermiMatrixExp::updateKappaTilde(const SparseMatrix<double> &kappaTilde) {
+        if (kappaTilde.rows() != kappaTilde.columns())
+            throw std::invalid_argument("Hopping matrix is not square.");
         _kappa = kappaTilde;
-        _expKappap = computeExponential(kappaTilde, _mu, _sigmaKappa, Species::PARTICLE, false);
-        _expKappapInv = computeExponential(kappaTilde, _mu, _sigmaKappa, Species::PARTICLE, true);
-        _expKappah = computeExponential(kappaTilde, _mu, _sigmaKappa, Species::HOLE, false);
-        _expKappahInv = computeExponential(kappaTilde, _mu, _sigmaKappa, Species::HOLE, true);
+        _diagonalizeKappa();
+        _updateExpKappa();
+    }
+
+    void HubbardFermiMatrixExp::scaleKappaTilde(const double factor) {
+        // eigenvectors are unchanged, order of eigenvalues does not matter
+        _kappa *= factor;
+        _kappaEigenvalues *= factor;
+        _updateExpKappa();
     }
 
     void HubbardFermiMatrixExp::updateMuTilde(const double muTilde) {
         _mu = muTilde;
-        _expKappap = computeExponential(_kappa, _mu, _sigmaKappa, Species::PARTICLE, false);
-        _expKappap = computeExponential(_kappa, _mu, _sigmaKappa, Species::PARTICLE, true);
-        _expKappah = computeExponential(_kappa, _mu, _sigmaKappa, Species::HOLE, false);
-        _expKappah = computeExponential(_kappa, _mu, _sigmaKappa, Species::HOLE, true);
+        _updateExpKappa();
+    }
+
+    void HubbardFermiMatrixExp::updateSigmaKappa(const std::int8_t sigmaKappa) {
+        _sigmaKappa = sigmaKappa;
+        _updateExpKappa();
     }
 
     const SparseMatrix<double> &HubbardFermiMatrixExp::kappaTilde() const noexcept {
@@ -271,11 +306,51 @@ namespace isle {
         return _kappa.rows();
     }
 
+    const CDMatrix &HubbardFermiMatrixExp::_complexExpKappa(const Species species,
+                                                           const bool inv) const {
+        return _expKappaComplex[(species == Species::PARTICLE ? 0 : 2) + (inv ? 1 : 0)];
+    }
+
+    void HubbardFermiMatrixExp::_diagonalizeKappa() {
+        // eigenvectors are stored in the rows of _kappaEigenvectors
+        _kappaEigenvectors = _kappa;
+        blaze::syev(_kappaEigenvectors, _kappaEigenvalues, 'V', 'U');
+    }
+
+    void HubbardFermiMatrixExp::_updateExpKappa() {
+        const std::size_t NX = nx();
+        // exp(kappaSign*kappa + muSign*mu) = U^T exp(kappaSign*lambda + muSign*mu) U,
+        // returns the log of the determinant
+        DMatrix aux;
+        const auto exponential = [&](DMatrix &res, const double kappaSign, const double muSign) {
+            DVector exponent(NX);
+            for (std::size_t i = 0; i < NX; ++i)
+                exponent[i] = kappaSign*_kappaEigenvalues[i] + muSign*_mu;
+            aux = _kappaEigenvectors;
+            scaleRows(aux, DVector(blaze::exp(exponent)));
+            res = blaze::trans(_kappaEigenvectors) * aux;
+            return std::complex<double>{blaze::sum(exponent)};
+        };
+
+        const double sigmaKappa = static_cast<double>(_sigmaKappa);
+        exponential(_expKappap, +1.0, -1.0);
+        _logdetExpKappapInv = exponential(_expKappapInv, -1.0, +1.0);
+        exponential(_expKappah, +sigmaKappa, +1.0);
+        _logdetExpKappahInv = exponential(_expKappahInv, -sigmaKappa, -1.0);
+
+        _expKappaComplex[0] = _expKappap;
+        _expKappaComplex[1] = _expKappapInv;
+        _expKappaComplex[2] = _expKappah;
+        _expKappaComplex[3] = _expKappahInv;
+    }
+
 /*
  * -------------------------- QLU --------------------------
  */
 
-    HubbardFermiMatrixExp::QLU::QLU(const std::size_t nt) {
+    HubbardFermiMatrixExp::QLU::QLU(const std::size_t nx, const std::size_t nt)
+        : _storage{nx, nt + 2*(nt > 1 ? nt-1 : 0) + 2*(nt > 2 ? nt-2 : 0)} {
+
         dinv.reserve(nt);
         if (nt > 1) {
             u.reserve(nt-1);
@@ -285,6 +360,20 @@ namespace isle {
                 h.reserve(nt-2);
             }
         }
+
+        // interleave blocks of each time slice to keep them close in memory
+        std::size_t next = 0;
+        for (std::size_t i = 0; i < nt; ++i) {
+            dinv.emplace_back(_storage.block(next++));
+            if (i+1 < nt) {
+                u.emplace_back(_storage.block(next++));
+                l.emplace_back(_storage.block(next++));
+            }
+            if (i+2 < nt) {
+                v.emplace_back(_storage.block(next++));
+                h.emplace_back(_storage.block(next++));
+            }
+        }
     }
 
     bool HubbardFermiMatrixExp::QLU::isConsistent() const {
@@ -359,68 +448,70 @@ namespace isle {
         return recon;
     }
 
+    std::size_t HubbardFermiMatrixExp::QLU::nx() const noexcept {
+        return _storage.nx();
+    }
+
+    std::size_t HubbardFermiMatrixExp::QLU::nt() const noexcept {
+        return dinv.size();
+    }
+
 /*
  * -------------------------- free functions --------------------------
  */
 
     namespace {
         /// Special case LU decomposition of Q for nt == 1.
-        HubbardFermiMatrixExp::QLU nt1QLU(const HubbardFermiMatrixExp &hfm,
-                                          const CDVector &phi) {
-            HubbardFermiMatrixExp::QLU lu{1};
-
+        void nt1QLU(const HubbardFermiMatrixExp &hfm,
+                    const CDVector &phi,
+                    HubbardFermiMatrixExp::QLU &lu) {
             // construct d_0
             CDMatrix T = hfm.Tplus(0, phi);
-            lu.dinv.emplace_back(hfm.P() + T);
+            lu.dinv[0] = hfm.P() + T;
             hfm.Tminus(T, 0, phi);
             lu.dinv[0] += T;
 
             // invert d_0
             std::unique_ptr<int[]> ipiv = std::make_unique<int[]>(phi.size());
             invert(lu.dinv[0], ipiv);
-
-            return lu;
         }
 
         /// Special case LU decomposition of Q for nt == 2.
-        HubbardFermiMatrixExp::QLU nt2QLU(const HubbardFermiMatrixExp &hfm,
-                                          const CDVector &phi) {
+        void nt2QLU(const HubbardFermiMatrixExp &hfm,
+                    const CDVector &phi,
+                    HubbardFermiMatrixExp::QLU &lu) {
             const std::size_t nx = hfm.nx();
-            constexpr std::size_t nt = 2;
-            HubbardFermiMatrixExp::QLU lu{nt};
 
             const auto P = hfm.P();  // diagonal block P
             CDMatrix aux0, aux1; // T^+, T^-, and u
             std::unique_ptr<int[]> ipiv = std::make_unique<int[]>(nx);// pivot indices for inversion
 
             // d_0
-            lu.dinv.emplace_back(P);
+            lu.dinv[0] = P;
             invert(lu.dinv[0], ipiv);
 
             // l_0
             hfm.Tplus(aux0, 1, phi);
             hfm.Tminus(aux1, 1, phi);
-            lu.l.emplace_back((aux0+aux1)*lu.dinv[0]);
+            lu.l[0] = (aux0+aux1)*lu.dinv[0];
 
             // u_0
             hfm.Tplus(aux0, 0, phi);
             hfm.Tminus(aux1, 0, phi);
             aux0 += aux1;  // now aux0 = u_0
-            lu.u.emplace_back(aux0);
+            lu.u[0] = aux0;
 
             // d_1
-            lu.dinv.emplace_back(P - lu.l[0]*aux0);
+            lu.dinv[1] = P - lu.l[0]*aux0;
             invert(lu.dinv[1], ipiv);
-
-            return lu;
         }
 
         /// General case LU decomposition of Q for nt > 2.
-        HubbardFermiMatrixExp::QLU generalQLU(const HubbardFermiMatrixExp &hfm,
-                                              const CDVector &phi) {
+        void generalQLU(const HubbardFermiMatrixExp &hfm,
+                        const CDVector &phi,
+                        HubbardFermiMatrixExp::QLU &lu) {
             const std::size_t nx = hfm.nx();
             const std::size_t nt = getNt(phi, nx);
-            HubbardFermiMatrixExp::QLU lu{nt};
 
             const auto P = hfm.P();  // diagonal block P
             CDMatrix T;  // subdiagonal blocks T^+ and T^-
@@ -430,70 +521,101 @@ namespace isle {
             std::unique_ptr<int[]> ipiv = std::make_unique<int[]>(nx);
 
             // starting components of d, u, l
-            lu.dinv.emplace_back(P);
-            invert(lu.dinv.back(), ipiv);
+            lu.dinv[0] = P;
+            invert(lu.dinv[0], ipiv);
             hfm.Tminus(u, 0, phi);   // now u = lu.u[0]
-            lu.u.emplace_back(u);
+            lu.u[0] = u;
             hfm.Tplus(T, 1, phi);
-            lu.l.emplace_back(T*lu.dinv.back());
+            lu.l[0] = T*lu.dinv[0];
 
             // v, h
             hfm.Tplus(T, 0, phi);
-            lu.v.emplace_back(T);
+            lu.v[0] = T;
             hfm.Tminus(T, nt-1, phi);
-            lu.h.emplace_back(T*lu.dinv.back());
+            lu.h[0] = T*lu.dinv[0];
 
             // iterate for i in [1, nt-3], 'regular' part of d, u, l, v, h
             for (std::size_t i = 1; i < nt-2; ++i) {
                 // here, u = lu.u[i-1]
-                lu.dinv.emplace_back(P - lu.l[i-1]*u);
-                invert(lu.dinv.back(), ipiv);
+                lu.dinv[i] = P - lu.l[i-1]*u;
+                invert(lu.dinv[i], ipiv);
 
                 hfm.Tplus(T, i+1, phi);
-                lu.l.emplace_back(T*lu.dinv[i]);
-                lu.h.emplace_back(-lu.h[i-1]*u*lu.dinv[i]);
-                lu.v.emplace_back(-lu.l[i-1]*lu.v[i-1]);
+                lu.l[i] = T*lu.dinv[i];
+                lu.h[i] = -lu.h[i-1]*u*lu.dinv[i];
+                lu.v[i] = -lu.l[i-1]*lu.v[i-1];
 
                 hfm.Tminus(u, i, phi);
-                lu.u.emplace_back(u);  // now u = lu.u[i]
+                lu.u[i] = u;  // now u = lu.u[i]
             }
             // from now on u is lu.u[nt-3]
 
             // additional 'regular' step for d
-            lu.dinv.emplace_back(P - lu.l[nt-3]*u);
-            invert(lu.dinv.back(), ipiv);
+            lu.dinv[nt-2] = P - lu.l[nt-3]*u;
+            invert(lu.dinv[nt-2], ipiv);
 
             // final components of u, l
             hfm.Tminus(T, nt-2, phi);
-            lu.u.emplace_back(T - lu.l[nt-3]*lu.v[nt-3]);
+            lu.u[nt-2] = T - lu.l[nt-3]*lu.v[nt-3];
             hfm.Tplus(T, nt-1, phi);
-            lu.l.emplace_back((T - lu.h[nt-3]*u)*lu.dinv[nt-2]);
+            lu.l[nt-2] = (T - lu.h[nt-3]*u)*lu.dinv[nt-2];
 
             // final component of d
-            lu.dinv.emplace_back(P - lu.l[nt-2]*lu.u[nt-2]);
+            lu.dinv[nt-1] = P - lu.l[nt-2]*lu.u[nt-2];
             for (std::size_t i = 0; i < nt-2; ++i)
                 lu.dinv[nt-1] -= lu.h[i]*lu.v[i];
-            invert(lu.dinv.back(), ipiv);
-
-            return lu;
+            invert(lu.dinv[nt-1], ipiv);
         }
     }
 
-    HubbardFermiMatrixExp::QLU getQLU(const HubbardFermiMatrixExp &hfm,
-                                   const CDVector &phi) {
-        switch (phi.size()/hfm.nx()) {
+    void getQLU(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                HubbardFermiMatrixExp::QLU &into) {
+        const std::size_t nx = hfm.nx();
+        const std::size_t nt = getNt(phi, nx);
+        if (into.nx() != nx || into.nt() != nt)
+            into = HubbardFermiMatrixExp::QLU{nx, nt};
+
+        switch (nt) {
         case 1:
-            return nt1QLU(hfm, phi);
+            nt1QLU(hfm, phi, into);
+            break;
         case 2:
-            return nt2QLU(hfm, phi);
+            nt2QLU(hfm, phi, into);
+            break;
         default:
-            return generalQLU(hfm, phi);
+            generalQLU(hfm, phi, into);
         }
     }
 
+    HubbardFermiMatrixExp::QLU getQLU(const HubbardFermiMatrixExp &hfm,
+                                   const CDVector &phi) {
+        HubbardFermiMatrixExp::QLU lu;
+        getQLU(hfm, phi, lu);
+        return lu;
+    }
+
+    CyclicReduction getQCR(const HubbardFermiMatrixExp &hfm, const CDVector &phi) {
+        const std::size_t nt = getNt(phi, hfm.nx());
+        std::vector<CDMatrix> diag, lower, upper;
+        diag.reserve(nt);
+        lower.reserve(nt);
+        upper.reserve(nt);
+
+        const CDMatrix P = hfm.P();
+        for (std::size_t t = 0; t < nt; ++t) {
+            diag.emplace_back(P);
+            lower.emplace_back(hfm.Tplus(t, phi));
+            upper.emplace_back(hfm.Tminus(t, phi));
+        }
+        return CyclicReduction(std::move(diag), std::move(lower), std::move(upper));
+    }
+
     Vector<std::complex<double>> solveQ(const HubbardFermiMatrixExp &hfm,
                                         const CDVector &phi,
-                                        const Vector<std::complex<double>> &rhs) {
+                                        const Vector<std::complex<double>> &rhs,
+                                        const QFactorization algorithm) {
+        if (algorithm == QFactorization::CYCLIC_REDUCTION)
+            return getQCR(hfm, phi).solve(rhs);
         return solveQ(getQLU(hfm, phi), rhs);
     }
 
@@ -537,8 +659,74 @@ namespace isle {
         return x;
     }
 
+    namespace {
+        /// Solve Q x = b for rows [first, first+n) of rhss, x has the same shape as rhss.
+        void solveQRows(const HubbardFermiMatrixExp::QLU &lu, const CDMatrix &rhss,
+                        CDMatrix &x, const std::size_t first, const std::size_t n) {
+            const std::size_t nt = lu.dinv.size();
+            const std::size_t nx = lu.dinv[0].rows();
+            // view on time slice t of the selected right hand sides
+            const auto slice = [first, n, nx](auto &mat, const std::size_t t) {
+                return blaze::submatrix(mat, first, t*nx, n, nx);
+            };
+
+            // solve L*y = rhs, store y in x
+            // rows of rhs are transposed vectors, hence multiply transposed blocks from the right
+            for (std::size_t t = 0; t < nt; ++t)
+                slice(x, t) = slice(rhss, t);
+            for (std::size_t i = 1; i < nt; ++i)
+                slice(x, i) -= slice(x, i-1)*blaze::trans(lu.l[i-1]);
+            for (std::size_t j = 0; j+2 < nt; ++j)
+                slice(x, nt-1) -= slice(x, j)*blaze::trans(lu.h[j]);
+
+            // solve U*x = y in place
+            CDMatrix aux = slice(x, nt-1);
+            slice(x, nt-1) = aux*blaze::trans(lu.dinv[nt-1]);
+            if (nt > 1) {
+                aux = slice(x, nt-2) - slice(x, nt-1)*blaze::trans(lu.u[nt-2]);
+                slice(x, nt-2) = aux*blaze::trans(lu.dinv[nt-2]);
+                // iterate i in [nt-3, 0]
+                for (std::size_t i = nt-3; i != static_cast<std::size_t>(-1); --i) {
+                    aux = slice(x, i) - slice(x, i+1)*blaze::trans(lu.u[i])
+                        - slice(x, nt-1)*blaze::trans(lu.v[i]);
+                    slice(x, i) = aux*blaze::trans(lu.dinv[i]);
+                }
+            }
+        }
+    }
+
+    CDMatrix solveQ(const HubbardFermiMatrixExp::QLU &lu, const CDMatrix &rhss,
+                    const std::size_t nblocks) {
+        const std::size_t nt = lu.dinv.size();
+#ifndef NDEBUG
+        if (!lu.isConsistent())
+            throw std::runtime_error("Components of LU not initialized properly");
+        if (rhss.columns() != lu.dinv[0].rows()*nt)
+            throw std::runtime_error("Right hand sides do not have correct size (spacetime vectors)");
+#endif
+        if (nblocks == 0)
+            throw std::invalid_argument("Number of blocks of right hand sides must be positive");
+
+        const std::size_t nrhs = rhss.rows();
+        CDMatrix x(nrhs, rhss.columns());
+        const std::size_t blockSize = (nrhs + nblocks - 1) / nblocks;
+        if (nblocks == 1 || blockSize == 0)
+            solveQRows(lu, rhss, x, 0, nrhs);
+        else {
+            // blocks write to disjoint rows of x
+            parallelFor((nrhs + blockSize - 1) / blockSize, [&](const std::size_t b) {
+                const std::size_t first = b*blockSize;
+                solveQRows(lu, rhss, x, first, std::min(blockSize, nrhs-first));
+            });
+        }
+        return x;
+    }
+
     std::complex<double> logdetQ(const HubbardFermiMatrixExp &hfm,
-                                 const CDVector &phi) {
+                                 const CDVector &phi,
+                                 const QFactorization algorithm) {
+        if (algorithm == QFactorization::CYCLIC_REDUCTION)
+            return getQCR(hfm, phi).logdet();
         auto lu = getQLU(hfm, phi);
         return ilogdetQ(lu);
     }
@@ -550,9 +738,12 @@ namespace isle {
 #endif
 
         std::complex<double> ldet;
-        // calculate logdet of diagonal blocks
-        for (const auto &dinv : lu.dinv)
-            ldet -= logdet(dinv);
+        // calculate logdet of diagonal blocks, copy into aux to not overwrite lu
+        CDMatrix aux;
+        for (const auto &dinv : lu.dinv) {
+            aux = dinv;
+            ldet -= ilogdet(aux);
+        }
         return toFirstLogBranch(ldet);
     }
 
@@ -569,6 +760,65 @@ namespace isle {
         return toFirstLogBranch(ldet);
     }
 
+    void selectedInverseQ(const HubbardFermiMatrixExp::QLU &lu,
+                          std::vector<CDMatrix> &upper,
+                          std::vector<CDMatrix> &lower) {
+#ifndef NDEBUG
+        if (!lu.isConsistent())
+            throw std::runtime_error("Components of LU not initialized properly");
+#endif
+
+        const std::size_t nt = lu.dinv.size();
+        upper.resize(nt);
+        lower.resize(nt);
+
+        if (nt == 1) {
+            upper[0] = lu.dinv[0];
+            lower[0] = lu.dinv[0];
+            return;
+        }
+
+        // last block row (row[j] = Qinv_{nt-1, j}) and column (col[i] = Qinv_{i, nt-1})
+        std::vector<CDMatrix> row(nt), col(nt);
+        row[nt-1] = lu.dinv[nt-1];
+        col[nt-1] = row[nt-1];
+        CDMatrix aux;
+        // iterate j in [nt-2, 0]
+        for (std::size_t j = nt-1; j-- > 0; ) {
+            row[j] = -row[j+1]*lu.l[j];
+            aux = lu.u[j]*col[j+1];
+            if (j < nt-2) {
+                row[j] -= row[nt-1]*lu.h[j];
+                aux += lu.v[j]*col[nt-1];
+            }
+            col[j] = -lu.dinv[j]*aux;
+        }
+
+        // sweep along the diagonal, diag = Qinv_{i+1, i+1}
+        CDMatrix diag = row[nt-1];
+        // iterate i in [nt-2, 0]
+        for (std::size_t i = nt-1; i-- > 0; ) {
+            lower[i] = -diag*lu.l[i];
+            aux = lu.u[i]*diag;
+            if (i < nt-2) {
+                lower[i] -= col[i+1]*lu.h[i];
+                aux += lu.v[i]*row[i+1];
+            }
+            upper[i] = -lu.dinv[i]*aux;
+
+            if (i > 0) {  // diagonal block is not needed for i == 0
+                aux = lu.u[i]*lower[i];
+                if (i < nt-2)
+                    aux += lu.v[i]*row[i];
+                diag = lu.dinv[i] - lu.dinv[i]*aux;
+            }
+        }
+
+        // blocks across the boundary
+        upper[nt-1] = std::move(row[0]);
+        lower[nt-1] = std::move(col[0]);
+    }
+
     namespace {
         // Use version log(det(1+hat{A})).
         std::complex<double> logdetM_p(const HubbardFermiMatrixExp &hfm,
@@ -578,18 +828,35 @@ namespace isle {
             const auto species = Species::PARTICLE;
 
             // first factor F
-            CDMatrix f;
             CDMatrix B = hfm.F(0, phi, species, false);
             // other factors
+            CDMatrix workspace;
             for (std::size_t t = 1; t < NT; ++t) {
-                hfm.F(f, t, phi, species, false);
-                B = f*B;
+                hfm.applyF(B, t, phi, species, false, Side::LEFT, workspace);
             }
 
             B += IdMatrix<std::complex<double>>(NX);
             return toFirstLogBranch(ilogdet(B));
         }
 
+        // Same as logdetM_p but build hat{A} as a StabilizedProduct.
+        std::complex<double> logdetM_pStabilized(const HubbardFermiMatrixExp &hfm,
+                                                 const CDVector &phi,
+                                                 const std::size_t interval) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+            const auto species = Species::PARTICLE;
+
+            StabilizedProduct B{NX, interval};
+            CDMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, species, false);
+                B.leftMultiply(f);
+            }
+
+            return B.logdetOnePlus();
+        }
+
         // Use version -i Phi - N_t log(det(e^{-sigmaKappa*kappa-mu})) + log(det(1+hat{A}^{-1})).
         std::complex<double> logdetM_h(const HubbardFermiMatrixExp &hfm,
                                        const CDVector &phi) {
@@ -597,11 +864,10 @@ namespace isle {
             const auto NT = getNt(phi, NX);
 
             // build product of F^{-1}
-            auto f = hfm.F(0, phi, Species::HOLE, true);
-            CDMatrix aux = f;  // the matrix under the determinant
+            CDMatrix aux = hfm.F(0, phi, Species::HOLE, true);  // the matrix under the determinant
+            CDMatrix workspace;
             for (std::size_t t = 1; t < NT; ++t) {
-                hfm.F(f, t, phi, Species::HOLE, true);
-                aux = aux*f;
+                hfm.applyF(aux, t, phi, Species::HOLE, true, Side::RIGHT, workspace);
             }
             aux += IdMatrix<std::complex<double>>(NX);
 
@@ -610,20 +876,203 @@ namespace isle {
                                     - 1.0i*blaze::sum(phi)
                                     + ilogdet(aux));
         }
+
+        // Same as logdetM_h but build hat{A}^{-1} as a StabilizedProduct.
+        std::complex<double> logdetM_hStabilized(const HubbardFermiMatrixExp &hfm,
+                                                 const CDVector &phi,
+                                                 const std::size_t interval) {
+            const auto NX = hfm.nx();
+            const auto NT = getNt(phi, NX);
+
+            // F^{-1} are multiplied from the right, so build the transpose of hat{A}^{-1}
+            StabilizedProduct aux{NX, interval};
+            CDMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, Species::HOLE, true);
+                aux.leftMultiply(blaze::trans(f));
+            }
+
+            return toFirstLogBranch(-static_cast<double>(NT)*hfm.logdetExpKappa(Species::HOLE, true)
+                                    - 1.0i*blaze::sum(phi)
+                                    + aux.logdetOnePlus());
+        }
     }
 
     std::complex<double> logdetM(const HubbardFermiMatrixExp &hfm,
-                                 const CDVector &phi, const Species species) {
+                                 const CDVector &phi, const Species species,
+                                 const std::size_t stabilizationInterval) {
         switch (species) {
         case Species::PARTICLE:
-            return logdetM_p(hfm, phi);
+            return stabilizationInterval == 0
+                ? logdetM_p(hfm, phi)
+                : logdetM_pStabilized(hfm, phi, stabilizationInterval);
         case Species::HOLE:
-            return logdetM_h(hfm, phi);
+            return stabilizationInterval == 0
+                ? logdetM_h(hfm, phi)
+                : logdetM_hStabilized(hfm, phi, stabilizationInterval);
         }
         // Strictly speaking impossible to reach but gcc complains.
         throw std::invalid_argument("Unknown species");
     }
 
+    CDVector logdetMBatch(const HubbardFermiMatrixExp &hfm, const CDMatrix &phis,
+                          const Species species, const std::size_t stabilizationInterval) {
+        CDVector res(phis.rows());
+        parallelFor(phis.rows(), [&](const std::size_t i) {
+            const CDVector phi = blaze::trans(blaze::row(phis, i));
+            res[i] = logdetM(hfm, phi, species, stabilizationInterval);
+        });
+        return res;
+    }
+
+    namespace {
+        /// log(exp(a) + exp(b)) for complex numbers, real parts may be -inf.
+        std::complex<double> logAddExp(std::complex<double> a, std::complex<double> b) {
+            if (std::isinf(a.real()) && a.real() < 0)
+                return b;
+            if (std::isinf(b.real()) && b.real() < 0)
+                return a;
+            if (a.real() < b.real())
+                std::swap(a, b);
+            return a + std::log(1.0 + std::exp(b - a));
+        }
+
+        /// log(1 + exp(z)) without overflow.
+        std::complex<double> logOnePlusExp(const std::complex<double> z) {
+            return z.real() > 0
+                ? z + std::log(1.0 + std::exp(-z))
+                : std::log(1.0 + std::exp(z));
+        }
+
+        /// Logarithms of the elementary symmetric polynomials e_0, ..., e_n of exp(logValues).
+        std::vector<std::complex<double>> logElementarySymmetric(const CDVector &logValues) {
+            const std::size_t n = logValues.size();
+            std::vector<std::complex<double>> res(n+1, -std::numeric_limits<double>::infinity());
+            res[0] = 0;
+            // add one value at a time, e_k <- e_k + x_j e_{k-1}
+            for (std::size_t j = 0; j < n; ++j)
+                for (std::size_t k = j+1; k > 0; --k)
+                    res[k] = logAddExp(res[k], logValues[j] + res[k-1]);
+            return res;
+        }
+
+        /// Logarithms of the eigenvalues of a StabilizedProduct sorted by decreasing magnitude.
+        /**
+         * UDV has the same eigenvalues as DVU, grade it by sorting D in decreasing order.
+         * Only the large eigenvalues are accurate, the absolute errors of the QR-algorithm
+         * are of the order of the largest scale which swamps the small eigenvalues.
+         */
+        std::vector<std::complex<double>> gradedLogEigenvalues(const StabilizedProduct &A) {
+            const DVector &d = A.D();
+            const std::size_t n = d.size();
+            const CDMatrix vu = A.V() * A.U();
+            std::vector<std::size_t> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(),
+                      [&d](const std::size_t i, const std::size_t j) { return d[i] > d[j]; });
+            CDMatrix graded(n, n);
+            for (std::size_t i = 0; i < n; ++i)
+                for (std::size_t j = 0; j < n; ++j)
+                    graded(i, j) = d[order[i]] * vu(order[i], order[j]);
+
+            CDVector eigenvalues;
+            blaze::geev(graded, eigenvalues);
+            std::vector<std::complex<double>> res(n);
+            std::transform(eigenvalues.begin(), eigenvalues.end(), res.begin(),
+                           [](const std::complex<double> &x) { return std::log(x); });
+            std::sort(res.begin(), res.end(),
+                      [](const std::complex<double> &a, const std::complex<double> &b) {
+                          return a.real() > b.real();
+                      });
+            return res;
+        }
+    }
+
+    CDVector logTransferMatrixEigenvalues(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                                          const Species species,
+                                          const std::size_t stabilizationInterval) {
+        const auto NX = hfm.nx();
+        const auto NT = getNt(phi, NX);
+
+        CDVector res(NX);
+        if (stabilizationInterval == 0) {
+            CDMatrix A = hfm.F(0, phi, species, false);
+            CDMatrix workspace;
+            for (std::size_t t = 1; t < NT; ++t) {
+                hfm.applyF(A, t, phi, species, false, Side::LEFT, workspace);
+            }
+            CDVector eigenvalues;
+            blaze::geev(A, eigenvalues);
+            std::transform(eigenvalues.begin(), eigenvalues.end(), res.begin(),
+                           [](const std::complex<double> &x) { return std::log(x); });
+        }
+        else {
+            // A = F_{NT-1} ... F_0 and A^{-1} = F_0^{-1} ... F_{NT-1}^{-1}
+            StabilizedProduct A{NX, stabilizationInterval};
+            StabilizedProduct Ainv{NX, stabilizationInterval};
+            CDMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, species, false);
+                A.leftMultiply(f);
+            }
+            for (std::size_t t = NT; t-- > 0; ) {
+                hfm.F(f, t, phi, species, true);
+                Ainv.leftMultiply(f);
+            }
+
+            // take |lambda| >= 1 from A and the rest from the large eigenvalues of A^{-1}
+            const auto large = gradedLogEigenvalues(A);
+            const auto small = gradedLogEigenvalues(Ainv);
+            const std::size_t nlarge = static_cast<std::size_t>(
+                std::count_if(large.begin(), large.end(),
+                              [](const std::complex<double> &x) { return x.real() >= 0; }));
+            for (std::size_t i = 0; i < nlarge; ++i)
+                res[i] = large[i];
+            for (std::size_t i = 0; i < NX - nlarge; ++i)
+                res[NX-1-i] = -small[i];
+        }
+
+        // A = e^{-+NT mu} A_0
+        const double shift = (species == Species::PARTICLE ? 1.0 : -1.0)
+            * static_cast<double>(NT) * hfm.muTilde();
+        for (auto &logLambda : res)
+            logLambda += shift;
+        return res;
+    }
+
+    CDVector logdetMScan(const CDVector &logEigenvalues, const std::size_t nt,
+                         const Species species, const DVector &muTildes) {
+        const double sign = species == Species::PARTICLE ? -1.0 : 1.0;
+        CDVector res(muTildes.size());
+        for (std::size_t m = 0; m < muTildes.size(); ++m) {
+            const double logFugacity = sign * static_cast<double>(nt) * muTildes[m];
+            std::complex<double> ld = 0;
+            for (const auto &logLambda : logEigenvalues)
+                ld += logOnePlusExp(logLambda + logFugacity);
+            res[m] = toFirstLogBranch(ld);
+        }
+        return res;
+    }
+
+    CDVector logCanonicalProjections(const CDVector &logEigenvaluesParticles,
+                                     const CDVector &logEigenvaluesHoles) {
+        const std::size_t NX = logEigenvaluesParticles.size();
+        if (logEigenvaluesHoles.size() != NX)
+            throw std::invalid_argument("Eigenvalues of particles and holes have different sizes.");
+
+        const auto ep = logElementarySymmetric(logEigenvaluesParticles);
+        const auto eh = logElementarySymmetric(logEigenvaluesHoles);
+
+        // Z_q = sum_{np - nh = q} e_np(particles) e_nh(holes)
+        CDVector res(2*NX+1, -std::numeric_limits<double>::infinity());
+        for (std::size_t np = 0; np <= NX; ++np)
+            for (std::size_t nh = 0; nh <= NX; ++nh)
+                res[np + NX - nh] = logAddExp(res[np + NX - nh], ep[np] + eh[nh]);
+        for (auto &logZ : res)
+            logZ = toFirstLogBranch(logZ);
+        return res;
+    }
+
     namespace {
 #ifndef NDEBUG
         void verifyResultOfSolveM(const HubbardFermiMatrixExp &hfm,
@@ -643,7 +1092,8 @@ namespace isle {
     }
 
     CDMatrix solveM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
-                    const Species species, const CDMatrix &rhss) {
+                    const Species species, const CDMatrix &rhss,
+                    const std::size_t stabilizationInterval) {
         const std::size_t NX = hfm.nx();
         const std::size_t NT = getNt(phi, NX);
         const std::size_t NRHS = rhss.rows();
@@ -654,8 +1104,10 @@ namespace isle {
         std::vector<CDMatrix> partialAinv;
         partialAinv.reserve(NT);
         partialAinv.emplace_back(hfm.F(0, phi, species, true));
+        CDMatrix workspace;
         for (std::size_t t = 1; t < NT; ++t) {
-            partialAinv.emplace_back(partialAinv[t-1]*hfm.F(t, phi, species, true));
+            partialAinv.emplace_back(partialAinv[t-1]);
+            hfm.applyF(partialAinv.back(), t, phi, species, true, Side::RIGHT, workspace);
         }
 
         // calculate all z's and store in res
@@ -671,14 +1123,26 @@ namespace isle {
         for (std::size_t t = 0; t < NT-1; ++t) {
             blaze::getrf(partialAinv[t], &ipiv[t*NX]);
         }
-        // NT-1 is special
-        partialAinv[NT-1] += IdMatrix<std::complex<double>>(NX);
-        blaze::getrf(partialAinv[NT-1], &ipiv[(NT-1)*NX]);
 
         // solve for x
         CDMatrix matLast = blaze::submatrix(res, 0, (NT-1)*NX, NRHS, NX);
-        // transpose because LAPACK wants column-major layout
-        blaze::getrs(partialAinv[NT-1], matLast, 'T', &ipiv[(NT-1)*NX]);
+        if (stabilizationInterval == 0) {
+            // NT-1 is special
+            partialAinv[NT-1] += IdMatrix<std::complex<double>>(NX);
+            blaze::getrf(partialAinv[NT-1], &ipiv[(NT-1)*NX]);
+            // transpose because LAPACK wants column-major layout
+            blaze::getrs(partialAinv[NT-1], matLast, 'T', &ipiv[(NT-1)*NX]);
+        }
+        else {
+            // build transpose of A^{-1} such that invOnePlus gives (1+A^{-1})^{-T} directly
+            StabilizedProduct Ainv{NX, stabilizationInterval};
+            CDMatrix f;
+            for (std::size_t t = 0; t < NT; ++t) {
+                hfm.F(f, t, phi, species, true);
+                Ainv.leftMultiply(blaze::trans(f));
+            }
+            matLast = matLast * Ainv.invOnePlus();
+        }
         blaze::submatrix(res, 0, (NT-1)*NX, NRHS, NX) = matLast;
         for (std::size_t t = 0; t < NT-1; ++t) {
             CDMatrix mat = blaze::submatrix(res, 0, t*NX, NRHS, NX) - matLast;
@@ -693,4 +1157,154 @@ namespace isle {
         return res;
     }
 
+    void applyM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                const Species species, const CDVector &in, CDVector &out,
+                const bool dagger) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        if (in.size() != NX*NT)
+            throw std::invalid_argument("Input vector of applyM does not have size nx*nt.");
+        out.resize(NX*NT, false);
+
+        // the sign in the exponential of phi, see F()
+        const auto phaseSign = species == Species::PARTICLE ? +1.0i : -1.0i;
+        // e^kappa is real symmetric, so it is its own adjoint
+        const DMatrix &ek = hfm.expKappa(species, false);
+
+        for (std::size_t t = 0; t < NT; ++t) {
+            if (!dagger) {
+                // out_t = in_t - e^kappa e^phi_{t-1} in_{t-1}, sign flipped for t=0
+                const std::size_t tm1 = t == 0 ? NT-1 : t-1;
+                const double sign = t == 0 ? -1.0 : 1.0;
+                const CDVector phased = blaze::exp(phaseSign*spacevec(phi, tm1, NX))
+                    * spacevec(in, tm1, NX);
+                spacevec(out, t, NX) = spacevec(in, t, NX) - sign*(ek*phased);
+            }
+            else {
+                // out_t = in_t - (e^phi_t)^* e^kappa in_{t+1}, sign flipped for t=NT-1
+                const std::size_t tp1 = t == NT-1 ? 0 : t+1;
+                const double sign = t == NT-1 ? -1.0 : 1.0;
+                spacevec(out, t, NX) = spacevec(in, t, NX)
+                    - sign*blaze::conj(blaze::exp(phaseSign*spacevec(phi, t, NX)))
+                    * (ek*spacevec(in, tp1, NX));
+            }
+        }
+    }
+
+    void applyM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                const Species species, const CDMatrix &in, CDMatrix &out,
+                const bool dagger) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+        const std::size_t NV = in.rows();
+        if (in.columns() != NX*NT)
+            throw std::invalid_argument("Input vectors of applyM do not have size nx*nt.");
+        out.resize(NV, NX*NT, false);
+
+        // the sign in the exponential of phi, see F()
+        const auto phaseSign = species == Species::PARTICLE ? +1.0i : -1.0i;
+        // complex copy such that products go through BLAS, e^kappa is symmetric
+        const CDMatrix ek = hfm.expKappa(species, false);
+
+        // vectors are rows, so all matrices are applied from the right and transposed
+        CDMatrix aux(NV, NX);
+        for (std::size_t t = 0; t < NT; ++t) {
+            auto outt = blaze::submatrix(out, 0, t*NX, NV, NX);
+            if (!dagger) {
+                const std::size_t tm1 = t == 0 ? NT-1 : t-1;
+                const double sign = t == 0 ? -1.0 : 1.0;
+                aux = blaze::submatrix(in, 0, tm1*NX, NV, NX);
+                scaleColumns(aux, CDVector(blaze::exp(phaseSign*spacevec(phi, tm1, NX))));
+                outt = blaze::submatrix(in, 0, t*NX, NV, NX) - sign*aux*ek;
+            }
+            else {
+                const std::size_t tp1 = t == NT-1 ? 0 : t+1;
+                const double sign = t == NT-1 ? -1.0 : 1.0;
+                aux = blaze::submatrix(in, 0, tp1*NX, NV, NX)*ek;
+                scaleColumns(aux, CDVector(blaze::conj(blaze::exp(phaseSign*spacevec(phi, t, NX)))));
+                outt = blaze::submatrix(in, 0, t*NX, NV, NX) - sign*aux;
+            }
+        }
+    }
+
+    void applyQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                const CDVector &in, CDVector &out, const bool dagger) {
+        // Q = M_p M_h^T and M^T x = (M^dagger x^*)^*
+        CDVector aux;
+        if (!dagger) {
+            applyM(hfm, phi, Species::HOLE, CDVector(blaze::conj(in)), aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::PARTICLE, aux, out, false);
+        }
+        else {
+            applyM(hfm, phi, Species::PARTICLE, in, aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::HOLE, aux, out, false);
+            out = blaze::conj(out);
+        }
+    }
+
+    void applyQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                const CDMatrix &in, CDMatrix &out, const bool dagger) {
+        // Q = M_p M_h^T and M^T x = (M^dagger x^*)^*
+        CDMatrix aux;
+        if (!dagger) {
+            applyM(hfm, phi, Species::HOLE, CDMatrix(blaze::conj(in)), aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::PARTICLE, aux, out, false);
+        }
+        else {
+            applyM(hfm, phi, Species::PARTICLE, in, aux, true);
+            aux = blaze::conj(aux);
+            applyM(hfm, phi, Species::HOLE, aux, out, false);
+            out = blaze::conj(out);
+        }
+    }
+
+    void allToAllPropagator(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                            const Species species, std::complex<double> *const out) {
+        const std::size_t NX = hfm.nx();
+        const std::size_t NT = getNt(phi, NX);
+
+        // view on out[x, t, y, t'] for fixed t, columns are (y, t') with t' running fastest
+        using View = blaze::CustomMatrix<std::complex<double>, blaze::unaligned, blaze::unpadded>;
+        const auto timeSlice = [out, NX, NT](const std::size_t t) {
+            return View(out + t*NX*NT, NX, NX*NT, NT*NX*NT);
+        };
+
+        // first block row w/o (1 + B_0 B_{NT-1} ... B_1)^{-1}, columns in the same order as out
+        CDMatrix source(NX, NX*NT);
+        {
+            // R = B_0 B_{NT-1} ... B_{s+1} with B_t = F_t
+            CDMatrix R = hfm.F(0, phi, species, false);
+            CDMatrix workspace;
+            for (std::size_t s = NT-1; s > 0; --s) {
+                for (std::size_t x = 0; x < NX; ++x)
+                    for (std::size_t y = 0; y < NX; ++y)
+                        source(x, y*NT+s) = -R(x, y);
+                hfm.applyF(R, s, phi, species, false, Side::RIGHT, workspace);
+            }
+            for (std::size_t x = 0; x < NX; ++x)
+                for (std::size_t y = 0; y < NX; ++y)
+                    source(x, y*NT) = (x == y ? 1.0 : 0.0);
+
+            // R = B_0 B_{NT-1} ... B_1 at this point
+            R += IdMatrix<std::complex<double>>(NX);
+            auto ipiv = std::make_unique<int[]>(NX);
+            invert(R, ipiv);
+            timeSlice(0) = R*source;
+        }
+
+        // propagate forward in time
+        CDMatrix aux, workspace;
+        for (std::size_t t = 1; t < NT; ++t) {
+            aux = timeSlice(t-1);
+            hfm.applyF(aux, t, phi, species, false, Side::LEFT, workspace);
+            auto slice = timeSlice(t);
+            slice = aux;
+            for (std::size_t x = 0; x < NX; ++x)
+                slice(x, x*NT+t) += 1.0;
+        }
+    }
+
 }  // namespace isle
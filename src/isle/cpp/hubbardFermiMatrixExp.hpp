@@ -5,12 +5,15 @@
 #ifndef HUBBARD_FERMI_MATRIX_EXP_HPP
 #define HUBBARD_FERMI_MATRIX_EXP_HPP
 
+#include <array>
 #include <vector>
 #include <functional>
 
 #include "math.hpp"
 #include "lattice.hpp"
 #include "cache.hpp"
+#include "blockStorage.hpp"
+#include "cyclicReduction.hpp"
 #include "species.hpp"
 
 namespace isle {
@@ -28,6 +31,10 @@ namespace isle {
      * each block is to be constructed when needed which might be expensive.
      * The only exception is \f$e^{\tilde{\kappa}-\tilde{\mu}}\f$ which is stored for particles and holes, both
      * as the matrices themselves and their inverses.
+     * All four exponentials are computed from a single eigendecomposition of
+     * \f$\tilde{\kappa}\f$ which is kept around such that changing \f$\tilde{\mu}\f$,
+     * \f$\sigma_\tilde{\kappa}\f$, or the overall scale of \f$\tilde{\kappa}\f$
+     * only rescales its eigenvalues.
      *
      * The result of an LU-decomposition of \f$\hat{Q}\f$ is stored in HubbardFermiMatrixExp::LU
      * to save memory and give easier access to the components compared to a `blaze::Matrix`.
@@ -36,10 +43,13 @@ namespace isle {
      * Free functions operating on `%HubbardFermimatrixExp`:
      *  - std::complex<double> logdetM(const HubbardFermiMatrixExp &hfm, const CDVector &phi, Species species)
      *  - HubbardFermiMatrixExp::LU getQLU(const HubbardFermiMatrixExp &hfm, const CDVector &phi)
-     *  - std::complex<double> logdetQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi)
+     *  - CyclicReduction getQCR(const HubbardFermiMatrixExp &hfm, const CDVector &phi)
+     *  - std::complex<double> logdetQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi, QFactorization algorithm)
      *  - std::complex<double> logdetQ(const HubbardFermiMatrixExp::QLU &lu)
-     *  - Vector<std::complex<double>> solveQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi, const Vector<std::complex<double>> &rhs);
+     *  - Vector<std::complex<double>> solveQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi, const Vector<std::complex<double>> &rhs, QFactorization algorithm);
      *  - Vector<std::complex<double>> solveQ(const HubbardFermiMatrixExp::QLU &lu, const Vector<std::complex<double>> &rhs);
+     *  - CDMatrix solveQ(const HubbardFermiMatrixExp::QLU &lu, const CDMatrix &rhss, std::size_t nblocks)
+     *  - void selectedInverseQ(const HubbardFermiMatrixExp::QLU &lu, std::vector<CDMatrix> &upper, std::vector<CDMatrix> &lower)
      *
      * See HubbardFermiMatrixDia for an alternative discretization.
      */
@@ -73,6 +83,9 @@ namespace isle {
         const DMatrix &expKappa(const Species species, const bool inv) const;
 
         /// Return log(det(expKappa(species, inv)).
+        /**
+         * Computed exactly from the eigenvalues of the hopping matrix.
+         */
         std::complex<double> logdetExpKappa(const Species species, const bool inv) const;
 
         /// Store the diagonal block K of matrix M in the parameter.
@@ -123,6 +136,28 @@ namespace isle {
         CDMatrix F(std::size_t tp, const CDVector &phi,
                    Species species, bool inv=false) const;
 
+        /// Multiply an off-diagonal block F of matrix M onto a matrix in place.
+        /**
+         * Computes `mat = F*mat` or `mat = mat*F` without constructing F.
+         * The phases \f$e^{\pm i\phi}\f$ are applied as an in-place scaling of the rows
+         * or columns of whichever operand is not the output of the multiplication with
+         * \f$e^{\pm\tilde{\kappa}}\f$.
+         * The product is written into `workspace` which is then swapped with `mat`.
+         * Re-using the same workspace in a loop over time slices thus avoids all
+         * allocations and temporaries.
+         *
+         * \param mat Matrix to multiply F onto, must be of size `nx x nx`.
+         * \param tp Temporal row index t'.
+         * \param phi Auxilliary field.
+         * \param species Select whether to apply F for particles or holes.
+         * \param inv If `true` applies the inverse of F.
+         * \param side Select whether to multiply F from the left or right.
+         * \param workspace Buffer for the product, is resized to `nx x nx` if need be.
+         *                  Holds the old content of `mat` afterwards.
+         */
+        void applyF(CDMatrix &mat, std::size_t tp, const CDVector &phi,
+                    Species species, bool inv, Side side, CDMatrix &workspace) const;
+
         /// Store the matrix \f$M\f$ in the parameter.
         /**
          * \param m Any old content is erased and the matrix is
@@ -197,12 +232,31 @@ namespace isle {
          */
         CDSparseMatrix Q(const CDVector &phi) const;
 
-        /// Update the hopping matrix
+        /// Update the hopping matrix.
+        /**
+         * This is the only update which needs to re-diagonalize the hopping matrix.
+         * \throws std::invalid_argument if `kappaTilde` is not square.
+         */
         void updateKappaTilde(const DSparseMatrix &kappaTilde);
 
+        /// Multiply the hopping matrix by a factor, e.g. to change beta at fixed nt.
+        /**
+         * Re-uses the eigenvectors of the hopping matrix and only rescales its eigenvalues.
+         */
+        void scaleKappaTilde(double factor);
+
         /// Update the chemical potential.
+        /**
+         * Re-uses the eigendecomposition of the hopping matrix.
+         */
         void updateMuTilde(double muTilde);
 
+        /// Update the sign of the hopping matrix for holes.
+        /**
+         * Re-uses the eigendecomposition of the hopping matrix.
+         */
+        void updateSigmaKappa(std::int8_t sigmaKappa);
+
         /// Return hopping matrix.
         const DSparseMatrix &kappaTilde() const noexcept;
 
@@ -231,22 +285,49 @@ namespace isle {
          *
          * Use HubbardFermiMatrixExp::QLU::isConsistent() to check whether those conditions
          * are satisfied.
+         *
+         * All blocks are views into a single contiguous BlockStorage.
+         * Copying is therefore disabled; pass an existing instance to
+         * `getQLU(hfm, phi, into)` to reuse its memory for a new configuration.
          */
         struct QLU {
-            std::vector<CDMatrix> dinv; ///< \f$d^{-1}\f$, see definition of U.
-            std::vector<CDMatrix> u; ///< See definition of U.
-            std::vector<CDMatrix> v; ///< See definition of U.
-            std::vector<CDMatrix> l; ///< See definition of L.
-            std::vector<CDMatrix> h; ///< See definition of L.
-
-            /// Reserves space for std::vectors but does not construct matrices.
-            explicit QLU(std::size_t nt);
+            std::vector<BlockStorage::Block> dinv; ///< \f$d^{-1}\f$, see definition of U.
+            std::vector<BlockStorage::Block> u; ///< See definition of U.
+            std::vector<BlockStorage::Block> v; ///< See definition of U.
+            std::vector<BlockStorage::Block> l; ///< See definition of L.
+            std::vector<BlockStorage::Block> h; ///< See definition of L.
+
+            /// Construct an empty object, must be resized by getQLU().
+            QLU() = default;
+
+            /// Allocate storage for all blocks and set up views into it.
+            /**
+             * All blocks are stored contiguously in a single allocation.
+             * \param nx Spatial lattice size.
+             * \param nt Temporal lattice size.
+             */
+            QLU(std::size_t nx, std::size_t nt);
+
+            QLU(const QLU &) = delete;
+            QLU &operator=(const QLU &) = delete;
+            QLU(QLU &&) = default;
+            QLU &operator=(QLU &&) = default;
+            ~QLU() = default;
 
             /// Check whether an instance is set up properly, i.e. all vectors have consistent sizes.
             bool isConsistent() const;
 
             /// Reconstruct the fermion matrix as a dense matrix.
             CDMatrix reconstruct() const;
+
+            /// Spatial lattice size, 0 if no storage is allocated.
+            std::size_t nx() const noexcept;
+
+            /// Temporal lattice size, 0 if no storage is allocated.
+            std::size_t nt() const noexcept;
+
+        private:
+            BlockStorage _storage;  ///< Memory for all blocks.
         };
 
     private:
@@ -254,6 +335,11 @@ namespace isle {
         double _mu;  ///< Chemical potential.
         std::int8_t _sigmaKappa;  ///< Sign of kappa in M^dag.
 
+        /// Eigenvectors of kappaTilde, stored in the rows.
+        DMatrix _kappaEigenvectors;
+        /// Eigenvalues of kappaTilde.
+        DVector _kappaEigenvalues;
+
         /// exp(kappaTilde-muTilde) for particles.
         DMatrix _expKappap;
         /// exp(-kappaTilde+muTilde) for particles.
@@ -262,8 +348,20 @@ namespace isle {
         DMatrix _expKappah;
         /// exp(-sigmaKappa*kappaTilde-muTilde) for holes.
         DMatrix _expKappahInv;
+        /// log(det(_expKappapInv)).
+        std::complex<double> _logdetExpKappapInv;
         /// log(det(_expKappahInv)).
         std::complex<double> _logdetExpKappahInv;
+        /// Complex copies of the four matrices above for products with complex matrices,
+        /// order: particles, particles inverse, holes, holes inverse.
+        std::array<CDMatrix, 4> _expKappaComplex;
+
+        /// Return one of _expKappaComplex.
+        const CDMatrix &_complexExpKappa(Species species, bool inv) const;
+        /// Compute the eigendecomposition of _kappa.
+        void _diagonalizeKappa();
+        /// Compute all exponentials and their log-determinants from the eigendecomposition.
+        void _updateExpKappa();
     };
 
 
@@ -273,18 +371,38 @@ namespace isle {
      */
     HubbardFermiMatrixExp::QLU getQLU(const HubbardFermiMatrixExp &hfm, const CDVector &phi);
 
+    /// Perform an LU-decomposition of Q and store the result in an existing object.
+    /**
+     * Reuses the memory of `into` if it has the correct size and reallocates otherwise.
+     * \param hfm Encodes matrix \f$Q\f$.
+     * \param phi Auxilliary field.
+     * \param into Result of the decomposition. Old content is overwritten.
+     */
+    void getQLU(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                HubbardFermiMatrixExp::QLU &into);
+
+    /// Factorise Q by means of a block cyclic reduction.
+    /**
+     * The time slices are processed in parallel, see CyclicReduction.
+     * \param hfm Encodes matrix \f$Q\f$.
+     * \param phi Auxilliary field.
+     */
+    CyclicReduction getQCR(const HubbardFermiMatrixExp &hfm, const CDVector &phi);
+
     /// Solve a system of equations \f$Q x = b\f$.
     /**
      * \param hfm Encodes matrix \f$Q\f$.
      * \param phi Auxilliary field.
      * \param rhs Right hand side \f$b\f$.
+     * \param algorithm Select how to factorise Q.
      * \return Solution \f$x\f$.
      * \see `std::complex<double> solveQ(const HubbardFermiMatrixExp::QLU &lu)` in case you
      *      already have the LU-decomposition of Q.
      */
     Vector<std::complex<double>> solveQ(const HubbardFermiMatrixExp &hfm,
                                         const CDVector &phi,
-                                        const Vector<std::complex<double>> &rhs);
+                                        const Vector<std::complex<double>> &rhs,
+                                        QFactorization algorithm=QFactorization::LU);
 
     /// Solve a system of equations \f$Q x = b\f$; use LU-decomposition directly.
     /**
@@ -295,16 +413,35 @@ namespace isle {
     Vector<std::complex<double>> solveQ(const HubbardFermiMatrixExp::QLU &lu,
                                         const Vector<std::complex<double>> &rhs);
 
-    /// Compute \f$\log(\det(Q))\f$ by means of an LU-decomposition.
+    /// Solve a system of equations \f$Q x = b\f$ for many right hand sides at once.
+    /**
+     * Performs the forward and backward substitutions for all right hand sides
+     * together using matrix-matrix products.
+     *
+     * \note The layout of `rhss` is the same as in solveM(), i.e. the first index is
+     *       the number of the right hand side vector, the second index is space-time.
+     *
+     * \param lu LU-Decomposition of matrix \f$Q\f$.
+     * \param rhss Right hand sides \f$b\f$, shape `(nrhs, nx*nt)`.
+     * \param nblocks Split the right hand sides into this many blocks of rows
+     *                which are solved independently in parallel.
+     * \return Solutions \f$x\f$, same shape as rhss.
+     */
+    CDMatrix solveQ(const HubbardFermiMatrixExp::QLU &lu, const CDMatrix &rhss,
+                    std::size_t nblocks=1);
+
+    /// Compute \f$\log(\det(Q))\f$ by means of an LU-decomposition or cyclic reduction.
     /**
      * \param hfm %HubbardFermiMatrixExp to compute the determinant of.
      * \param phi Auxilliary field.
+     * \param algorithm Select how to factorise Q.
      * \return Value equivalent to `log(det(hfm.Q()))` and projected onto the
      *         first branch of the logarithm.
      * \see `std::complex<double> logdet(const HubbardFermiMatrixExp::QLU &lu)` in case you
      *      already have the LU-decomposition of Q.
      */
-    std::complex<double> logdetQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi);
+    std::complex<double> logdetQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                                 QFactorization algorithm=QFactorization::LU);
 
     /// Compute \f$\log(\det(Q))\f$ given an LU-decomposition.
     /**
@@ -329,6 +466,27 @@ namespace isle {
      */
     std::complex<double> ilogdetQ(HubbardFermiMatrixExp::QLU &lu);
 
+    /// Compute the blocks of \f$Q^{-1}\f$ next to the diagonal given an LU-decomposition.
+    /**
+     * Uses a selected inversion based on the relations \f$U Q^{-1} = L^{-1}\f$ and
+     * \f$Q^{-1} L = U^{-1}\f$ restricted to the triangles where the right hand sides
+     * are trivial.
+     * Because of the sparsity of L and U, this only requires the last block row and column
+     * of \f$Q^{-1}\f$ in addition to the blocks on and next to the diagonal.
+     * Costs \f$\mathcal{O}(N_t N_x^3)\f$ operations and \f$\mathcal{O}(N_t N_x^2)\f$ memory
+     * as opposed to \f$\mathcal{O}(N_t^3 N_x^3)\f$ and \f$\mathcal{O}(N_t^2 N_x^2)\f$
+     * for the full inverse.
+     *
+     * \param lu LU-decomposition of matrix \f$Q\f$.
+     * \param upper Set to blocks \f$(Q^{-1})_{t, t+1}\f$ for \f$t \in [0, N_t-1]\f$.
+     * \param lower Set to blocks \f$(Q^{-1})_{t+1, t}\f$ for \f$t \in [0, N_t-1]\f$.
+     *
+     * Time indices are periodic, i.e. `upper[nt-1]` is block \f$(N_t-1, 0)\f$.
+     */
+    void selectedInverseQ(const HubbardFermiMatrixExp::QLU &lu,
+                          std::vector<CDMatrix> &upper,
+                          std::vector<CDMatrix> &lower);
+
     /// Compute \f$\log(\det(M))\f$.
     /**
      * Uses one of two algorithms depending on whether species==PARTICLE or
@@ -338,11 +496,95 @@ namespace isle {
      * \param hfm %HubbardFermiMatrixExp to compute the determinant of.
      * \param phi Auxilliary field.
      * \param species Select whether to use particles or holes.
+     * \param stabilizationInterval If greater than zero, the product of time slices
+     *                              is computed with a StabilizedProduct which performs
+     *                              a QR-decomposition every `stabilizationInterval` slices.
+     *                              Zero means no stabilization.
      * \return Value equivalent to `log(det(hfm.M()))` and projected onto the
      *         first branch of the logarithm.
      */
     std::complex<double> logdetM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
-                                 Species species);
+                                 Species species, std::size_t stabilizationInterval=0);
+
+    /// Compute \f$\log(\det(M))\f$ for many configurations at once.
+    /**
+     * Configurations are distributed over OpenMP threads, all of them share
+     * the same `hfm`.
+     *
+     * \param hfm %HubbardFermiMatrixExp to compute the determinants of.
+     * \param phis Auxilliary fields, one configuration per row,
+     *             i.e. the shape is `(nconf, nx*nt)`.
+     * \param species Select whether to use particles or holes.
+     * \param stabilizationInterval See logdetM().
+     * \return Vector of `nconf` elements, each equivalent to the result of logdetM().
+     */
+    CDVector logdetMBatch(const HubbardFermiMatrixExp &hfm, const CDMatrix &phis,
+                          Species species, std::size_t stabilizationInterval=0);
+
+    /// Compute the logarithms of the eigenvalues of the transfer matrix at zero chemical potential.
+    /**
+     * The transfer matrix is \f$A = F_{N_t-1} \cdots F_0\f$ such that
+     * \f$\det(M) = \det(1 + A)\f$.
+     * The chemical potential only enters as an overall factor,
+     * \f$A(\tilde{\mu}) = e^{\mp N_t\tilde{\mu}} A_0\f$ for particles / holes,
+     * and is removed from the result.
+     * Use logdetMScan() and logCanonicalProjections() to compute determinants for
+     * many chemical potentials from the eigenvalues \f$\lambda_i\f$ of \f$A_0\f$.
+     *
+     * With stabilization, the eigenvalues of \f$A = UDV\f$ are computed from
+     * the similar matrix \f$DVU\f$ with the scales in D sorted in decreasing order.
+     * This only resolves the large eigenvalues accurately, so the eigenvalues with
+     * \f$|\lambda_i| < 1\f$ are instead computed the same way from the inverse product
+     * \f$A^{-1} = F_0^{-1} \cdots F_{N_t-1}^{-1}\f$ which doubles the cost.
+     * The result is sorted by decreasing magnitude in this case.
+     *
+     * \param hfm %HubbardFermiMatrixExp for which to compute the transfer matrix.
+     * \param phi Auxilliary field.
+     * \param species Select whether to use particles or holes.
+     * \param stabilizationInterval See logdetM().
+     * \return Vector of \f$\log\lambda_i\f$, \f$N_x\f$ elements.
+     */
+    CDVector logTransferMatrixEigenvalues(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                                          Species species, std::size_t stabilizationInterval=0);
+
+    /// Compute \f$\log(\det(M))\f$ for many chemical potentials.
+    /**
+     * Uses
+     \f[
+     \log\det M(\tilde{\mu}) = \sum_i \log(1 + e^{\mp N_t \tilde{\mu}} \lambda_i)
+     \f]
+     * for particles / holes which costs \f$\mathcal{O}(N_x)\f$ per chemical potential.
+     *
+     * \param logEigenvalues Result of logTransferMatrixEigenvalues().
+     * \param nt Number of time slices.
+     * \param species Species the eigenvalues were computed for.
+     * \param muTildes Chemical potentials \f$\tilde{\mu}\f$ to evaluate the determinant at.
+     * \return Value of \f$\log\det M\f$ for each element of `muTildes`,
+     *         projected onto the first branch of the logarithm.
+     */
+    CDVector logdetMScan(const CDVector &logEigenvalues, std::size_t nt,
+                         Species species, const DVector &muTildes);
+
+    /// Compute the canonical projections of \f$\det(M_p)\det(M_h)\f$.
+    /**
+     * Expands the product of determinants in powers of the fugacity,
+     \f[
+     \det M_p(\tilde{\mu}) \det M_h(\tilde{\mu}) = \sum_{q=-N_x}^{N_x} e^{-N_t \tilde{\mu} q} Z_q,
+     \f]
+     * where \f$Z_q\f$ is the contribution of the sector with q more particles than holes.
+     * It is computed from the elementary symmetric polynomials of the eigenvalues in
+     * \f$\mathcal{O}(N_x^2)\f$ operations in log-space so that no intermediate
+     * result overflows.
+     *
+     * \param logEigenvaluesParticles Result of logTransferMatrixEigenvalues() for particles.
+     * \param logEigenvaluesHoles Result of logTransferMatrixEigenvalues() for holes.
+     * \return Vector of \f$\log Z_q\f$ with \f$2N_x+1\f$ elements, element `q+nx` holds sector q,
+     *         projected onto the first branch of the logarithm.
+     *         Empty sectors have a real part of \f$-\infty\f$.
+     * \throws std::invalid_argument if the two vectors have different sizes.
+     */
+    CDVector logCanonicalProjections(const CDVector &logEigenvaluesParticles,
+                                     const CDVector &logEigenvaluesHoles);
 
     /// Solve a system of equations \f$M x = b\f$.
     /**
@@ -360,10 +602,89 @@ namespace isle {
      * \param phi Gauge configuration needed to construct M.
      * \param species Select whether to solve for particles or holes.
      * \param rhs Right hand sides b.
+     * \param stabilizationInterval If greater than zero, \f$(1+A^{-1})\f$ is inverted
+     *                              using a StabilizedProduct with a QR-decomposition
+     *                              every `stabilizationInterval` slices.
+     *                              Zero means no stabilization.
      * \returns Results x, same shape as rhs.
      */
     CDMatrix solveM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
-                    const Species species, const CDMatrix &rhss);
+                    const Species species, const CDMatrix &rhss,
+                    std::size_t stabilizationInterval=0);
+
+    /// Apply \f$M\f$ or \f$M^\dagger\f$ to a vector without constructing M.
+    /**
+     * Works slice by slice using only the dense matrix expKappa(species, false) and the phases, so this costs
+     * \f$\mathcal{O}(N_t N_x^2)\f$ operations and no additional memory.
+     *
+     * \param hfm Represents matrix M.
+     * \param phi Gauge configuration needed to construct M.
+     * \param species Select whether to use particles or holes.
+     * \param in Spacetime vector to apply M to.
+     * \param out Set to \f$M \cdot \mathrm{in}\f$ or \f$M^\dagger \cdot \mathrm{in}\f$.
+     *            Must not be the same object as `in`.
+     * \param dagger If `true`, apply \f$M^\dagger\f$ instead of \f$M\f$.
+     * \throws std::invalid_argument if `in` does not match the size of M.
+     */
+    void applyM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                Species species, const CDVector &in, CDVector &out,
+                bool dagger=false);
+
+    /// Apply \f$M\f$ or \f$M^\dagger\f$ to many vectors at once without constructing M.
+    /**
+     * Like applyM(const HubbardFermiMatrixExp&, const CDVector&, Species, const CDVector&, CDVector&, bool)
+     * but for many vectors which are stored in the rows of `in` and `out`, i.e. in the
+     * same layout as in solveM().
+     * The hopping matrix is applied to all vectors with a single matrix-matrix product
+     * per time slice.
+     * \throws std::invalid_argument if the rows of `in` do not match the size of M.
+     */
+    void applyM(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                Species species, const CDMatrix &in, CDMatrix &out,
+                bool dagger=false);
+
+    /// Apply \f$Q\f$ or \f$Q^\dagger\f$ to a vector without constructing Q.
+    /**
+     * Uses \f$Q = M_p M_h^T\f$, i.e. applies M for particles and holes in turn.
+     *
+     * \param hfm Represents matrix Q.
+     * \param phi Gauge configuration needed to construct Q.
+     * \param in Spacetime vector to apply Q to.
+     * \param out Set to \f$Q \cdot \mathrm{in}\f$ or \f$Q^\dagger \cdot \mathrm{in}\f$.
+     *            Must not be the same object as `in`.
+     * \param dagger If `true`, apply \f$Q^\dagger\f$ instead of \f$Q\f$.
+     * \throws std::invalid_argument if `in` does not match the size of Q.
+     */
+    void applyQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                const CDVector &in, CDVector &out, bool dagger=false);
+
+    /// Apply \f$Q\f$ or \f$Q^\dagger\f$ to many vectors at once without constructing Q.
+    /**
+     * Vectors are stored in the rows of `in` and `out`,
+     * see applyM(const HubbardFermiMatrixExp&, const CDVector&, Species, const CDMatrix&, CDMatrix&, bool).
+     */
+    void applyQ(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                const CDMatrix &in, CDMatrix &out, bool dagger=false);
+
+    /// Compute the all-to-all propagator \f$M^{-1}\f$.
+    /**
+     * Writes \f$(M^{-1})_{(t,x),(t',y)}\f$ into `out[x, t, y, t']`, i.e. element
+     * `out[((x*nt + t)*nx + y)*nt + t']` for a C-contiguous array of shape `(nx, nt, nx, nt)`.
+     *
+     * With \f$B_t = K^{-1} F_t\f$, the first block row of \f$M^{-1}\f$ is built from
+     * \f$(1 + B_0 B_{N_t-1} \cdots B_1)^{-1}\f$ and all other block rows follow from
+     * \f$(M^{-1})_{t,t'} = B_t (M^{-1})_{t-1,t'} + \delta_{t,t'} K^{-1}\f$.
+     * This avoids solving against an identity matrix of right hand sides as well as
+     * reordering the result afterwards.
+     *
+     * \param hfm Represents matrix M.
+     * \param phi Gauge configuration needed to construct M.
+     * \param species Select whether to compute the propagator for particles or holes.
+     * \param out Pointer to the result, must have space for `nx*nt*nx*nt` elements.
+     *            The memory does not have to be initialized.
+     */
+    void allToAllPropagator(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                            Species species, std::complex<double> *out);
 
 }  // namespace isle
 
@@ -1,5 +1,6 @@
 #include "integrator.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <random>
 #include <iostream>
@@ -30,9 +31,74 @@ namespace isle {
             phiOut += piOut*eps;
         }
 
-        // last half step
-        piOut += blaze::real(action->force(phiOut))*(eps/2);
-    
+        // last half step, evaluate action together with force
+        const auto [actVal, force] = action->evalAndForce(phiOut);
+        piOut += blaze::real(force)*(eps/2);
+
+        return std::make_tuple(std::move(phiOut), std::move(piOut), actVal);
+    }
+
+
+    namespace {
+        /// Compute the sum of forces of all actions on a given time scale.
+        DVector timescaleForce(const CDVector &phi,
+                               const action::SumAction &action,
+                               const std::vector<std::size_t> &timescales,
+                               const std::size_t level) {
+            DVector force(phi.size(), 0.0);
+            for (std::size_t i = 0; i < action.size(); ++i) {
+                if (timescales[i] == level)
+                    force += blaze::real(action[i]->force(phi));
+            }
+            return force;
+        }
+
+        /// Perform a single step of size eps on time scale level.
+        void multiTimescaleStep(CDVector &phi, CDVector &pi,
+                                const action::SumAction &action,
+                                const std::vector<std::size_t> &timescales,
+                                const std::vector<std::size_t> &nsteps,
+                                const std::size_t level,
+                                const double eps) {
+
+            const std::size_t n = nsteps[level];
+            const double h = eps/static_cast<double>(n);
+
+            pi += timescaleForce(phi, action, timescales, level)*(h/2);
+            for (std::size_t i = 0; i < n; ++i) {
+                if (level+1 == nsteps.size())
+                    phi += pi*h;
+                else
+                    multiTimescaleStep(phi, pi, action, timescales, nsteps, level+1, h);
+
+                // merge the final half step with the initial half step of the next step
+                pi += timescaleForce(phi, action, timescales, level)*(i == n-1 ? h/2 : h);
+            }
+        }
+    }
+
+    std::tuple<CDVector, CDVector, std::complex<double>>
+    multiTimescaleLeapfrog(const CDVector &phi,
+                           const CDVector &pi,
+                           const action::SumAction *const action,
+                           const std::vector<std::size_t> &timescales,
+                           const double length,
+                           const std::vector<std::size_t> &nsteps,
+                           const double direction) {
+
+        if (timescales.size() != action->size())
+            throw std::invalid_argument("Need exactly one time scale per action in multiTimescaleLeapfrog");
+        if (std::any_of(timescales.begin(), timescales.end(),
+                        [&](const std::size_t ts) { return ts >= nsteps.size(); }))
+            throw std::invalid_argument("Time scale without number of steps in multiTimescaleLeapfrog");
+        if (std::find(nsteps.begin(), nsteps.end(), 0) != nsteps.end())
+            throw std::invalid_argument("Number of steps must be positive in multiTimescaleLeapfrog");
+
+        // step 0 has size length so that time scale 0 performs nsteps[0] steps
+        CDVector phiOut = phi;
+        CDVector piOut = pi;
+        multiTimescaleStep(phiOut, piOut, *action, timescales, nsteps, 0, direction*length);
+
         const std::complex<double> actVal = action->eval(phiOut);
         return std::make_tuple(std::move(phiOut), std::move(piOut), actVal);
     }
@@ -72,6 +138,7 @@ namespace isle {
 
         template <int N>
         CDVector rk4Step(const CDVector &phi,
+                         const CDVector &forceAtPhi,
                          const action::Action *action,
                          const double epsilon,
                          const double direction) {
@@ -80,7 +147,7 @@ namespace isle {
 
             const double edir = epsilon*direction;
 
-            const CDVector k1 = -edir * conj(action->force(phi));
+            const CDVector k1 = -edir * conj(forceAtPhi);
             const CDVector k2 = -edir * conj(action->force(phi
                                                            + p::beta21*k1));
             const CDVector k3 = -edir * conj(action->force(phi
@@ -94,18 +161,24 @@ namespace isle {
             return phi + p::omega1*k1 + p::omega2*k2 + p::omega3*k3 + p::omega4*k4;
         }
 
-        std::pair<CDVector, std::complex<double>>
+        /// Perform a single RK4 step, return new phi, action, and force at new phi.
+        /*
+         * The force is returned such that the next step can start from it
+         * and the action and force can be computed together.
+         */
+        std::tuple<CDVector, std::complex<double>, CDVector>
         rk4Step(const CDVector &phi,
+                const CDVector &forceAtPhi,
                 const action::Action *action,
                 const double epsilon,
                 const double direction,
                 const int n) {
 
-            const auto phiOut = n == 0
-                ? rk4Step<0>(phi, action, epsilon, direction)
-                : rk4Step<1>(phi, action, epsilon, direction);
-            const auto actValOut = action->eval(phiOut);
-            return {std::move(phiOut), actValOut};
+            CDVector phiOut = n == 0
+                ? rk4Step<0>(phi, forceAtPhi, action, epsilon, direction)
+                : rk4Step<1>(phi, forceAtPhi, action, epsilon, direction);
+            auto [actValOut, forceOut] = action->evalAndForce(phiOut);
+            return {std::move(phiOut), actValOut, std::move(forceOut)};
         }
 
         double reduceStepSize(const double stepSize,
@@ -149,8 +222,13 @@ namespace isle {
             throw std::invalid_argument("n must be 0 or 1");
         }
 
+        // force at current phi, is updated together with phi
+        CDVector force;
         if (std::isnan(real(actVal)) || std::isnan(imag(actVal))) {
-            actVal = action->eval(phi);
+            std::tie(actVal, force) = action->evalAndForce(phi);
+        }
+        else {
+            force = action->force(phi);
         }
 
         if (std::isnan(minStepSize)) {
@@ -168,8 +246,9 @@ namespace isle {
                 }
             }
 
-            const auto attempt = rk4Step(phi, action, stepSize, direction, n);
-            const auto error = abs(exp(1.0i*(imag(actVal)-imag(attempt.second))) - 1.0);
+            auto [phiAttempt, actValAttempt, forceAttempt] = rk4Step(phi, force, action,
+                                                                     stepSize, direction, n);
+            const auto error = abs(exp(1.0i*(imag(actVal)-imag(actValAttempt))) - 1.0);
 
             if (error > imActTolerance) {
                 if (stepSize == minStepSize) {
@@ -183,8 +262,9 @@ namespace isle {
             else {
                 // attempt was successful -> advance
                 currentFlowTime += stepSize;
-                phi = std::move(attempt.first);
-                actVal = attempt.second;
+                phi = std::move(phiAttempt);
+                actVal = actValAttempt;
+                force = std::move(forceAttempt);
 
                 if (error < adaptThreshold*imActTolerance) {
                     stepSize = increaseStepSize(stepSize, adaptAttenuation,
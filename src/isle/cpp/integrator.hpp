@@ -6,9 +6,11 @@
 #define INTEGRATOR_HPP
 
 #include <tuple>
+#include <vector>
 
 #include "math.hpp"
 #include "action/action.hpp"
+#include "action/sumAction.hpp"
 
 namespace isle {
     /// Perform leapfrog integration.
@@ -33,6 +35,49 @@ namespace isle {
              std::size_t nsteps,
              double direction=+1);
 
+    /// Perform nested leapfrog integration with multiple time scales.
+    /**
+     * Splits the action into parts which are integrated with different step sizes
+     * following Sexton and Weingarten.
+     * Each summand `action[i]` is assigned to time scale `timescales[i]`
+     * where time scale 0 is the coarsest.
+     * A single step on time scale l consists of a half step in pi using the
+     * force of all actions on time scale l, `nsteps[l+1]` steps on time scale l+1
+     * (or a full step in phi on the finest scale), and another half step in pi.
+     * Time scale 0 takes `nsteps[0]` steps for the whole trajectory,
+     * consecutive half steps in pi are merged on all time scales.
+     *
+     * Put cheap actions with large forces, e.g. the gauge action or the heavy
+     * part of a Hasenbusch split fermion action, on fine time scales
+     * and expensive actions with small forces on coarse time scales.
+     * With a single time scale, this is equivalent to leapfrog().
+     *
+     * \param phi Starting configuration.
+     * \param pi Starting momentum.
+     * \param action Sum of all actions to integrate over.
+     * \param timescales Time scale of each summand of `action`.
+     * \param length Length of the trajectory.
+     * \param nsteps Number of integration steps on each time scale per step
+     *               on the next coarser scale.
+     * \param direction Direction of integration, should be `+1` or `-1`.
+     *
+     * \returns Tuple of (in order)
+     *           - final configuration phi
+     *           - final momentum pi
+     *           - value of the full action at final phi
+     *
+     * \throws std::invalid_argument if `timescales` does not match `action`,
+     *         if a time scale has no entry in `nsteps`, or if any entry in `nsteps` is zero.
+     */
+    std::tuple<CDVector, CDVector, std::complex<double>>
+    multiTimescaleLeapfrog(const CDVector &phi,
+                           const CDVector &pi,
+                           const action::SumAction *action,
+                           const std::vector<std::size_t> &timescales,
+                           double length,
+                           const std::vector<std::size_t> &nsteps,
+                           double direction=+1);
+
     /// Perform Runge Kutta (RK4) integration for holomorphic flow.
     /**
      * Flow a configuration using the holomorphic flow equation
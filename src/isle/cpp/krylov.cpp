@@ -0,0 +1,116 @@
+#include "krylov.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace isle {
+    SolverInfo conjugateGradient(const LinearOperator &op, const CDVector &rhs, CDVector &x,
+                                 const double tolerance, const std::size_t maxIterations) {
+        const double rhsSqrNorm = blaze::sqrNorm(rhs);
+        const double target = tolerance*tolerance*rhsSqrNorm;
+
+        CDVector ap(rhs.size());
+        CDVector r;
+        if (x.size() != rhs.size()) {
+            x = CDVector(rhs.size(), 0);
+            r = rhs;
+        }
+        else {
+            op(x, ap);
+            r = rhs - ap;
+        }
+
+        CDVector p = r;
+        double rr = blaze::sqrNorm(r);
+        std::size_t iteration = 0;
+        while (rr > target) {
+            if (iteration == maxIterations)
+                throw std::runtime_error("Conjugate gradient did not converge within "
+                                         + std::to_string(maxIterations) + " iterations.");
+
+            op(p, ap);
+            const std::complex<double> alpha = rr / blaze::dot(blaze::conj(p), ap);
+            x += alpha*p;
+            r -= alpha*ap;
+
+            const double rrNew = blaze::sqrNorm(r);
+            p = r + (rrNew/rr)*p;
+            rr = rrNew;
+            ++iteration;
+        }
+
+        return {iteration, rhsSqrNorm == 0 ? std::sqrt(rr) : std::sqrt(rr/rhsSqrNorm)};
+    }
+
+    SolverInfo multiShiftConjugateGradient(const LinearOperator &op, const CDVector &rhs,
+                                           const std::vector<double> &shifts,
+                                           std::vector<CDVector> &xs,
+                                           const double tolerance,
+                                           const std::size_t maxIterations) {
+        if (shifts.empty())
+            throw std::invalid_argument("Need at least one shift for multi-shift conjugate gradient.");
+
+        const std::size_t nshifts = shifts.size();
+        const double rhsSqrNorm = blaze::sqrNorm(rhs);
+        const double target = tolerance*tolerance*rhsSqrNorm;
+
+        // iterate on the system with the smallest shift, the others are relative to it
+        const double baseShift = *std::min_element(shifts.begin(), shifts.end());
+
+        xs.assign(nshifts, CDVector(rhs.size(), 0));
+        std::vector<CDVector> ps(nshifts, rhs);
+        std::vector<double> zeta(nshifts, 1.0), zetaOld(nshifts, 1.0), zetaNew(nshifts);
+
+        CDVector r = rhs;
+        CDVector p = rhs;
+        CDVector ap(rhs.size());
+        double rr = rhsSqrNorm;
+        double alphaOld = 1.0;
+        double betaOld = 0.0;
+        std::size_t iteration = 0;
+        while (rr > target) {
+            if (iteration == maxIterations)
+                throw std::runtime_error("Multi-shift conjugate gradient did not converge within "
+                                         + std::to_string(maxIterations) + " iterations.");
+
+            op(p, ap);
+            ap += baseShift*p;
+            const double alpha = rr / std::real(blaze::dot(blaze::conj(p), ap));
+
+            // the shifted residuals are collinear with r, r_i = zeta_i r
+            for (std::size_t i = 0; i < nshifts; ++i) {
+                // shifted system has converged to machine precision
+                if (zeta[i] == 0) {
+                    zetaNew[i] = 0;
+                    continue;
+                }
+                const double sigma = shifts[i] - baseShift;
+                zetaNew[i] = zeta[i]*zetaOld[i]*alphaOld
+                    / (alpha*betaOld*(zetaOld[i]-zeta[i])
+                       + zetaOld[i]*alphaOld*(1.0 + sigma*alpha));
+                xs[i] += (alpha*zetaNew[i]/zeta[i])*ps[i];
+            }
+
+            r -= alpha*ap;
+            const double rrNew = blaze::sqrNorm(r);
+            const double beta = rrNew/rr;
+            for (std::size_t i = 0; i < nshifts; ++i) {
+                if (zeta[i] == 0)
+                    continue;
+                const double ratio = zetaNew[i]/zeta[i];
+                ps[i] = zetaNew[i]*r + (beta*ratio*ratio)*ps[i];
+            }
+            p = r + beta*p;
+
+            std::swap(zetaOld, zeta);
+            std::swap(zeta, zetaNew);
+            alphaOld = alpha;
+            betaOld = beta;
+            rr = rrNew;
+            ++iteration;
+        }
+
+        return {iteration, rhsSqrNorm == 0 ? std::sqrt(rr) : std::sqrt(rr/rhsSqrNorm)};
+    }
+}  // namespace isle
@@ -0,0 +1,66 @@
+/** \file
+ * \brief Iterative Krylov subspace solvers.
+ */
+
+#ifndef KRYLOV_HPP
+#define KRYLOV_HPP
+
+#include <functional>
+#include <vector>
+
+#include "math.hpp"
+
+namespace isle {
+    /// Linear operator A acting on vectors, stores \f$A \cdot \mathrm{in}\f$ in `out`.
+    /**
+     * `in` and `out` are never the same object.
+     */
+    using LinearOperator = std::function<void(const CDVector &in, CDVector &out)>;
+
+    /// Summary of a run of an iterative solver.
+    struct SolverInfo {
+        std::size_t iterations;  ///< Number of iterations performed.
+        double residual;  ///< Final relative residual \f$\|b - A x\| / \|b\|\f$.
+    };
+
+    /// Solve \f$A x = b\f$ for hermitian positive definite A using conjugate gradient.
+    /**
+     * Only needs to apply A to vectors, A is never constructed.
+     *
+     * \param op Applies A to a vector.
+     * \param rhs Right hand side b.
+     * \param x Initial guess on input, solution on output.
+     *          If `x` does not have the same size as `rhs`, start from zero.
+     * \param tolerance Stop when the relative residual drops below this value.
+     * \param maxIterations Maximum number of iterations.
+     * \returns Number of iterations and final relative residual.
+     * \throws std::runtime_error if the solver does not converge within `maxIterations`.
+     */
+    SolverInfo conjugateGradient(const LinearOperator &op, const CDVector &rhs, CDVector &x,
+                                 double tolerance, std::size_t maxIterations);
+
+    /// Solve \f$(A + \sigma_i) x_i = b\f$ for several shifts at once using multi-shift conjugate gradient.
+    /**
+     * All shifted systems share the same Krylov space, so A is applied only once per
+     * iteration regardless of the number of shifts.
+     * The system with the smallest shift converges slowest and determines when to stop.
+     * A must be hermitian and \f$A + \sigma_i\f$ positive definite for all i.
+     *
+     * \param op Applies A to a vector.
+     * \param rhs Right hand side b.
+     * \param shifts Shifts \f$\sigma_i\f$.
+     * \param xs Solutions \f$x_i\f$, one per shift. Always starts from zero.
+     * \param tolerance Stop when the relative residual of the system with the
+     *                  smallest shift drops below this value.
+     * \param maxIterations Maximum number of iterations.
+     * \returns Number of iterations and final relative residual of the system with the smallest shift.
+     * \throws std::invalid_argument if `shifts` is empty.
+     * \throws std::runtime_error if the solver does not converge within `maxIterations`.
+     */
+    SolverInfo multiShiftConjugateGradient(const LinearOperator &op, const CDVector &rhs,
+                                           const std::vector<double> &shifts,
+                                           std::vector<CDVector> &xs,
+                                           double tolerance, std::size_t maxIterations);
+}  // namespace isle
+
+#endif  // ndef KRYLOV_HPP
@@ -0,0 +1,202 @@
+#include "localUpdate.hpp"
+
+#include <random>
+
+#include "stabilizedProduct.hpp"
+
+using namespace std::complex_literals;
+
+namespace isle {
+    namespace {
+        /// Throw if the recompute interval is not valid.
+        std::size_t checkedInterval(const std::size_t recomputeInterval) {
+            if (recomputeInterval == 0)
+                throw std::invalid_argument("recomputeInterval of LocalUpdate must be positive.");
+            return recomputeInterval;
+        }
+
+        /// Throw if the number of delayed updates is not valid.
+        std::size_t checkedDelay(const std::size_t delay) {
+            if (delay == 0)
+                throw std::invalid_argument("delay of LocalUpdate must be positive.");
+            return delay;
+        }
+
+        /// Wrap a Green's function from time slice s-1 to s, G -> D_s E G E^-1 D_s^-1.
+        void wrap(CDMatrix &g, const CDMatrix &e, const CDMatrix &einv,
+                  const std::complex<double> sign, const CDVector &phiSlice) {
+            g = e*g;
+            scaleRows(g, CDVector(blaze::exp(sign*phiSlice)));
+            g = g*einv;
+            scaleColumns(g, CDVector(blaze::exp(-sign*phiSlice)));
+        }
+
+        /// Collects rank-1 updates of a Green's function and applies them in one go.
+        /**
+         * Represents the current Green's function as \f$G - U^T V\f$ where G is
+         * the stored matrix and the rows of U and V hold one update each.
+         * Once `delay` updates are collected, they are applied to G via a single
+         * matrix-matrix product.
+         */
+        class DelayedUpdates {
+        public:
+            DelayedUpdates(const std::size_t nx, const std::size_t delay)
+                : _ut(delay, nx), _v(delay, nx), _n{0} { }
+
+            /// Return element (x, x) of the current Green's function.
+            std::complex<double> diagonal(const CDMatrix &g, const std::size_t x) const {
+                std::complex<double> res = g(x, x);
+                for (std::size_t j = 0; j < _n; ++j)
+                    res -= _ut(j, x)*_v(j, x);
+                return res;
+            }
+
+            /// Record change of D_s by (1 + delta) at site x, G -> G - delta/ratio * G e_x e_x^T (1 - G).
+            void push(CDMatrix &g, const std::size_t x,
+                      const std::complex<double> delta,
+                      const std::complex<double> ratio) {
+                const std::size_t nx = g.rows();
+
+                // column x of G and row x of 1 - G, including pending updates
+                auto u = blaze::row(_ut, _n);
+                u = blaze::trans(blaze::column(g, x));
+                auto v = blaze::row(_v, _n);
+                v = -blaze::row(g, x);
+                v[x] += 1.0;
+                if (_n > 0) {
+                    const auto ut = blaze::submatrix(_ut, 0, 0, _n, nx);
+                    const auto vs = blaze::submatrix(_v, 0, 0, _n, nx);
+                    u -= blaze::trans(blaze::column(vs, x)) * ut;
+                    v += blaze::trans(blaze::column(ut, x)) * vs;
+                }
+                u *= delta/ratio;
+
+                if (++_n == _ut.rows())
+                    flush(g);
+            }
+
+            /// Apply all pending updates to G.
+            void flush(CDMatrix &g) {
+                if (_n == 0)
+                    return;
+                g -= blaze::trans(blaze::submatrix(_ut, 0, 0, _n, g.rows()))
+                    * blaze::submatrix(_v, 0, 0, _n, g.columns());
+                _n = 0;
+            }
+
+        private:
+            CDMatrix _ut;  ///< Transpose of U.
+            CDMatrix _v;  ///< V.
+            std::size_t _n;  ///< Number of pending updates.
+        };
+    }
+
+    LocalUpdate::LocalUpdate(const HubbardFermiMatrixDia &hfm, const double utilde,
+                             const std::size_t recomputeInterval,
+                             const std::size_t delay)
+        : _nx{hfm.nx()}, _utilde{utilde},
+          _recomputeInterval{checkedInterval(recomputeInterval)},
+          _delay{checkedDelay(delay)},
+          _particle{CDMatrix(hfm.Kinv(Species::PARTICLE)), CDMatrix(hfm.K(Species::PARTICLE)), 1.0i},
+          _hole{CDMatrix(hfm.Kinv(Species::HOLE)), CDMatrix(hfm.K(Species::HOLE)), -1.0i}
+    { }
+
+    LocalUpdate::LocalUpdate(const HubbardFermiMatrixExp &hfm, const double utilde,
+                             const std::size_t recomputeInterval,
+                             const std::size_t delay)
+        : _nx{hfm.nx()}, _utilde{utilde},
+          _recomputeInterval{checkedInterval(recomputeInterval)},
+          _delay{checkedDelay(delay)},
+          _particle{CDMatrix(hfm.expKappa(Species::PARTICLE, false)),
+                    CDMatrix(hfm.expKappa(Species::PARTICLE, true)), 1.0i},
+          _hole{CDMatrix(hfm.expKappa(Species::HOLE, false)),
+                CDMatrix(hfm.expKappa(Species::HOLE, true)), -1.0i}
+    { }
+
+    CDMatrix LocalUpdate::_greens(const SpeciesMatrices &species, const CDVector &phi,
+                                  const std::size_t s) const {
+        const std::size_t nt = getNt(phi, _nx);
+
+        // C_s = B_s ... B_0 B_{nt-1} ... B_{s+1}
+        StabilizedProduct prod{_nx, _recomputeInterval};
+        CDMatrix b;
+        for (std::size_t i = 1; i <= nt; ++i) {
+            const std::size_t t = (s+i) % nt;
+            b = species.e;
+            scaleRows(b, CDVector(blaze::exp(species.sign*spacevec(phi, t, _nx))));
+            prod.leftMultiply(b);
+        }
+        return prod.invOnePlus();
+    }
+
+    std::tuple<CDVector, std::complex<double>, std::size_t>
+    LocalUpdate::sweep(const CDVector &phiIn, const std::size_t nsweeps,
+                       const double maxStep, const std::uint64_t seed) const {
+
+        const std::size_t nx = _nx;
+        const std::size_t nt = getNt(phiIn, nx);
+
+        std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                          static_cast<std::uint32_t>(seed >> 32)};
+        std::mt19937_64 rng{seq};
+        std::uniform_real_distribution<double> step{-maxStep, maxStep};
+        std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+        CDVector phi = phiIn;
+        std::complex<double> deltaAction = 0;
+        std::size_t accepted = 0;
+
+        CDMatrix gp, gh;  // Green's functions for particles and holes
+        DelayedUpdates dp{nx, _delay}, dh{nx, _delay};
+        for (std::size_t n = 0; n < nsweeps; ++n) {
+            for (std::size_t s = 0; s < nt; ++s) {
+                if (s % _recomputeInterval == 0) {
+                    gp = _greens(_particle, phi, s);
+                    gh = _greens(_hole, phi, s);
+                }
+                else {
+                    const CDVector phiSlice = spacevec(phi, s, nx);
+                    wrap(gp, _particle.e, _particle.einv, _particle.sign, phiSlice);
+                    wrap(gh, _hole.e, _hole.einv, _hole.sign, phiSlice);
+                }
+
+                for (std::size_t x = 0; x < nx; ++x) {
+                    const double dphi = step(rng);
+                    std::complex<double> &site = phi[s*nx + x];
+
+                    const std::complex<double> deltaP = std::exp(_particle.sign*dphi) - 1.0;
+                    const std::complex<double> deltaH = std::exp(_hole.sign*dphi) - 1.0;
+                    const std::complex<double> ratioP = 1.0 + deltaP*(1.0 - dp.diagonal(gp, x));
+                    const std::complex<double> ratioH = 1.0 + deltaH*(1.0 - dh.diagonal(gh, x));
+
+                    const std::complex<double> dS = dphi*(2.0*site + dphi)/(2.0*_utilde)
+                        - std::log(ratioP) - std::log(ratioH);
+
+                    if (std::real(dS) < 0 || std::exp(-std::real(dS)) > uniform(rng)) {
+                        dp.push(gp, x, deltaP, ratioP);
+                        dh.push(gh, x, deltaH, ratioH);
+                        site += dphi;
+                        deltaAction += dS;
+                        ++accepted;
+                    }
+                }
+                dp.flush(gp);
+                dh.flush(gh);
+            }
+        }
+
+        return {phi, deltaAction, accepted};
+    }
+
+    double LocalUpdate::utilde() const noexcept {
+        return _utilde;
+    }
+
+    std::size_t LocalUpdate::recomputeInterval() const noexcept {
+        return _recomputeInterval;
+    }
+
+    std::size_t LocalUpdate::delay() const noexcept {
+        return _delay;
+    }
+}  // namespace isle
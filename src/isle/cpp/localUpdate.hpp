@@ -0,0 +1,130 @@
+/** \file
+ * \brief Local Metropolis updates of the Hubbard auxilliary field.
+ */
+
+#ifndef LOCAL_UPDATE_HPP
+#define LOCAL_UPDATE_HPP
+
+#include <cstdint>
+#include <tuple>
+
+#include "math.hpp"
+#include "hubbardFermiMatrixDia.hpp"
+#include "hubbardFermiMatrixExp.hpp"
+
+namespace isle {
+    /// Local Metropolis updates for the Hubbard model using equal-time Green's functions.
+    /**
+     * Updates the auxilliary field one site at a time for the action
+     \f[
+     S(\phi) = \frac{1}{2\tilde{U}}\sum_{x,t} \phi_{x,t}^2
+               - \log\det M(\phi, \tilde{\kappa}, \tilde{\mu})
+               - \log\det M(-\phi, \sigma_{\tilde{\kappa}}\tilde{\kappa}, -\tilde{\mu}),
+     \f]
+     * i.e. a HubbardGaugeAction plus a HubbardFermiAction in the particle/hole basis.
+     *
+     * Write the determinant as \f$\det M = c \det(1 + C_s)\f$ with the cyclic product
+     * \f$C_s = B_s B_{s-1} \cdots B_0 B_{N_t-1} \cdots B_{s+1}\f$,
+     * \f$B_t = D_t E\f$, and \f$D_t = \mathrm{diag}(e^{\pm i\phi_t})\f$.
+     * The constant matrix E is \f$e^{\tilde{\kappa}\mp\tilde{\mu}}\f$
+     * (up to \f$\sigma_{\tilde{\kappa}}\f$) for HubbardFermiMatrixExp and
+     * \f$K^{-1}\f$ for HubbardFermiMatrixDia.
+     * Changing \f$\phi_{x,s} \rightarrow \phi_{x,s} + \Delta\f$ only changes
+     * \f$D_s\f$ and the ratio of determinants is
+     \f[
+     \frac{\det(1 + C_s')}{\det(1 + C_s)} = 1 + \delta(1 - G_s)_{xx},
+     \quad \delta = e^{\pm i\Delta} - 1,
+     \f]
+     * with the equal-time Green's function \f$G_s = (1 + C_s)^{-1}\f$.
+     * Upon acceptance, \f$G_s\f$ is updated via the Sherman-Morrison formula at
+     * a cost of \f$\mathcal{O}(N_x^2)\f$.
+     *
+     * Those rank-1 updates are memory bound.
+     * Up to `delay` accepted updates on one time slice are therefore collected as
+     * factors \f$G_s \rightarrow G_s - U^T V\f$ with \f$U, V \in \mathbb{C}^{k \times N_x}\f$
+     * and applied together as a single matrix-matrix product.
+     * Only the diagonal element and one row and column of the Green's function are
+     * needed for each proposal and can be computed from the factors in
+     * \f$\mathcal{O}(k N_x)\f$.
+     * `delay=1` corresponds to applying every update immediately.
+     * See `benchmarks/localUpdate.py` for the dependence on the delay.
+     * Moving to the next time slice wraps the Green's function as
+     * \f$G_{s+1} = B_{s+1} G_s B_{s+1}^{-1}\f$.
+     * In order to limit the accumulation of round off errors, \f$G_s\f$ is recomputed
+     * from scratch using a StabilizedProduct every `recomputeInterval` time slices.
+     *
+     * Proposals are drawn uniformly from \f$[-\mathrm{maxStep}, \mathrm{maxStep}]\f$
+     * and accepted with probability \f$\min(1, e^{-\mathrm{Re}\,\Delta S})\f$.
+     */
+    class LocalUpdate {
+    public:
+        /// Set up updates for given fermion matrix and on-site coupling.
+        /**
+         * \param hfm Fermion matrix of the HubbardFermiAction.
+         * \param utilde On-site coupling of the HubbardGaugeAction.
+         * \param recomputeInterval Number of time slices between recomputations of
+         *                          the Green's functions from scratch. Also used as the
+         *                          interval of the StabilizedProduct.
+         * \param delay Maximum number of accepted updates that are collected before
+         *              applying them to the Green's functions.
+         * \throws std::invalid_argument if `recomputeInterval == 0` or `delay == 0`.
+         */
+        LocalUpdate(const HubbardFermiMatrixDia &hfm, double utilde,
+                    std::size_t recomputeInterval=4, std::size_t delay=1);
+
+        /// Set up updates for given fermion matrix and on-site coupling.
+        /**
+         * \see LocalUpdate(const HubbardFermiMatrixDia&, double, std::size_t, std::size_t)
+         */
+        LocalUpdate(const HubbardFermiMatrixExp &hfm, double utilde,
+                    std::size_t recomputeInterval=4, std::size_t delay=1);
+
+        /// Perform sweeps of local updates over all lattice sites.
+        /**
+         * Visits time slices in order and all sites on each slice.
+         *
+         * \param phi Starting configuration.
+         * \param nsweeps Number of sweeps over the whole lattice.
+         * \param maxStep Maximum size of proposed changes of phi on a single site.
+         * \param seed Seed for the random number generator for proposals and
+         *             accept/reject.
+         * \returns Tuple of (in order)
+         *           - final configuration phi
+         *           - change in action from all accepted updates
+         *           - number of accepted updates
+         */
+        std::tuple<CDVector, std::complex<double>, std::size_t>
+        sweep(const CDVector &phi, std::size_t nsweeps, double maxStep,
+              std::uint64_t seed) const;
+
+        /// Return the on-site coupling.
+        double utilde() const noexcept;
+
+        /// Return the number of time slices between recomputations of the Green's functions.
+        std::size_t recomputeInterval() const noexcept;
+
+        /// Return the maximum number of delayed updates.
+        std::size_t delay() const noexcept;
+
+    private:
+        /// Matrices needed for one species.
+        struct SpeciesMatrices {
+            CDMatrix e;  ///< Matrix E in \f$B_t = D_t E\f$.
+            CDMatrix einv;  ///< Inverse of E.
+            std::complex<double> sign;  ///< Phases in D are exp(sign*phi).
+        };
+
+        /// Compute the Green's function at time slice s from scratch.
+        CDMatrix _greens(const SpeciesMatrices &species, const CDVector &phi,
+                         std::size_t s) const;
+
+        std::size_t _nx;  ///< Number of spatial lattice sites.
+        double _utilde;  ///< On-site coupling.
+        std::size_t _recomputeInterval;  ///< Time slices between recomputations.
+        std::size_t _delay;  ///< Maximum number of delayed updates.
+        SpeciesMatrices _particle;  ///< Matrices for particles.
+        SpeciesMatrices _hole;  ///< Matrices for holes.
+    };
+}  // namespace isle
+
+#endif  // ndef LOCAL_UPDATE_HPP
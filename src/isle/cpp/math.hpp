@@ -68,14 +68,19 @@ namespace isle {
     using IVector = Vector<int>;
     using DVector = Vector<double>;
     using CDVector = Vector<std::complex<double>>;
+    using FVector = Vector<float>;
+    using CFVector = Vector<std::complex<float>>;
 
     using IMatrix = Matrix<int>;
     using DMatrix = Matrix<double>;
     using CDMatrix = Matrix<std::complex<double>>;
+    using FMatrix = Matrix<float>;
+    using CFMatrix = Matrix<std::complex<float>>;
 
     using ISparseMatrix = SparseMatrix<int>;
     using DSparseMatrix = SparseMatrix<double>;
     using CDSparseMatrix = SparseMatrix<std::complex<double>>;
+    using FSparseMatrix = SparseMatrix<float>;
 
 
     /// Get the value type from a given compound type.
@@ -213,14 +218,48 @@ namespace isle {
 #endif
     }
 
+    /// Select whether to multiply a matrix onto another from the left or right.
+    enum class Side {
+        LEFT,  ///< Compute `A*mat`.
+        RIGHT  ///< Compute `mat*A`.
+    };
+
+    /// Multiply row i of a matrix by `vec[i]` in place, i.e. compute `diag(vec)*mat`.
+    template <typename MT, typename VT>
+    void scaleRows(MT &mat, const VT &vec) noexcept(ndebug) {
+#ifndef NDEBUG
+        if (mat.rows() != vec.size())
+            throw std::invalid_argument("Number of rows of matrix does not match size of vector.");
+#endif
+        for (std::size_t i = 0; i < mat.rows(); ++i) {
+            const auto s = vec[i];
+            for (std::size_t j = 0; j < mat.columns(); ++j)
+                mat(i, j) *= s;
+        }
+    }
+
+    /// Multiply column j of a matrix by `vec[j]` in place, i.e. compute `mat*diag(vec)`.
+    template <typename MT, typename VT>
+    void scaleColumns(MT &mat, const VT &vec) noexcept(ndebug) {
+#ifndef NDEBUG
+        if (mat.columns() != vec.size())
+            throw std::invalid_argument("Number of columns of matrix does not match size of vector.");
+#endif
+        // iterate row-wise in inner loop to match row-major storage
+        for (std::size_t i = 0; i < mat.rows(); ++i)
+            for (std::size_t j = 0; j < mat.columns(); ++j)
+                mat(i, j) *= vec[j];
+    }
+
     /// Invert a matrix in place.
     /**
+     * \tparam MT Specific matrix type, must be a blaze dense matrix.
      * \param mat Matrix to be inverted. Is replaced by the inverse.
      * \param ipiv Pivot indices. Must have at least `mat.rows()` elements
      *             but can be uninitialized.
      */
-    template <typename ET>
-    void invert(Matrix<ET> &mat, std::unique_ptr<int[]> &ipiv) {
+    template <typename MT>
+    void invert(MT &mat, std::unique_ptr<int[]> &ipiv) {
         blaze::getrf(mat, ipiv.get());
         blaze::getri(mat, ipiv.get());
     }
@@ -252,6 +291,34 @@ namespace isle {
         return blaze::trans(U) * diag * U;
     }
 
+    /// Compute the logarithm of the determinant of an LU-decomposed matrix.
+    /**
+     * \tparam MT Specific matrix type, must be a blaze dense matrix.
+     * \param lu Matrix that has been LU-decomposed in place by `blaze::getrf`.
+     * \param ipiv Pivot indices as returned by `blaze::getrf`.
+     * \return \f$y = \log \det(\mathrm{mat})\f$ as a complex number
+     *         projected onto the first Riemann sheet of the logarithm,
+     *         i.e. \f$y \in (-\pi, \pi]\f$.
+     */
+    template <typename MT>
+    auto logdetFromLU(const MT &lu, const int *const ipiv) {
+        using ET = ValueType_t<typename MT::ElementType>;
+        const std::size_t n = lu.rows();
+
+        std::complex<ET> res = 0;
+        bool negDetP = false;  // if true det(P) == -1, else det(P) == +1
+        for (std::size_t i = 0; i < n; ++i) {
+            // determinant of pivot matrix P
+            if (ipiv[i]-1 != blaze::numeric_cast<int>(i)) {
+                negDetP = !negDetP;
+            }
+            // log det of U (diagonal elements)
+            res += std::log(std::complex<ET>{lu(i, i)});
+        }
+        // combine log dets and project to (-pi, pi]
+        return toFirstLogBranch(res + (negDetP ? std::complex<ET>{0, pi<ET>} : 0));
+    }
+
     /// Compute the logarithm of the determinant of a dense matrix; overwrites the input.
     /**
      * \warning This version overwrites the input matrix. See logdet() for a version that
@@ -266,7 +333,6 @@ namespace isle {
     auto ilogdet(MT &matrix) {
         static_assert(blaze::IsDenseMatrix<MT>::value, "logdet needs dense matrices");
 
-        using ET = ValueType_t<typename MT::ElementType>;
         const std::size_t n = matrix.rows();
 #ifndef NDEBUG
         if (n != matrix.columns())
@@ -278,18 +344,7 @@ namespace isle {
         // perform LU decomposition (mat = PLU)
         blaze::getrf(matrix, ipiv.get());
 
-        std::complex<ET> res = 0;
-        bool negDetP = false;  // if true det(P) == -1, else det(P) == +1
-        for (std::size_t i = 0; i < n; ++i) {
-            // determinant of pivot matrix P
-            if (ipiv[i]-1 != blaze::numeric_cast<int>(i)) {
-                negDetP = !negDetP;
-            }
-            // log det of U (diagonal elements)
-            res += std::log(std::complex<ET>{matrix(i, i)});
-        }
-        // combine log dets and project to (-pi, pi]
-        return toFirstLogBranch(res + (negDetP ? std::complex<ET>{0, pi<ET>} : 0));
+        return logdetFromLU(matrix, ipiv.get());
     }
 
     /// Compute the logarithm of the determinant of a dense matrix.
@@ -306,8 +361,9 @@ namespace isle {
     auto logdet(const MT &matrix) {
         static_assert(blaze::IsDenseMatrix<MT>::value, "logdet needs dense matrices");
 
-        using ET = ValueType_t<typename MT::ElementType>;
-        MT mat{matrix};  // need to copy here in order to disambiguate from overload for rvalues
+        // Need to copy here in order to disambiguate from overload for rvalues.
+        // Use ResultType because copies of views like blaze::CustomMatrix share memory.
+        typename MT::ResultType mat{matrix};
         const auto n = mat.rows();
 #ifndef NDEBUG
         if (n != mat.columns())
@@ -319,18 +375,7 @@ namespace isle {
         // perform LU-decomposition, afterwards matrix = PLU
         blaze::getrf(mat, ipiv.get());
 
-        std::complex<ET> res = 0;
-        bool negDetP = false;  // if true det(P) == -1, else det(P) == +1
-        for (std::size_t i = 0; i < n; ++i) {
-            // determinant of pivot matrix P
-            if (ipiv[i]-1 != blaze::numeric_cast<int>(i)) {
-                negDetP = !negDetP;
-            }
-            // log det of U (diagonal elements)
-            res += std::log(std::complex<ET>{mat(i, i)});
-        }
-        // combine log dets and project to (-pi, pi]
-        return toFirstLogBranch(res + (negDetP ? std::complex<ET>{0, pi<ET>} : 0));
+        return logdetFromLU(mat, ipiv.get());
     }
 
 }  // namespace isle
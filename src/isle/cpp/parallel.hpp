@@ -0,0 +1,55 @@
+/** \file
+ * \brief Helpers for shared memory parallelization.
+ */
+
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <cstddef>
+#include <exception>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
+namespace isle {
+    /// Return the maximum number of threads used by parallel regions.
+    inline std::size_t maxThreads() noexcept {
+#ifdef _OPENMP
+        return static_cast<std::size_t>(omp_get_max_threads());
+#else
+        return 1;
+#endif
+    }
+
+    /// Call a function for all indices in `[0, n)`, distributed over OpenMP threads.
+    /**
+     * Exceptions can not propagate out of an OpenMP parallel region.
+     * Hence, exceptions thrown by `f` are caught and the last one to be caught is
+     * rethrown after all threads have finished.
+     *
+     * \param n Number of indices.
+     * \param f Callable which is invoked as `f(i)` with `i` of type `std::size_t`.
+     *          Must be safe to call concurrently for different indices.
+     */
+    template <typename F>
+    void parallelFor(const std::size_t n, F &&f) {
+        std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic)
+        for (std::size_t i = 0; i < n; ++i) {
+            try {
+                f(i);
+            }
+            catch (...) {
+#pragma omp critical(isle_parallelFor_error)
+                error = std::current_exception();
+            }
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+}  // namespace isle
+
+#endif  // ndef PARALLEL_HPP
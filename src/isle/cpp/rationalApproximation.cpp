@@ -0,0 +1,150 @@
+#include "rationalApproximation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace isle {
+    namespace {
+        /// Number of points on which the approximation is checked.
+        constexpr std::size_t NCHECK = 1000;
+
+        /// Maximum number of times the discretisation gets refined.
+        constexpr std::size_t MAX_REFINEMENTS = 8;
+
+        /// Evaluate c + sum_k a_k / (x + sigma_k).
+        double evalPartialFraction(const double constant,
+                                   const std::vector<double> &residues,
+                                   const std::vector<double> &shifts,
+                                   const double x) noexcept {
+            double res = constant;
+            for (std::size_t k = 0; k < residues.size(); ++k)
+                res += residues[k] / (x + shifts[k]);
+            return res;
+        }
+
+        /// Maximum of |r(x) / x^p - 1| on a logarithmic grid.
+        double measureError(const double power, const double lambdaMin, const double lambdaMax,
+                            const double constant,
+                            const std::vector<double> &residues,
+                            const std::vector<double> &shifts) noexcept {
+            const double logMin = std::log(lambdaMin);
+            const double logStep = (std::log(lambdaMax) - logMin) / (NCHECK-1);
+            double maxErr = 0;
+            for (std::size_t i = 0; i < NCHECK; ++i) {
+                const double x = std::exp(logMin + i*logStep);
+                maxErr = std::max(maxErr,
+                                  std::abs(evalPartialFraction(constant, residues, shifts, x)
+                                           / std::pow(x, power) - 1.0));
+            }
+            return maxErr;
+        }
+    }
+
+    RationalApproximation::RationalApproximation(const double power,
+                                                 const double lambdaMin,
+                                                 const double lambdaMax,
+                                                 const double tolerance)
+        : _power{power}, _lambdaMin{lambdaMin}, _lambdaMax{lambdaMax}, _constant{0}
+    {
+        if (!(power >= -1.0 && power < 0.0))
+            throw std::invalid_argument("Power of RationalApproximation must be in [-1, 0).");
+        if (!(lambdaMin > 0.0 && lambdaMax >= lambdaMin))
+            throw std::invalid_argument("Need 0 < lambdaMin <= lambdaMax in RationalApproximation.");
+        if (!(tolerance > 0.0 && tolerance < 1.0))
+            throw std::invalid_argument("Tolerance of RationalApproximation must be in (0, 1).");
+
+        if (power == -1.0) {
+            _residues = {1.0};
+            _shifts = {0.0};
+            _maxRelativeError = 0.0;
+            return;
+        }
+
+        const double alpha = -power;
+        const double prefactor = std::sin(pi<double>*alpha) / pi<double>;
+        const double logTol = std::log(tolerance);
+
+        // error of trapezoidal rule ~ exp(-2 pi^2 / h) because poles are at distance pi
+        double step = 2*pi<double>*pi<double> / (std::log(10.0) - logTol);
+        // terms outside are approximated to relative accuracy ~tolerance by the tails
+        double sMin = std::log(lambdaMin) + logTol/(2-alpha);
+        double sMax = std::log(lambdaMax) - logTol/(1+alpha);
+
+        for (std::size_t refinement = 0; ; ++refinement) {
+            const auto kMin = static_cast<long>(std::floor(sMin/step));
+            const auto kMax = static_cast<long>(std::ceil(sMax/step));
+
+            _residues.clear();
+            _shifts.clear();
+            for (long k = kMin; k <= kMax; ++k) {
+                const double s = k*step;
+                _shifts.push_back(std::exp(s));
+                _residues.push_back(prefactor*step*std::exp((1-alpha)*s));
+            }
+
+            // for s << log(x), terms are ~e^{(1-alpha)s}/x, sum them up into a pole at zero
+            const double sLow = (kMin-1)*step;
+            _shifts.push_back(0.0);
+            _residues.push_back(prefactor*step*std::exp((1-alpha)*sLow)
+                                / (1 - std::exp(-(1-alpha)*step)));
+            // for s >> log(x), terms are ~e^{-alpha s}, sum them up into a constant
+            const double sHigh = (kMax+1)*step;
+            _constant = prefactor*step*std::exp(-alpha*sHigh) / (1 - std::exp(-alpha*step));
+
+            _maxRelativeError = measureError(power, lambdaMin, lambdaMax,
+                                             _constant, _residues, _shifts);
+            if (_maxRelativeError <= tolerance)
+                break;
+            if (refinement == MAX_REFINEMENTS)
+                throw std::runtime_error("Could not construct RationalApproximation with requested tolerance.");
+
+            step *= 0.75;
+            sMin -= 1.0;
+            sMax += 1.0;
+        }
+    }
+
+    double RationalApproximation::operator()(const double x) const noexcept {
+        return evalPartialFraction(_constant, _residues, _shifts, x);
+    }
+
+    SolverInfo RationalApproximation::apply(const LinearOperator &op, const CDVector &in,
+                                            CDVector &out, const double tolerance,
+                                            const std::size_t maxIterations) const {
+        std::vector<CDVector> xs;
+        const SolverInfo info = multiShiftConjugateGradient(op, in, _shifts, xs,
+                                                            tolerance, maxIterations);
+        out = _constant*in;
+        for (std::size_t k = 0; k < xs.size(); ++k)
+            out += _residues[k]*xs[k];
+        return info;
+    }
+
+    double RationalApproximation::power() const noexcept {
+        return _power;
+    }
+
+    double RationalApproximation::lambdaMin() const noexcept {
+        return _lambdaMin;
+    }
+
+    double RationalApproximation::lambdaMax() const noexcept {
+        return _lambdaMax;
+    }
+
+    double RationalApproximation::constant() const noexcept {
+        return _constant;
+    }
+
+    const std::vector<double> &RationalApproximation::residues() const noexcept {
+        return _residues;
+    }
+
+    const std::vector<double> &RationalApproximation::shifts() const noexcept {
+        return _shifts;
+    }
+
+    double RationalApproximation::maxRelativeError() const noexcept {
+        return _maxRelativeError;
+    }
+}  // namespace isle
@@ -0,0 +1,99 @@
+/** \file
+ * \brief Rational approximations of powers for rational HMC.
+ */
+
+#ifndef RATIONAL_APPROXIMATION_HPP
+#define RATIONAL_APPROXIMATION_HPP
+
+#include <vector>
+
+#include "math.hpp"
+#include "krylov.hpp"
+
+namespace isle {
+    /// Partial fraction approximation of \f$x^p\f$ for \f$-1 \le p < 0\f$ on a finite interval.
+    /**
+     * Approximates
+     \f[
+     x^p \approx r(x) = c + \sum_{k} \frac{a_k}{x + \sigma_k}
+     \f]
+     * with positive residues \f$a_k\f$ and non-negative shifts \f$\sigma_k\f$
+     * for \f$x \in [\lambda_\mathrm{min}, \lambda_\mathrm{max}]\f$.
+     * This way, \f$r(A) b\f$ for a hermitian positive definite matrix A can be computed
+     * using a single multiShiftConjugateGradient() for all poles.
+     *
+     * Shifts and residues are constructed from the integral representation
+     \f[
+     x^{-\alpha} = \frac{\sin(\pi\alpha)}{\pi} \int_{-\infty}^{\infty}\mathrm{d}s\,
+                   \frac{e^{(1-\alpha)s}}{e^s + x}
+     \f]
+     * with \f$\alpha = -p\f$ by applying the trapezoidal rule in s,
+     * which converges exponentially in the step size.
+     * The sum is truncated at the ends where the terms of the sum are geometric series
+     * to the required accuracy, those tails are summed up into a constant c and
+     * a pole at \f$\sigma = 0\f$.
+     * The number of poles grows like the square of the number of digits and only
+     * logarithmically with \f$\lambda_\mathrm{max}/\lambda_\mathrm{min}\f$.
+     * \f$p = -1\f$ is represented exactly with a single pole.
+     */
+    class RationalApproximation {
+    public:
+        /// Construct approximation for given power and spectral range.
+        /**
+         * \param power Exponent p, must be in \f$[-1, 0)\f$.
+         * \param lambdaMin Lower end of the interval.
+         * \param lambdaMax Upper end of the interval.
+         * \param tolerance Maximum relative error \f$|r(x)/x^p - 1|\f$ in the interval.
+         * \throws std::invalid_argument if any of the parameters are out of range.
+         */
+        RationalApproximation(double power, double lambdaMin, double lambdaMax,
+                              double tolerance);
+
+        /// Evaluate the approximation for a number.
+        double operator()(double x) const noexcept;
+
+        /// Compute \f$r(A) \cdot \mathrm{in}\f$ for a hermitian positive definite A.
+        /**
+         * \param op Applies A to a vector.
+         * \param in Vector to apply r(A) to.
+         * \param out Set to \f$r(A) \cdot \mathrm{in}\f$.
+         * \param tolerance Tolerance for multiShiftConjugateGradient().
+         * \param maxIterations Maximum number of iterations.
+         * \returns Info about the solve.
+         */
+        SolverInfo apply(const LinearOperator &op, const CDVector &in, CDVector &out,
+                         double tolerance, std::size_t maxIterations) const;
+
+        /// Return the exponent p.
+        double power() const noexcept;
+
+        /// Return the lower end of the interval.
+        double lambdaMin() const noexcept;
+
+        /// Return the upper end of the interval.
+        double lambdaMax() const noexcept;
+
+        /// Return the constant term c.
+        double constant() const noexcept;
+
+        /// Return the residues \f$a_k\f$.
+        const std::vector<double> &residues() const noexcept;
+
+        /// Return the shifts \f$\sigma_k\f$.
+        const std::vector<double> &shifts() const noexcept;
+
+        /// Return the maximum relative error measured on a grid in the interval.
+        double maxRelativeError() const noexcept;
+
+    private:
+        double _power;  ///< Exponent p.
+        double _lambdaMin;  ///< Lower end of the interval.
+        double _lambdaMax;  ///< Upper end of the interval.
+        double _constant;  ///< Constant term c.
+        std::vector<double> _residues;  ///< Residues a_k.
+        std::vector<double> _shifts;  ///< Shifts sigma_k.
+        double _maxRelativeError;  ///< Measured relative error.
+    };
+}  // namespace isle
+
+#endif  // ndef RATIONAL_APPROXIMATION_HPP
@@ -0,0 +1,99 @@
+#include "stabilizedProduct.hpp"
+
+namespace isle {
+    StabilizedProduct::StabilizedProduct(const std::size_t nx, const std::size_t interval)
+        : _nx{nx}, _interval{interval}, _npending{0}, _identity{true},
+          _pending(nx, nx), _u(nx, nx), _d(nx), _v(nx, nx) { }
+
+    void StabilizedProduct::reset() noexcept {
+        _npending = 0;
+        _identity = true;
+    }
+
+    void StabilizedProduct::stabilize() {
+        if (_npending == 0) {
+            if (_identity) {
+                // nothing has been multiplied yet
+                _u = IdMatrix<std::complex<double>>(_nx);
+                _d = 1.0;
+                _v = IdMatrix<std::complex<double>>(_nx);
+            }
+            return;
+        }
+
+        if (!_identity) {
+            // B U D, scaling the columns by D keeps them separated in the QR-decomposition
+            _pending = (_pending*_u) % blaze::expand(blaze::trans(_d), _nx);
+        }
+
+        CDMatrix r;
+        blaze::qr(_pending, _u, r);
+        _d = blaze::abs(blaze::diagonal(r));
+        // V = D^{-1} R V
+        if (_identity)
+            _v = blaze::expand(blaze::inv(_d), _nx) % r;
+        else
+            _v = (blaze::expand(blaze::inv(_d), _nx) % r) * _v;
+
+        _npending = 0;
+        _identity = false;
+    }
+
+    const CDMatrix &StabilizedProduct::U() {
+        stabilize();
+        return _u;
+    }
+
+    const DVector &StabilizedProduct::D() {
+        stabilize();
+        return _d;
+    }
+
+    const CDMatrix &StabilizedProduct::V() {
+        stabilize();
+        return _v;
+    }
+
+    CDMatrix StabilizedProduct::_splitOnePlus(DVector &db) {
+        // D = D_b D_s with D_b = max(D, 1) and D_s = min(D, 1)
+        db.resize(_nx, false);
+        DVector ds(_nx);
+        for (std::size_t i = 0; i < _nx; ++i) {
+            if (_d[i] > 1.0) {
+                db[i] = _d[i];
+                ds[i] = 1.0;
+            }
+            else {
+                db[i] = 1.0;
+                ds[i] = _d[i];
+            }
+        }
+
+        // 1 + U D V = U D_b (D_b^{-1} U^dagger + D_s V)
+        return blaze::expand(blaze::inv(db), _nx) % blaze::ctrans(_u)
+            + blaze::expand(ds, _nx) % _v;
+    }
+
+    std::complex<double> StabilizedProduct::logdetOnePlus() {
+        stabilize();
+
+        DVector db;
+        CDMatrix x = _splitOnePlus(db);
+        return toFirstLogBranch(ilogdet(x) + logdet(_u) + blaze::sum(blaze::log(db)));
+    }
+
+    CDMatrix StabilizedProduct::invOnePlus() {
+        stabilize();
+
+        DVector db;
+        CDMatrix x = _splitOnePlus(db);
+        auto ipiv = std::make_unique<int[]>(_nx);
+        invert(x, ipiv);
+        // (1 + U D V)^{-1} = (D_b^{-1} U^dagger + D_s V)^{-1} D_b^{-1} U^dagger
+        return x * (blaze::expand(blaze::inv(db), _nx) % blaze::ctrans(_u));
+    }
+
+    std::size_t StabilizedProduct::nx() const noexcept {
+        return _nx;
+    }
+}  // namespace isle
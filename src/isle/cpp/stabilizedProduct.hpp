@@ -0,0 +1,105 @@
+/** \file
+ * \brief Numerically stable products of many matrices.
+ */
+
+#ifndef STABILIZED_PRODUCT_HPP
+#define STABILIZED_PRODUCT_HPP
+
+#include "math.hpp"
+
+namespace isle {
+
+    /// Accumulate a long product of matrices in a numerically stable way.
+    /**
+     * Computes \f$B = B_{n-1} \cdots B_1 B_0\f$ where factors are multiplied
+     * onto the product from the left.
+     * The product is stored in the form \f$B = U D V\f$ where \f$U\f$ is unitary,
+     * \f$D\f$ is a real, positive, diagonal matrix, and \f$V\f$ is well conditioned.
+     * All scales of the product are collected in \f$D\f$ such that they are never
+     * mixed up by a matrix multiplication.
+     *
+     * Factors are multiplied onto a plain product of at most `interval` matrices
+     * which is folded into the decomposition by means of a QR-decomposition
+     * every `interval` factors.
+     * `interval` thus needs to be small enough to not lose precision in the
+     * plain products.
+     * An interval of 0 means that the decomposition is only computed when
+     * accessing the result.
+     *
+     * Products where the factors are multiplied from the right can be built by
+     * passing in the transposes of all factors.
+     * StabilizedProduct::logdetOnePlus() is invariant under transposition and the
+     * result of StabilizedProduct::invOnePlus() only needs to be transposed in that case.
+     */
+    class StabilizedProduct {
+    public:
+        /// Start with an empty product (the identity).
+        /**
+         * \param nx Number of rows and columns of all factors.
+         * \param interval Number of factors between QR-decompositions.
+         */
+        StabilizedProduct(std::size_t nx, std::size_t interval);
+
+        /// Reset to the identity in order to start a new product.
+        void reset() noexcept;
+
+        /// Multiply a factor onto the product from the left.
+        /**
+         * \param b Arbitrary dense or sparse matrix of size `nx x nx`.
+         */
+        template <typename MT>
+        void leftMultiply(const MT &b) {
+            if (_npending == 0)
+                _pending = b;
+            else
+                _pending = b*_pending;
+
+            if (++_npending == _interval)
+                stabilize();
+        }
+
+        /// Fold all pending factors into the UDV-decomposition.
+        void stabilize();
+
+        /// Return the unitary matrix U, calls stabilize().
+        const CDMatrix &U();
+        /// Return the diagonal of D, calls stabilize().
+        const DVector &D();
+        /// Return matrix V, calls stabilize().
+        const CDMatrix &V();
+
+        /// Compute \f$\log(\det(1 + B))\f$.
+        /**
+         * Splits the scales in D into large and small ones such that the identity
+         * can be added without losing precision.
+         * \return Value projected onto the first branch of the logarithm.
+         */
+        std::complex<double> logdetOnePlus();
+
+        /// Compute \f$(1 + B)^{-1}\f$.
+        /**
+         * Uses the same splitting of scales as StabilizedProduct::logdetOnePlus().
+         */
+        CDMatrix invOnePlus();
+
+        /// Number of rows and columns of the factors.
+        std::size_t nx() const noexcept;
+
+    private:
+        std::size_t _nx;  ///< Size of the factors.
+        std::size_t _interval;  ///< Number of factors between QR-decompositions.
+        std::size_t _npending;  ///< Number of factors in _pending.
+        bool _identity;  ///< true if the decomposition is still the identity.
+
+        CDMatrix _pending;  ///< Plain product of factors that are not decomposed yet.
+        CDMatrix _u;  ///< Unitary matrix U.
+        DVector _d;  ///< Diagonal of D.
+        CDMatrix _v;  ///< Matrix V.
+
+        /// Compute \f$D_b^{-1} U^\dagger + D_s V\f$ and \f$D_b\f$, see logdetOnePlus().
+        CDMatrix _splitOnePlus(DVector &db);
+    };
+
+}  // namespace isle
+
+#endif  // ndef STABILIZED_PRODUCT_HPP
@@ -0,0 +1,123 @@
+#include "stochasticTrace.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "parallel.hpp"
+
+using namespace std::complex_literals;
+
+namespace isle {
+    namespace {
+        /// Fill a vector with noise from a generator seeded by seed and index.
+        void drawNoise(CDVector &eta, const NoiseType noise,
+                       const std::uint64_t seed, const std::size_t index) {
+            std::seed_seq seq{static_cast<std::uint32_t>(seed),
+                              static_cast<std::uint32_t>(seed >> 32),
+                              static_cast<std::uint32_t>(index),
+                              static_cast<std::uint32_t>(static_cast<std::uint64_t>(index) >> 32)};
+            std::mt19937_64 rng{seq};
+
+            switch (noise) {
+            case NoiseType::Z2: {
+                std::uniform_int_distribution<int> dist{0, 1};
+                for (auto &x : eta)
+                    x = dist(rng) == 0 ? 1.0 : -1.0;
+                break;
+            }
+            case NoiseType::Z4: {
+                static constexpr std::complex<double> values[4] = {1.0, 1.0i, -1.0, -1.0i};
+                std::uniform_int_distribution<int> dist{0, 3};
+                for (auto &x : eta)
+                    x = values[dist(rng)];
+                break;
+            }
+            case NoiseType::GAUSSIAN: {
+                std::normal_distribution<double> dist{0.0, 1.0};
+                for (auto &x : eta)
+                    x = dist(rng);
+                break;
+            }
+            }
+        }
+
+        template <typename HFM>
+        CDMatrix stochasticTraceImpl(const HFM &hfm, const CDVector &phi,
+                                     const Species species, const std::vector<CDMatrix> &operators,
+                                     const std::size_t nnoise, const std::uint64_t seed,
+                                     const NoiseType noise, const Dilution dilution) {
+            const std::size_t nx = hfm.nx();
+            const std::size_t nt = getNt(phi, nx);
+            if (dilution.time == 0 || dilution.time > nt)
+                throw std::invalid_argument("Number of time partitions must be in [1, nt].");
+            if (dilution.space == 0 || dilution.space > nx)
+                throw std::invalid_argument("Number of spatial partitions must be in [1, nx].");
+            for (const auto &op : operators) {
+                if (op.rows() != nx || op.columns() != nx)
+                    throw std::invalid_argument("Operators must be nx x nx matrices.");
+            }
+
+            // pieces of noise vector s are rows [s*npart, (s+1)*npart)
+            const std::size_t npart = dilution.time*dilution.space;
+            const auto partition = [&dilution](const std::size_t t, const std::size_t x) {
+                return (t % dilution.time)*dilution.space + x % dilution.space;
+            };
+
+            CDMatrix rhss(nnoise*npart, nx*nt, std::complex<double>{0.0});
+            parallelFor(nnoise, [&](const std::size_t s) {
+                CDVector eta(nx*nt);
+                drawNoise(eta, noise, seed, s);
+                for (std::size_t t = 0; t < nt; ++t)
+                    for (std::size_t x = 0; x < nx; ++x)
+                        rhss(s*npart + partition(t, x), t*nx + x) = eta[t*nx + x];
+            });
+
+            // Split the right hand sides into one block per thread and solve the blocks
+            // independently. Each solveM repeats the O(nt nx^3) setup which is cheap
+            // compared to the solves as long as there are many right hand sides per block.
+            const std::size_t nrhs = rhss.rows();
+            CDMatrix sol(nrhs, nx*nt);
+            if (nrhs > 0) {
+                const std::size_t blockSize = (nrhs + maxThreads() - 1) / maxThreads();
+                // blocks write to disjoint rows of sol
+                parallelFor((nrhs + blockSize - 1) / blockSize, [&](const std::size_t b) {
+                    const std::size_t first = b*blockSize;
+                    const std::size_t n = std::min(blockSize, nrhs-first);
+                    const CDMatrix block = blaze::submatrix(rhss, first, 0, n, nx*nt);
+                    blaze::submatrix(sol, first, 0, n, nx*nt) = solveM(hfm, phi, species, block);
+                });
+            }
+
+            // W_s = sum_p sum_t x_{p,t} eta_{p,t}^dagger, then eta^dagger Gamma x = tr(Gamma W)
+            CDMatrix estimates(operators.size(), nnoise);
+            parallelFor(nnoise, [&](const std::size_t s) {
+                CDMatrix W(nx, nx, std::complex<double>{0.0});
+                for (std::size_t t = 0; t < nt; ++t) {
+                    for (std::size_t x = 0; x < nx; ++x) {
+                        const std::size_t row = s*npart + partition(t, x);
+                        const std::complex<double> etaConj = std::conj(rhss(row, t*nx + x));
+                        for (std::size_t y = 0; y < nx; ++y)
+                            W(y, x) += sol(row, t*nx + y)*etaConj;
+                    }
+                }
+                for (std::size_t k = 0; k < operators.size(); ++k)
+                    estimates(k, s) = blaze::sum(operators[k] % blaze::trans(W));
+            });
+            return estimates;
+        }
+    }
+
+    CDMatrix stochasticTrace(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                             const Species species, const std::vector<CDMatrix> &operators,
+                             const std::size_t nnoise, const std::uint64_t seed,
+                             const NoiseType noise, const Dilution dilution) {
+        return stochasticTraceImpl(hfm, phi, species, operators, nnoise, seed, noise, dilution);
+    }
+
+    CDMatrix stochasticTrace(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                             const Species species, const std::vector<CDMatrix> &operators,
+                             const std::size_t nnoise, const std::uint64_t seed,
+                             const NoiseType noise, const Dilution dilution) {
+        return stochasticTraceImpl(hfm, phi, species, operators, nnoise, seed, noise, dilution);
+    }
+}  // namespace isle
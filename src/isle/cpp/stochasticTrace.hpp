@@ -0,0 +1,84 @@
+/** \file
+ * \brief Stochastic estimation of traces involving the inverse fermion matrix.
+ */
+
+#ifndef STOCHASTIC_TRACE_HPP
+#define STOCHASTIC_TRACE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+#include "species.hpp"
+#include "hubbardFermiMatrixDia.hpp"
+#include "hubbardFermiMatrixExp.hpp"
+
+namespace isle {
+
+    /// Distribution of the elements of noise vectors for stochastic estimators.
+    enum class NoiseType {
+        Z2,  ///< Uniformly from \f$\{\pm 1\}\f$.
+        Z4,  ///< Uniformly from \f$\{\pm 1, \pm i\}\f$.
+        GAUSSIAN  ///< Real, normally distributed with mean 0 and variance 1.
+    };
+
+    /// Partition noise vectors into pieces with disjoint support.
+    /**
+     * Time slice t belongs to time partition `t % time` and site x
+     * belongs to spatial partition `x % space`.
+     * Each noise vector is split into `time*space` pieces, one for every combination
+     * of time and spatial partition, which are solved for independently.
+     * This removes the contributions of off-diagonal elements within different partitions
+     * from the estimate at the cost of more solves.
+     * Full dilution (`time=nt, space=nx`) gives the exact result.
+     */
+    struct Dilution {
+        std::size_t time = 1;  ///< Number of time partitions.
+        std::size_t space = 1;  ///< Number of spatial partitions.
+    };
+
+    /// Estimate \f$\mathrm{tr}(\Gamma M^{-1})\f$ for a set of spatial operators.
+    /**
+     * Uses a Hutchinson-type estimator
+     \f[
+     \mathrm{tr}(\Gamma M^{-1}) \approx \sum_{p} \eta_p^\dagger \Gamma M^{-1} \eta_p
+     \f]
+     * where \f$\eta_p\f$ are the diluted pieces of a noise vector \f$\eta\f$ with
+     * \f$\langle \eta \eta^\dagger \rangle = 1\f$.
+     * Each operator \f$\Gamma\f$ is an `nx x nx` matrix and acts on every time slice,
+     * i.e. the full operator is \f$\mathbb{1}_{N_t} \otimes \Gamma\f$.
+     *
+     * The pieces of all noise vectors are split into one block per thread and each
+     * block is solved for at once using solveM().
+     * Noise generation, solves, and reductions are all distributed over threads.
+     * Each noise vector is generated from its own random number generator seeded from
+     * `seed` and the index of the vector, so results do not depend on the number of threads.
+     *
+     * \param hfm Represents matrix M.
+     * \param phi Gauge configuration needed to construct M.
+     * \param species Select whether to use particles or holes.
+     * \param operators Spatial operators \f$\Gamma\f$.
+     * \param nnoise Number of noise vectors.
+     * \param seed Seed for the random number generators.
+     * \param noise Distribution of the noise.
+     * \param dilution How to split the noise vectors.
+     * \returns Matrix of shape `(operators.size(), nnoise)` containing the estimate of
+     *          each operator for each noise vector.
+     */
+    CDMatrix stochasticTrace(const HubbardFermiMatrixDia &hfm, const CDVector &phi,
+                             Species species, const std::vector<CDMatrix> &operators,
+                             std::size_t nnoise, std::uint64_t seed,
+                             NoiseType noise, Dilution dilution);
+
+    /// Estimate \f$\mathrm{tr}(\Gamma M^{-1})\f$ for a set of spatial operators.
+    /**
+     * \see `stochasticTrace(const HubbardFermiMatrixDia&, const CDVector&, Species, const std::vector<CDMatrix>&, std::size_t, std::uint64_t, NoiseType, Dilution)`
+     */
+    CDMatrix stochasticTrace(const HubbardFermiMatrixExp &hfm, const CDVector &phi,
+                             Species species, const std::vector<CDMatrix> &operators,
+                             std::size_t nnoise, std::uint64_t seed,
+                             NoiseType noise, Dilution dilution);
+
+}  // namespace isle
+
+#endif  // ndef STOCHASTIC_TRACE_HPP
@@ -8,8 +8,8 @@ HMC evolvers to produce new configurations.
 
 from .alternator import Alternator  # (unused import) pylint: disable=W0611
 from .evolver import Evolver  # (unused import) pylint: disable=W0611
-from .leapfrog import ConstStepLeapfrog, LinearStepLeapfrog  # (unused import) pylint: disable=W0611
-from .hubbard import TwoPiJumps, UniformJump  # (unused import) pylint: disable=W0611
+from .leapfrog import ConstStepLeapfrog, LinearStepLeapfrog, MultiTimescaleLeapfrog  # (unused import) pylint: disable=W0611
+from .hubbard import TwoPiJumps, UniformJump, LocalMetropolis  # (unused import) pylint: disable=W0611
 from .autotuner import LeapfrogTuner, LeapfrogTunerLength  # (unused import) pylint: disable=W0611
 from .stage import EvolutionStage  # (unused import) pylint: disable=W0611
 
@@ -16,7 +16,7 @@ from scipy.optimize import curve_fit
 
 from .evolver import Evolver
 from .selector import BinarySelector
-from .leapfrog import ConstStepLeapfrog
+from .leapfrog import ConstStepLeapfrog, refreshPseudofermions
 from .transform import backwardTransform, forwardTransform
 from .. import Vector, leapfrog
 from ..collection import extendListInDict
@@ -773,6 +773,7 @@ class LeapfrogTuner(Evolver):  # pylint: disable=too-many-instance-attributes
         """
 
         params = self.currentParams()
+        stage = refreshPseudofermions(self.action, stage, self.transform, self.rng)
 
         # get start phi for MD integration
         phiMD, logdetJ = backwardTransform(self.transform, stage)
@@ -1314,6 +1315,7 @@ class LeapfrogTunerLength(Evolver):  # pylint: disable=too-many-instance-attribu
         """
 
         params = self.currentParams()
+        stage = refreshPseudofermions(self.action, stage, self.transform, self.rng)
 
         # get start phi for MD integration
         phiMD, logdetJ = backwardTransform(self.transform, stage)
@@ -185,6 +185,139 @@ class UniformJump(Evolver):
   acceptance rate = {np.mean(self.accepted)}"""
 
 
+class LocalMetropolis(Evolver):
+    r"""! \ingroup evolvers
+    Metropolis updates of the configuration at single lattice sites.
+
+    Sweeps over all lattice sites and proposes to shift the configuration at each site
+    by a random amount drawn uniformly from `[-maxStep, maxStep]`.
+    The change in action is computed in \f$\mathcal{O}(N_x)\f$ from equal-time
+    Green's functions which are updated with rank-1 updates, see isle.cpp.LocalUpdate.
+    The conjugate momentum is not changed.
+
+    The action must consist of exactly one isle.action.HubbardGaugeAction and one
+    HubbardFermiAction with DIA or EXP hopping, algorithm DIRECT_SINGLE or DIRECT_SQUARE,
+    and the particle/hole basis.
+    All parameters of the updates are taken from those actions such that the change
+    in action used for accept/reject is always consistent with `action`.
+    A `ValueError` is raised for any other action.
+
+    Local updates can be alternated with HMC trajectories using an Alternator:
+    ```{.py}
+    evolver = isle.evolver.Alternator((
+        (10, isle.evolver.ConstStepLeapfrog(action, length, nstep, rng)),
+        (1, isle.evolver.LocalMetropolis(1, 0.5, action, lattice, rng))
+    ))
+    ```
+    """
+
+    def __init__(self, nsweeps, maxStep, action, lattice, rng,
+                 recomputeInterval=4, delay=1):
+        r"""!
+        \param nsweeps Number of sweeps over the whole lattice per call to evolve().
+        \param maxStep Maximum change of the configuration at a single site.
+        \param action Instance of isle.Action, see class description.
+        \param lattice Lattice the simulation runs on.
+        \param rng Central random number generator for the run.
+        \param recomputeInterval Number of time slices between recomputations of the
+                                 Green's functions from scratch.
+        \param delay Maximum number of accepted updates that are collected
+                     before applying them to the Green's functions.
+        """
+
+        self.nsweeps = nsweeps
+        self.maxStep = maxStep
+        self.rng = rng
+        self.acceptanceRates = []
+
+        hfm, utilde = _localUpdateParameters(action)
+        if hfm.nx() != lattice.nx():
+            raise ValueError(f"Lattice has {lattice.nx()} sites but the fermion action "
+                             f"has {hfm.nx()}")
+        self._updater = isle.LocalUpdate(hfm, utilde, recomputeInterval, delay)
+
+    def evolve(self, stage):
+        r"""!
+        Evolve a configuration, momentum remains unchanged.
+        \param stage EvolutionStage at the beginning of this evolution step.
+        \returns EvolutionStage at the end of this evolution step.
+        """
+
+        seed = int(self.rng.choice(np.iinfo(np.int32).max))
+        phi, deltaAction, accepted = self._updater.sweep(stage.phi, self.nsweeps,
+                                                         self.maxStep, seed)
+        self.acceptanceRates.append(accepted / (self.nsweeps*len(phi)))
+
+        if accepted > 0:
+            return stage.accept(phi, stage.actVal + deltaAction)
+        return stage.reject()
+
+    def save(self, h5group, _manager):
+        r"""!
+        Save the evolver to HDF5.
+        Has to be the inverse of Evolver.fromH5().
+        \param h5group HDF5 group to save to.
+        \param _manager \e ignored.
+        """
+        h5group["nsweeps"] = self.nsweeps
+        h5group["maxStep"] = self.maxStep
+        h5group["recomputeInterval"] = self._updater.recomputeInterval()
+        h5group["delay"] = self._updater.delay()
+
+    @classmethod
+    def fromH5(cls, h5group, _manager, action, lattice, rng):
+        r"""!
+        Construct from HDF5.
+        \param h5group HDF5 group to load parameters from.
+        \param _manager \e ignored.
+        \param action Action to use.
+        \param lattice Lattice the simulation runs on.
+        \param rng Central random number generator for the run.
+        \returns A newly constructed LocalMetropolis evolver.
+        """
+        return cls(h5group["nsweeps"][()], h5group["maxStep"][()], action, lattice, rng,
+                   recomputeInterval=h5group["recomputeInterval"][()],
+                   delay=h5group["delay"][()])
+
+    def report(self):
+        r"""!
+        Return a string summarizing the evolution since the evolver
+        was constructed including by fromH5.
+        """
+        return f"""<LocalMetropolis> (0x{id(self):x})
+  nsweeps = {self.nsweeps}, maxStep = {self.maxStep}
+  acceptance rate per site = {np.mean(self.acceptanceRates)}"""
+
+
+def _flattenAction(action):
+    """!Return a list of all summands of an action, descending into SumActions."""
+    if isinstance(action, isle.action.SumAction):
+        return [summand for act in action for summand in _flattenAction(act)]
+    return [action]
+
+
+def _localUpdateParameters(action):
+    r"""!
+    Extract the fermion matrix and on-site coupling for LocalMetropolis from an action.
+    \returns Tuple of (fermion matrix, utilde).
+    \throws ValueError if the action is not supported by LocalMetropolis.
+    """
+
+    summands = _flattenAction(action)
+    gauge = [act for act in summands if isinstance(act, isle.action.HubbardGaugeAction)]
+    fermion = [act for act in summands
+               if isinstance(act, (isle.action.HubbardFermiActionDiaDirsingleOne,
+                                   isle.action.HubbardFermiActionDiaDirsquareOne,
+                                   isle.action.HubbardFermiActionExpDirsingleOne,
+                                   isle.action.HubbardFermiActionExpDirsquareOne))]
+    if len(gauge) != 1 or len(fermion) != 1 or len(summands) != 2:
+        raise ValueError("LocalMetropolis requires an action consisting of exactly one "
+                         "HubbardGaugeAction and one HubbardFermiAction with DIA or EXP "
+                         "hopping in the particle/hole basis, got "
+                         + ", ".join(type(act).__name__ for act in summands))
+    return fermion[0].hfm(), gauge[0].utilde
+
+
 class _HubbardActionShortcut:
     """!
     Evaulates actions if a shortcut can be taken.
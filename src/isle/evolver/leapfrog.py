@@ -8,10 +8,34 @@ import numpy as np
 from .evolver import Evolver
 from .transform import backwardTransform, forwardTransform
 from .selector import BinarySelector
-from .. import Vector, leapfrog
+from .. import Vector, leapfrog, multiTimescaleLeapfrog
 from ..collection import hingeRange
 
 
+def refreshPseudofermions(action, stage, transform, rng):
+    r"""!
+    Draw new pseudofermions and re-evaluate the action if the action has any.
+
+    Must be called at the beginning of every trajectory because the value of the
+    action at the start of the trajectory changes with the pseudofermions.
+    \param action Instance of isle.Action used for molecular dynamics.
+    \param stage EvolutionStage at the beginning of the trajectory.
+    \param transform Transform of the evolver, must be None if the action has pseudofermions.
+    \param rng Central random number generator for the run.
+    \returns `stage` if the action has no pseudofermions, otherwise a new EvolutionStage
+              with updated action value.
+    """
+
+    if not action.hasPseudofermions():
+        return stage
+    if transform is not None:
+        raise ValueError("Actions with pseudofermions do not support transforms")
+
+    action.refreshPseudofermions(stage.phi, int(rng.choice(np.iinfo(np.int32).max)))
+    return stage.__class__(stage.phi, action.eval(stage.phi), stage.trajPoint,
+                           dict(stage.nonActWeigths()), stage.extra)
+
+
 class ConstStepLeapfrog(Evolver):
     r"""! \ingroup evolvers
     A leapfrog evolver with constant parameters.
@@ -42,6 +66,8 @@ class ConstStepLeapfrog(Evolver):
         \returns EvolutionStage at the end of this evolution step.
         """
 
+        stage = refreshPseudofermions(self.action, stage, self.transform, self.rng)
+
         # get start phi for MD integration
         phiMD, logdetJ = backwardTransform(self.transform, stage)
         if self.transform is not None and "logdetJ" not in stage.logWeights:
@@ -105,6 +131,115 @@ class ConstStepLeapfrog(Evolver):
   acceptance rate = {np.mean(self.trajPoints)}"""
 
 
+class MultiTimescaleLeapfrog(Evolver):
+    r"""! \ingroup evolvers
+    A leapfrog evolver which integrates parts of the action with different step sizes.
+
+    See isle.multiTimescaleLeapfrog for the integration scheme.
+    Use it for example with a Hasenbusch split fermion action
+    (isle.action.HubbardFermiAction[Dia,Exp]HasenbuschOne plus
+    isle.action.HubbardFermiAction[Dia,Exp]PseudofermionOne with scaled hopping)
+    to integrate the expensive ratio on a coarse and the cheap heavy part on a fine time scale.
+    """
+
+    def __init__(self, action, length, nsteps, timescales, rng, transform=None):
+        r"""!
+        \param action Instance of isle.action.SumAction to use for molecular dynamics.
+        \param length Length of the MD trajectory.
+        \param nsteps Number of MD steps on each time scale per step on the next coarser one.
+                      `nsteps[0]` is the number of steps on the coarsest scale per trajectory.
+        \param timescales Time scale of each summand of `action`, 0 is the coarsest.
+        \param rng Central random number generator for the run.
+        \param transform (Instance of isle.evolver.transform.Transform)
+                         Used this to transform a configuration after MD integration
+                         but before Metropolis accept/reject.
+        """
+        self.action = action
+        self.length = length
+        self.nsteps = list(nsteps)
+        self.timescales = list(timescales)
+        self.rng = rng
+        self.selector = BinarySelector(rng)
+        self.transform = transform
+        self.trajPoints = []
+
+    def evolve(self, stage):
+        r"""!
+        Run multi time scale leapfrog integrator.
+        \param stage EvolutionStage at the beginning of this evolution step.
+        \returns EvolutionStage at the end of this evolution step.
+        """
+
+        stage = refreshPseudofermions(self.action, stage, self.transform, self.rng)
+
+        # get start phi for MD integration
+        phiMD, logdetJ = backwardTransform(self.transform, stage)
+        if self.transform is not None and "logdetJ" not in stage.logWeights:
+            stage.logWeights["logdetJ"] = logdetJ
+
+        # do MD integration
+        pi = Vector(self.rng.normal(0, 1, len(stage.phi))+0j)
+
+        phiMD1, pi1, actValMD1 = multiTimescaleLeapfrog(phiMD, pi, self.action, self.timescales,
+                                                        self.length, self.nsteps)
+
+        # transform to MC manifold
+        phi1, actVal1, logdetJ1 = forwardTransform(self.transform, phiMD1, actValMD1)
+
+        # accept/reject on MC manifold
+        energy0 = stage.sumLogWeights()+0.5*np.linalg.norm(pi)**2
+        energy1 = actVal1+logdetJ1+0.5*np.linalg.norm(pi1)**2
+
+        trajPoint = self.selector.selectTrajPoint(energy0, energy1)
+        self.trajPoints.append(trajPoint)
+
+        logWeights = None if self.transform is None \
+            else {"logdetJ": (logdetJ, logdetJ1)[trajPoint]}
+        return stage.accept(phi1, actVal1, logWeights) if trajPoint == 1 \
+            else stage.reject()
+
+    def save(self, h5group, manager):
+        r"""!
+        Save the evolver to HDF5.
+        \param h5group HDF5 group to save to.
+        \param manager EvolverManager whose purview to save the evolver in.
+        """
+        h5group["length"] = self.length
+        h5group["nsteps"] = self.nsteps
+        h5group["timescales"] = self.timescales
+        if self.transform is not None:
+            manager.save(self.transform, h5group.create_group("transform"))
+
+    @classmethod
+    def fromH5(cls, h5group, manager, action, lattice, rng):
+        r"""!
+        Construct from HDF5.
+        \param h5group HDF5 group to load parameters from.
+        \param manager EvolverManager responsible for the HDF5 file.
+        \param action Action to use.
+        \param lattice Lattice the simulation runs on.
+        \param rng Central random number generator for the run.
+        \returns A newly constructed evolver.
+        """
+        if "transform" in h5group:
+            transform = manager.load(h5group[f"transform"], action, lattice, rng)
+        else:
+            transform = None
+        return cls(action, h5group["length"][()],
+                   [int(n) for n in h5group["nsteps"][()]],
+                   [int(ts) for ts in h5group["timescales"][()]],
+                   rng, transform)
+
+    def report(self):
+        r"""!
+        Return a string summarizing the evolution since the evolver
+        was constructed including by fromH5.
+        """
+        return f"""<MultiTimescaleLeapfrog> (0x{id(self):x})
+  length = {self.length}, nsteps = {self.nsteps}, timescales = {self.timescales}
+  acceptance rate = {np.mean(self.trajPoints)}"""
+
+
 class LinearStepLeapfrog(Evolver):
     r"""! \ingroup evolvers
     A leapfrog evolver with linearly changing parameters.
@@ -158,6 +293,8 @@ class LinearStepLeapfrog(Evolver):
         """
         self._current += 1
 
+        stage = refreshPseudofermions(self.action, stage, self.transform, self.rng)
+
         # get start phi for MD integration
         phiMD, logdetJ = backwardTransform(self.transform, stage)
         if self.transform is not None and "logdetJ" not in stage.logWeights:
@@ -5,6 +5,7 @@ General measurements that can be useful in various contexts.
 ## \defgroup meas Measurements
 # Perform measurements on configurations.
 
+from .chemicalPotentialScan import ChemicalPotentialScan  # (unused import) pylint: disable=W0611
 from .chiralCondensate import ChiralCondensate  # (unused import) pylint: disable=W0611
 from .collectWeights import CollectWeights  # (unused import) pylint: disable=W0611
 from .determinantCorrelators import DeterminantCorrelators  # (unused import) pylint: disable=W0611
@@ -0,0 +1,88 @@
+r"""!\file
+\ingroup meas
+Measurement of determinants for many chemical potentials.
+"""
+
+import numpy as np
+from pentinsula.h5utils import open_or_pass_file
+
+import isle
+from .measurement import Measurement, BufferSpec
+
+
+class ChemicalPotentialScan(Measurement):
+    r"""!
+    \ingroup meas
+    Measure \f$\log\det M\f$ for many chemical potentials and the canonical projections.
+
+    The chemical potential only enters HubbardFermiMatrixExp through an overall
+    factor of the transfer matrix.
+    This measurement therefore computes the eigenvalues of the transfer matrices
+    of particles and holes once per configuration via
+    isle.logTransferMatrixEigenvalues() and derives everything else from them:
+    - `logEigenvalues/particles`, `logEigenvalues/holes`: \f$\log\lambda_i\f$ at
+      \f$\tilde{\mu} = 0\f$, shape `(nx,)`.
+    - `logdetM/particles`, `logdetM/holes`: \f$\log\det M\f$ at each of `muTildes`,
+      shape `(len(muTildes),)`, see isle.logdetMScan().
+    - `canonical`: \f$\log Z_q\f$ for \f$q = -N_x, \ldots, N_x\f$, shape `(2*nx+1,)`,
+      see isle.logCanonicalProjections().
+
+    The chemical potentials are stored in the attribute `muTildes`.
+    Reweighting to any other chemical potential can be done in the analysis
+    from the stored eigenvalues or canonical projections alone.
+    """
+
+    def __init__(self, hfm, muTildes, savePath, configSlice=slice(None, None, None),
+                 alpha=1, stabilizationInterval=0):
+        r"""!
+        \param hfm Instance of isle.HubbardFermiMatrixExp, its chemical potential is ignored.
+        \param muTildes Chemical potentials \f$\tilde{\mu}\f$ to evaluate the determinants at.
+        \param savePath Path in an HDF5 file under which results are stored.
+        \param configSlice Indicates which configurations the measurement is taken on.
+        \param alpha 1 for the particle/hole basis, 0 for the spin basis.
+        \param stabilizationInterval Passed to isle.logTransferMatrixEigenvalues().
+        """
+        assert alpha in [0, 1]
+
+        nx = hfm.nx()
+        nmu = len(muTildes)
+        super().__init__(savePath,
+                         (BufferSpec("eigenvaluesParticles", (nx,), np.complex128,
+                                     "logEigenvalues/particles"),
+                          BufferSpec("eigenvaluesHoles", (nx,), np.complex128,
+                                     "logEigenvalues/holes"),
+                          BufferSpec("logdetParticles", (nmu,), np.complex128,
+                                     "logdetM/particles"),
+                          BufferSpec("logdetHoles", (nmu,), np.complex128,
+                                     "logdetM/holes"),
+                          BufferSpec("canonical", (2*nx+1,), np.complex128, "canonical")),
+                         configSlice)
+
+        self.hfm = hfm
+        self.muTildes = isle.Vector(np.asarray(muTildes, dtype=float))
+        self.alpha = alpha
+        self.stabilizationInterval = stabilizationInterval
+
+    def __call__(self, stage, itr):
+        """!Record eigenvalues, determinants, and canonical projections."""
+        phi = stage.phi if self.alpha == 1 else isle.Vector(-1j*np.array(stage.phi))
+        nt = len(phi) // self.hfm.nx()
+
+        eigenvalues = {}
+        for species, name in ((isle.Species.PARTICLE, "Particles"),
+                              (isle.Species.HOLE, "Holes")):
+            eigenvalues[species] = isle.logTransferMatrixEigenvalues(
+                self.hfm, phi, species, self.stabilizationInterval)
+            self.nextItem("eigenvalues"+name)[...] = eigenvalues[species]
+            self.nextItem("logdet"+name)[...] = isle.logdetMScan(
+                eigenvalues[species], nt, species, self.muTildes)
+
+        self.nextItem("canonical")[...] = isle.logCanonicalProjections(
+            eigenvalues[isle.Species.PARTICLE], eigenvalues[isle.Species.HOLE])
+
+    def setup(self, memoryAllowance, expectedNConfigs, file, maxBufferSize=None):
+        res = super().setup(memoryAllowance, expectedNConfigs, file, maxBufferSize)
+        with open_or_pass_file(file, None, "a") as h5f:
+            h5f[self.savePath].attrs["alpha"] = self.alpha
+            h5f[self.savePath].attrs["muTildes"] = np.array(self.muTildes)
+        return res
@@ -12,10 +12,15 @@ class ChiralCondensate(Measurement):
     r"""!
     \ingroup meas
     Tabulate the chiral condensate.
+
+    Uses a stochastic estimate of \f$\mathrm{tr}(M^{-1}) / (N_x N_t)\f$ with
+    `nsamples` noise vectors, see isle.cpp.stochasticTrace.
+    A fresh set of noise vectors is used for every configuration.
     """
 
     def __init__(self, seed, nsamples, hfm, species,
-                 savePath, configSlice=slice(None, None, None)):
+                 savePath, configSlice=slice(None, None, None),
+                 noise=isle.NoiseType.Z2, dilution=None):
         super().__init__(savePath,
                          ("chiCon", (), complex, "chiCon"),
                          configSlice)
@@ -24,32 +29,21 @@ class ChiralCondensate(Measurement):
         self.rng = isle.random.NumpyRNG(seed)
         self.hfm = hfm
         self.species = species
+        self.noise = noise
+        self.dilution = dilution if dilution is not None else isle.Dilution()
 
-        # need to know Nt to set those, do it in _getRHSs
-        self._rhss = None
+        self._operators = [isle.Matrix(np.eye(hfm.nx(), dtype=complex))]
 
     def __call__(self, stage, itr):
         """!Record the chiral condensate."""
 
         nx = self.hfm.nx()
         nt = int(len(stage.phi) / nx)
-        rhss = self._getRHSs(nt)
 
-        # Solve M*x = b for different right-hand sides,
+        seed = int(self.rng.choice(np.iinfo(np.int32).max))
+        estimates = np.array(isle.stochasticTrace(self.hfm, stage.phi, self.species,
+                                                  self._operators, self.nsamples, seed,
+                                                  self.noise, self.dilution),
+                             copy=False)
         # Normalize by spacetime volume
-        res = np.array(isle.solveM(self.hfm, stage.phi, self.species, rhss), copy=False) / (nx*nt)
-
-        self.nextItem("chiCon")[...] = np.mean([np.dot(rhs, r) for rhs, r in zip(rhss, res)])
-
-    def _getRHSs(self, nt):
-        """!
-        Get all right hand side vectors as a matrix.
-        For the j^th spacetime vector of the i^th state, go to self.rhss[i * nt + j]
-        In other words, time is the faster running index.
-        """
-
-        if self._rhss is None or self._rhss.rows() != nt*self.hfm.nx():
-            # Create a large set of sources:
-            self._rhss = isle.Matrix(np.array([isle.Vector(self.rng.normal(0, 1, nt*self.hfm.nx())+0j)
-                                               for _ in range(self.nsamples)]))
-        return self._rhss
+        self.nextItem("chiCon")[...] = np.mean(estimates[0]) / (nx*nt)
@@ -5,6 +5,7 @@ Measurement of single-particle correlator.
 
 import numpy as np
 
+import isle
 from .measurement import Measurement, BufferSpec
 from ..util import temporalRoller
 
@@ -68,24 +69,22 @@ class DeterminantCorrelators(Measurement):
     def __call__(self, stage, itr):
         """!Record the determinant correlators."""
 
-        P = np.einsum(self._time_slowest, self.particle(stage, itr))
-        H = np.einsum(self._time_slowest, self.hole(stage, itr))
+        P = np.ascontiguousarray(np.einsum(self._time_slowest, self.particle(stage, itr)))
+        H = np.ascontiguousarray(np.einsum(self._time_slowest, self.hole(stage, itr)))
 
         # Determinants are real if you use the exponential discretization.
         # But, store complex numbers as a discretization-agnostic
         # TODO: improve this, save a factor of 2 on storage for the exponential case.
-        det = {"P": np.zeros(P.shape[0:2], dtype=complex),
-               "H": np.zeros(H.shape[0:2], dtype=complex),
-               "PH": np.zeros(H.shape[0:2], dtype=complex)}
+        logdet = {"P": np.empty(P.shape[0:2], dtype=complex),
+                  "H": np.empty(H.shape[0:2], dtype=complex)}
+        # all Nt^2 blocks [f, i] at once
+        isle.logdetBatch(P, logdet["P"])
+        isle.logdetBatch(H, logdet["H"])
+        det = {"P": np.exp(logdet["P"]),
+               "H": np.exp(logdet["H"]),
+               "PH": np.exp(logdet["P"] + logdet["H"])}
 
         nt = det["P"].shape[0]
-        time = np.arange(nt)
-
-        for f in time:
-            for i in time:
-                det["P"][f,i] = np.linalg.det(P[f,i])
-                det["H"][f,i] = np.linalg.det(H[f,i])
-                det["PH"][f,i] = det["P"][f,i]*det["H"][f,i]
 
         self._roll = np.array([temporalRoller(nt, -t, fermionic=self.fermionic) for t in range(nt)])
         np.einsum(self._time_averaging, self._roll/nt, det["P"], out=self.nextItem("P"))
@@ -42,21 +42,16 @@ class AllToAll:
 
         nt = int(len(stage.phi) / self.nx)
 
+        if self._alpha == 1:
+            # M^{-1} is written directly into a [xf, tf, xi, ti] array, no reordering needed
+            propagator = np.empty((self.nx, nt, self.nx, nt), dtype=complex)
+            isle.allToAllPropagator(self.hfm, stage.phi, self.species, propagator)
+            return propagator
+
         # A large set of sources, one for each spacetime point, an identity matrix.
         # Just as a reminder, it's time-major (space is faster).
         rhss = isle.Matrix(np.eye(self.nx * nt, dtype=complex))
-
-        # Solve M*x = b for all right-hand sides:
-        if self._alpha == 1:
-            res = np.array(isle.solveM(self.hfm, stage.phi, self.species, rhss), copy=False)
-            # As explained in the documentation of isle.solveM,
-            # the first index counts the right-hand side M was solved against,
-            # the second index is a spacetime index.
-            # So we transpose to put source label as the right label.
-            # Because rhss is the identity matrix, we can now think of it as a spacetime label as well.
-            res = res.T
-        else:
-            res = np.linalg.solve(isle.Matrix(self.hfm.M(-1j*stage.phi, self.species)), np.array(rhss).T).T
+        res = np.linalg.solve(isle.Matrix(self.hfm.M(-1j*stage.phi, self.species)), np.array(rhss).T).T
 
         # Now we transform the propagator into a four-index object with space, time, space, and time indices.
         propagator = res.reshape([nt, self.nx, nt, self.nx])
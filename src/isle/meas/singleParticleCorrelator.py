@@ -66,8 +66,8 @@ import h5py as h5
 import numpy as np
 from pentinsula.h5utils import open_or_pass_file
 
+import isle
 from .measurement import Measurement, BufferSpec
-from ..util import temporalRoller
 from ..h5io import createH5Group, empty
 from .propagator import AllToAll
 
@@ -103,54 +103,22 @@ class SingleParticleCorrelator(Measurement):
 
         self._inverter = allToAll
 
-# TODO??
-        self._path = {c: None for c in correlators}
-
         self.transform = transform
-        self._indices = dict()
-        if self.transform is None:
-            self._indices["creation_destruction"] = "idf,yixf->xyd"
-            self._indices["destruction_creation"] = "idf,xfyi->xyd"
-        else:
-            self._indices["creation_destruction"] = "idf,bx,yixf,ya->bad"
-            self._indices["destruction_creation"] = "idf,bx,xfyi,ya->bad"
-
-        self._einsum_paths = {c: None for c in correlators}
+        self._transform = isle.Matrix(np.asarray(transform, dtype=complex)) \
+            if transform is not None else isle.CDMatrix(0, 0)
 
-        self._roll = None
+        self._correlators = tuple(correlators)
 
     def __call__(self, stage, itr):
         """!Record the single-particle correlators."""
 
         S = self._inverter(stage, itr)
-        nx = S.shape[0]
-        nt = S.shape[1]
-
-        d = np.eye(nx*nt).reshape(*S.shape) # A kronecker delta
-
-        if self._roll is None:
-            self._roll = np.array([temporalRoller(nt, -t, fermionic=self.fermionic) for t in range(nt)])
-
-        # If there's no transformation needed, we should avoid doing
-        # space matrix-matrix-matrix, as it will scale poorly.
-        tensors = dict()
-        if self.transform is None:
-            tensors['destruction_creation'] = (self._roll, S)
-            tensors['creation_destruction'] = (self._roll, d-S)
-        else:
-            tensors['destruction_creation'] = (self._roll, self.transform.T.conj(), S, self.transform)
-            tensors['creation_destruction'] = (self._roll, self.transform.T.conj(), d-S, self.transform)
-
-        for c in self._einsum_paths:
-            if self._einsum_paths[c] is None:
-                self._einsum_paths[c], _ = np.einsum_path(self._indices[c], *tensors[c], optimize='optimal')
-
-        # The temporal roller sums over time, but does not *average* over time.  So, divide by nt:
-        for name in self._einsum_paths:
-            res = self.nextItem(name)
-            np.einsum(self._indices[name], *tensors[name],
-                      optimize=self._einsum_paths[name], out=res)
-            res /= nt
+
+        # Time average with anti-periodic boundary conditions and optional transformation
+        # are done in one pass over the propagator.
+        for name in self._correlators:
+            isle.singleParticleCorrelator(S, _CORRELATOR_KINDS[name], self.nextItem(name),
+                                          self._transform)
 
     def setup(self, memoryAllowance, expectedNConfigs, file, maxBufferSize=None):
         res = super().setup(memoryAllowance, expectedNConfigs, file, maxBufferSize)
@@ -165,6 +133,10 @@ class SingleParticleCorrelator(Measurement):
         return res
 
 
+## Map correlator names to kernel selectors.
+_CORRELATOR_KINDS = {"creation_destruction": isle.SPCorrelator.CREATION_DESTRUCTION,
+                     "destruction_creation": isle.SPCorrelator.DESTRUCTION_CREATION}
+
 def _checkCorrNames(actual, allowed):
     for name in actual:
         if name not in allowed:
@@ -400,8 +400,8 @@ import numpy as np
 import h5py as h5
 from pentinsula.h5utils import open_or_pass_file
 
+import isle
 from .measurement import Measurement, BufferSpec
-from ..util import temporalRoller, signAlternator
 
 
 class SpinSpinCorrelator(Measurement):
@@ -459,8 +459,8 @@ class SpinSpinCorrelator(Measurement):
         self.transform = transform
         self.correlators = correlators
 
-        self._einsum_paths = {}
-        self._cache = {}
+        self._transform = isle.Matrix(np.asarray(transform, dtype=complex)) \
+            if transform is not None else isle.CDMatrix(0, 0)
 
     def __call__(self, stage, itr):
         """!Record the spin-spin correlators."""
@@ -468,62 +468,18 @@ class SpinSpinCorrelator(Measurement):
         P = self.particle(stage, itr)
         H = self.hole(stage, itr)
 
-        nx = P.shape[0]
-        nt = P.shape[1]
-
-        # This puts in all needed factors of (-sigmaKappa)^{x+y}!
-        # For operators which DON'T need it, it does nothing---the reason
-        # those operators don't need it is that the sign squares away.
-        if self.sigmaKappa == +1:
-            # This could be done without a test on sigmaKappa, since signAlternator
-            # returns the identity matrix if sigmaKappa is -1, but then we'd be doing
-            # 1-matrix-1 multiplication for no reason, and it's not cheap.
-            Sigma = signAlternator(nx, self.sigmaKappa)
-            P = np.einsum('ax,xfyi,yb->afbi', Sigma, P, Sigma, optimize="optimal")
-            H = np.einsum('ax,xfyi,yb->afbi', Sigma, H, Sigma, optimize="optimal")
-
-        d = np.eye(nx*nt).reshape(*P.shape) # A Kronecker delta
-        roll = np.array([temporalRoller(nt, -t, fermionic=self.fermionic) for t in range(nt)])
-
-        log = getLogger(__name__)
-
-        # TODO: store some einsum paths
-
-        for name in self.correlators:
-            ataCorrelator = self._allToAllCorrelator(name, P, H, d)
-
-            # It is major savings to avoid two matrix-matrix multiplies, so it is
-            # worthwhile to test for a transform and only add those multiplies in if needed.
-            if self.transform is not None:
-                if "idf,bx,xfyi,ya->bad" not in self._einsum_paths:
-                    self._einsum_paths["idf,bx,xfyi,ya->bad"], _ = np.einsum_path("idf,bx,xfyi,ya->bad", roll, self.transform.T.conj(),
-                                                                                  ataCorrelator, self.transform, optimize="optimal")
-                    log.info("Optimized Einsum path for time averaging and transform application.")
-
-                res = self.nextItem(name)
-                np.einsum("idf,bx,xfyi,ya->bad",
-                          roll,
-                          self.transform.T.conj(),
-                          ataCorrelator,
-                          self.transform,
-                          out=res,
-                          optimize=self._einsum_paths["idf,bx,xfyi,ya->bad"])
-                res /= nt
-            else:
-                if "idf,xfyi->xyd" not in self._einsum_paths:
-                    self._einsum_paths["idf,xfyi->xyd"], _ = np.einsum_path("idf,xfyi->xyd", roll, ataCorrelator, optimize="optimal")
-                    log.info("Optimized Einsum path for time averaging in position space.")
-
-                res = self.nextItem(name)
-                np.einsum("idf,xfyi->xyd", roll, ataCorrelator,
-                          optimize=self._einsum_paths["idf,xfyi->xyd"], out=res)
-                res /= nt
+        # All contractions are done in C++, streaming over source times and adding directly
+        # into the time averaged (and possibly transformed) results.
+        # Factors of (-sigmaKappa)^{x+y} square away in all elementary correlators,
+        # so there is no need to apply them here.
+        names = tuple(self.correlators)
+        isle.spinSpinCorrelators(P, H, [_CORRELATOR_KINDS[name] for name in names],
+                                 [self.nextItem(name) for name in names],
+                                 self._transform)
 
         # Any additional correlators can be derived by identities explained above.
         # They can be computed by SpinSpinCorrelator.computeDerivedCorrelators().
 
-        self._cache.clear()
-
     def setup(self, memoryAllowance, expectedNConfigs, file, maxBufferSize=None):
         """!
         Override in order to save 'transform'.
@@ -536,57 +492,6 @@ class SpinSpinCorrelator(Measurement):
                 h5f[self.savePath]["transform"] = self.transform
         return res
 
-    def _getEinsumPath(self, path, d):
-        """!
-        Return an optimized einsum path.
-        """
-        try:
-            return self._einsum_paths[path]
-        except KeyError:
-            self._einsum_paths[path], _ = np.einsum_path(path, d, d, optimize="optimal")
-            getLogger(__name__).info("Optimized Einsum path %s", path)
-            return self._einsum_paths[path]
-
-    def _getTensor(self, name, P, H, d):
-        """!
-        Return a component tensor of an all-to-all correlator.
-        Build and cache it if necessary.
-        """
-        try:
-            return self._cache[name]
-        except KeyError:
-            tensor = _TENSOR_CONSTRUCTORS[name](P, H, d, self._getEinsumPath)
-            self._cache[name] = tensor
-            return self._cache[name]
-
-    def _allToAllCorrelator(self, name, P, H, d):
-        """!
-        Compute an all-to-all correlator of given name from all-to-all
-        propagators P and H and Kronecker delta d.
-        """
-
-        def t(n):
-            return self._getTensor(n, P, H, d)
-
-        if name == "Splus_Sminus":
-            return t("PxyHxy")
-        if name == "Sminus_Splus":
-            return t("dyxdyx") - t("Pyxdyx") - t("Hyxdyx") + t("PyxHyx")
-        if name == "np_nh":
-            return t("dxxdyy") - t("Pxxdyy") - t("dxxHyy") + t("PxxHyy")
-        if name == "np_np":
-            return t("dxxdyy") - t("dxxPyy") - t("Pxxdyy") + t("Pxydyx") - t("PxyPyx") + t("PxxPyy")
-        if name == "nh_np":
-            return t("dxxdyy") - t("Hxxdyy") - t("dxxPyy") + t("HxxPyy")
-        if name == "nh_nh":
-            return t("dxxdyy") - t("dxxHyy") - t("Hxxdyy") + t("Hxydyx") - t("HxyHyx") + t("HxxHyy")
-        if name == "++_--":
-            return t("Hxydyx") - t("HxyPyx")
-        if name == "--_++":
-            return t("Pxydyx") - t("PxyHyx")
-        else:
-            raise ValueError(f"Unknown all-to-all correlator: {name}")
-
     @classmethod
     def computeDerivedCorrelators(cls, measurements, commonTransform, correlators=None):
         r"""!
@@ -679,81 +584,12 @@ def _checkCorrNames(actual, allowed):
             raise ValueError(f"Unknown correlator: '{name}'. Choose from '{allowed}'")
 
 
-# Contractions always result in a tensor xfyi, where xf are space/time at the sink
-# and yi are space/time at the source.  Because we have to move all the daggers to the right
-# to Wick contract ladder operators into propagators, however, the indices on the propagators
-# need not be in the same order.
-#
-# Contractions are grouped into 4 categories,
-#   xfxf,yiyi->xfyi
-#   xfyi,xfyi->xfyi
-#   xfyi,yixf->xfyi
-#   yixf,yixf->xfyi
-#
-# Note that other orders are all already covered
-#   yixf,xfyi = xfyi,yixf
-#   yiyi,xfxf = xfxf,yiyi
-#
-# Even in those four categories, there may be enormous redundencies.
-# For example, the kronecker delta is symmetric.
-_TENSOR_CONSTRUCTORS = {
-    "dxxdyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", d, d, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "dxxPyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", d, P, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "dxxHyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", d, H, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "Pxxdyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", P, d, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "PxxPyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", P, P, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "PxxHyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", P, H, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "Hxxdyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", H, d, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "HxxPyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", H, P, optimize=getPath("xfxf,yiyi->xfyi", d)),
-    "HxxHyy": lambda P, H, d, getPath:
-        np.einsum("xfxf,yiyi->xfyi", H, H, optimize=getPath("xfxf,yiyi->xfyi", d)),
-
-    # dxydxy = dyxdyx
-    # dxyPxy = Pxydxy
-    # dxyHxy = Hxydyx
-    # Pxydxy = Pxydyx
-    # PxyPxy cannot appear by Pauli exclusion
-    "PxyHxy": lambda P, H, d, getPath:
-        np.einsum("xfyi,xfyi->xfyi", P, H, optimize=getPath("xfyi,xfyi->xfyi", d)),
-    # Hxydxy = Hxydyx
-    # HxyPxy = PxyHxy
-    # HxyHxy cannot appear by Pauli exclusion
-
-    # dxydyx = dyxdyx
-    # dxyPyx = Pyxdyx
-    # dxyHyx = Hyxdyx
-    "Pxydyx": lambda P, H, d, getPath:
-        np.einsum("xfyi,yixf->xfyi", P, d, optimize=getPath("xfyi,yixf->xfyi", d)),
-    "PxyPyx": lambda P, H, d, getPath:
-        np.einsum("xfyi,yixf->xfyi", P, P, optimize=getPath("xfyi,yixf->xfyi", d)),
-    "PxyHyx": lambda P, H, d, getPath:
-        np.einsum("xfyi,yixf->xfyi", P, H, optimize=getPath("xfyi,yixf->xfyi", d)),
-    "Hxydyx": lambda P, H, d, getPath:
-        np.einsum("xfyi,yixf->xfyi", H, d, optimize=getPath("xfyi,yixf->xfyi", d)),
-    "HxyPyx": lambda P, H, d, getPath:
-        np.einsum("xfyi,yixf->xfyi", H, P, optimize=getPath("xfyi,yixf->xfyi", d)),
-    "HxyHyx": lambda P, H, d, getPath:
-        np.einsum("xfyi,yixf->xfyi", H, H, optimize=getPath("xfyi,yixf->xfyi", d)),
-
-    "dyxdyx": lambda P, H, d, getPath:
-        np.einsum("yixf,yixf->xfyi", d, d, optimize=getPath("yixf,yixf->xfyi", d)),
-    # dyxPyx = Pyxdyx
-    # dyxHyx = Hyxdyx
-    "Pyxdyx": lambda P, H, d, getPath:
-        np.einsum("yixf,yixf->xfyi", P, d, optimize=getPath("yixf,yixf->xfyi", d)),
-    # PyxPyx cannot appear by Pauli exclusion.
-    "PyxHyx": lambda P, H, d, getPath:
-        np.einsum("yixf,yixf->xfyi", P, H, optimize=getPath("yixf,yixf->xfyi", d)),
-    "Hyxdyx": lambda P, H, d, getPath:
-        np.einsum("yixf,yixf->xfyi", H, d, optimize=getPath("yixf,yixf->xfyi", d)),
-    # HyxPyx = PyxHyx
-    # HyxHyx cannot appear by Pauli exclusion.
-}
+## Map correlator names to kernel selectors.
+_CORRELATOR_KINDS = {"np_np": isle.SSCorrelator.NP_NP,
+                     "nh_np": isle.SSCorrelator.NH_NP,
+                     "np_nh": isle.SSCorrelator.NP_NH,
+                     "nh_nh": isle.SSCorrelator.NH_NH,
+                     "Splus_Sminus": isle.SSCorrelator.SPLUS_SMINUS,
+                     "Sminus_Splus": isle.SSCorrelator.SMINUS_SPLUS,
+                     "++_--": isle.SSCorrelator.PLUSPLUS_MINUSMINUS,
+                     "--_++": isle.SSCorrelator.MINUSMINUS_PLUSPLUS}
@@ -98,8 +98,9 @@ yaml.add_representer(HFAHopping,
                      dumper.represent_scalar("!HFAHopping", str(hop).rsplit(".")[-1]))
 yaml.add_constructor("!HFAHopping",
                      lambda loader, node: \
-                     HFAHopping.DIA if loader.construct_scalar(node) == "DIA"
-                     else HFAHopping.EXP,
+                     {"DIA": HFAHopping.DIA,
+                      "EXP": HFAHopping.EXP,
+                      "CHECKERBOARD": HFAHopping.CHECKERBOARD}[loader.construct_scalar(node)],
                      Loader=yaml.SafeLoader)
 
 # register isle.action.HFABasis
@@ -120,5 +121,8 @@ yaml.add_constructor("!HFAAlgorithm",
                      lambda loader, node: \
                      {"DIRECT_SINGLE": HFAAlgorithm.DIRECT_SINGLE,
                       "DIRECT_SQUARE": HFAAlgorithm.DIRECT_SQUARE,
-                      "ML_APPROX_FORCE":HFAAlgorithm.ML_APPROX_FORCE}[loader.construct_scalar(node)],
+                      "ML_APPROX_FORCE":HFAAlgorithm.ML_APPROX_FORCE,
+                      "PSEUDOFERMION": HFAAlgorithm.PSEUDOFERMION,
+                      "RATIONAL": HFAAlgorithm.RATIONAL,
+                      "HASENBUSCH": HFAAlgorithm.HASENBUSCH}[loader.construct_scalar(node)],
                      Loader=yaml.SafeLoader)
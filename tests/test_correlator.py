@@ -0,0 +1,167 @@
+#!/usr/bin/env python
+
+"""
+Unittest for correlator kernels.
+"""
+
+import unittest
+from itertools import product
+from logging import getLogger
+
+import numpy as np
+
+import isle
+from isle.util import temporalRoller
+from . import core, rand
+
+
+# RNG params
+SEED = 8613
+RAND_MEAN = 0
+RAND_STD = 0.2
+N_REP = 3 # number of repetitions
+
+
+def _randomPropagator(nx, nt):
+    "Return a normally distributed random complex array of shape (nx, nt, nx, nt)."
+    shape = (nx, nt, nx, nt)
+    return np.random.normal(RAND_MEAN, RAND_STD, shape) \
+        + 1j*np.random.normal(RAND_MEAN, RAND_STD, shape)
+
+
+def _referenceCorrelator(S, correlator, transform):
+    "Compute correlator via einsum over a temporal roller."
+    nx, nt = S.shape[:2]
+    roll = np.array([temporalRoller(nt, -t, fermionic=True) for t in range(nt)])
+    if correlator == isle.SPCorrelator.DESTRUCTION_CREATION:
+        res = np.einsum("idf,xfyi->xyd", roll, S)
+    else:
+        d = np.eye(nx*nt).reshape(*S.shape)
+        res = np.einsum("idf,yixf->xyd", roll, d-S)
+    if transform is not None:
+        res = np.einsum("bx,xyd,ya->bad", transform.T.conj(), res, transform)
+    return res / nt
+
+
+def _referenceSpinSpin(P, H, correlator, transform):
+    "Compute two-body correlator via explicit four-index contractions."
+    nx, nt = P.shape[:2]
+    d = np.eye(nx*nt).reshape(*P.shape)
+
+    def diag(A, B):
+        return np.einsum("xfxf,yiyi->xfyi", A, B)
+    def same(A, B):
+        return np.einsum("xfyi,xfyi->xfyi", A, B)
+    def cross(A, B):
+        return np.einsum("xfyi,yixf->xfyi", A, B)
+    def rev(A, B):
+        return np.einsum("yixf,yixf->xfyi", A, B)
+
+    kind = isle.SSCorrelator
+    if correlator == kind.NP_NP:
+        X = diag(d-P, d-P) + cross(P, d) - cross(P, P)
+    elif correlator == kind.NH_NP:
+        X = diag(d-H, d-P)
+    elif correlator == kind.NP_NH:
+        X = diag(d-P, d-H)
+    elif correlator == kind.NH_NH:
+        X = diag(d-H, d-H) + cross(H, d) - cross(H, H)
+    elif correlator == kind.SPLUS_SMINUS:
+        X = same(P, H)
+    elif correlator == kind.SMINUS_SPLUS:
+        X = rev(d, d) - rev(P, d) - rev(H, d) + rev(P, H)
+    elif correlator == kind.PLUSPLUS_MINUSMINUS:
+        X = cross(H, d) - cross(H, P)
+    else:
+        X = cross(P, d) - cross(P, H)
+
+    roll = np.array([temporalRoller(nt, -t, fermionic=False) for t in range(nt)])
+    res = np.einsum("idf,xfyi->xyd", roll, X)
+    if transform is not None:
+        res = np.einsum("bx,xyd,ya->bad", transform.T.conj(), res, transform)
+    return res / nt
+
+
+class TestCorrelator(unittest.TestCase):
+    def test_1_singleParticleCorrelator(self):
+        "Test singleParticleCorrelator against a straight forward implementation."
+        logger = core.get_logger()
+        logger.info("Testing singleParticleCorrelator")
+
+        for nx, nt, correlator, useTransform, rep in product(
+                (1, 4), (1, 2, 7),
+                (isle.SPCorrelator.CREATION_DESTRUCTION, isle.SPCorrelator.DESTRUCTION_CREATION),
+                (False, True), range(N_REP)):
+            S = _randomPropagator(nx, nt)
+            transform = np.linalg.qr(_randomPropagator(nx, 1)[:, 0, :, 0])[0] \
+                if useTransform else None
+
+            res = np.empty((nx, nx, nt), dtype=complex)
+            if transform is None:
+                isle.singleParticleCorrelator(S, correlator, res)
+            else:
+                isle.singleParticleCorrelator(S, correlator, res, isle.Matrix(transform))
+
+            np.testing.assert_allclose(res, _referenceCorrelator(S, correlator, transform),
+                                       rtol=1e-10, atol=1e-12,
+                                       err_msg="Failed check of singleParticleCorrelator in repetition {}".format(rep)
+                                       + "\nfor nx={}, nt={}, correlator={}, transform={}".format(
+                                           nx, nt, correlator, useTransform))
+
+    def test_2_spinSpinCorrelators(self):
+        "Test spinSpinCorrelators against explicit contractions."
+        logger = core.get_logger()
+        logger.info("Testing spinSpinCorrelators")
+
+        correlators = list(isle.SSCorrelator.__members__.values())
+        for nx, nt, useTransform, rep in product((1, 3), (1, 2, 5), (False, True), range(N_REP)):
+            P = _randomPropagator(nx, nt)
+            H = _randomPropagator(nx, nt)
+            transform = np.linalg.qr(_randomPropagator(nx, 1)[:, 0, :, 0])[0] \
+                if useTransform else None
+
+            outs = [np.empty((nx, nx, nt), dtype=complex) for _ in correlators]
+            if transform is None:
+                isle.spinSpinCorrelators(P, H, correlators, outs)
+            else:
+                isle.spinSpinCorrelators(P, H, correlators, outs, isle.Matrix(transform))
+
+            for correlator, res in zip(correlators, outs):
+                np.testing.assert_allclose(res, _referenceSpinSpin(P, H, correlator, transform),
+                                           rtol=1e-10, atol=1e-12,
+                                           err_msg="Failed check of spinSpinCorrelators in repetition {}".format(rep)
+                                           + "\nfor nx={}, nt={}, correlator={}, transform={}".format(
+                                               nx, nt, correlator, useTransform))
+
+    def test_3_logdetBatch(self):
+        "Test logdetBatch against numpy for fixed size and dynamic kernels."
+        logger = core.get_logger()
+        logger.info("Testing logdetBatch")
+
+        for n, rep in product((1, 2, 3, 5, 8, 9, 13), range(N_REP)):
+            matrices = np.random.normal(RAND_MEAN, 1, (4, 3, n, n)) \
+                + 1j*np.random.normal(RAND_MEAN, 1, (4, 3, n, n))
+            res = np.empty((4, 3), dtype=complex)
+            isle.logdetBatch(matrices, res)
+
+            sign, absLogdet = np.linalg.slogdet(matrices)
+            np.testing.assert_allclose(res.real, absLogdet, rtol=1e-10, atol=1e-12,
+                                       err_msg="Failed check of logdetBatch (modulus) in repetition {}".format(rep)
+                                       + "\nfor n={}".format(n))
+            np.testing.assert_allclose(np.exp(1j*res.imag), sign, rtol=1e-10, atol=1e-12,
+                                       err_msg="Failed check of logdetBatch (phase) in repetition {}".format(rep)
+                                       + "\nfor n={}".format(n))
+            self.assertTrue(np.all(np.abs(res.imag) <= np.pi),
+                            msg="logdetBatch not on first branch for n={}".format(n))
+
+
+def setUpModule():
+    "Setup the correlator test module."
+
+    logger = getLogger(__name__)
+    logger.info("""Parameters for RNG:
+    seed: {}
+    mean: {}
+    std:  {}""".format(SEED, RAND_MEAN, RAND_STD))
+
+    rand.setup(SEED)
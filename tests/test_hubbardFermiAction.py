@@ -179,6 +179,77 @@ class TestHubbardFermiAction(unittest.TestCase):
                 + f"beta={beta}, hopping={hopping}, basis={basis}")
 
 
+    def _testStabilizedForce(self, lat, hopping, basis, beta, mu, sigmaKappa):
+        "Compare stabilized DIRECT_SINGLE against DIRECT_SQUARE."
+
+        actStabilized = isle.action.makeHubbardFermiAction(lat,
+                                                           beta,
+                                                           mu*beta/lat.nt(),
+                                                           sigmaKappa,
+                                                           hopping,
+                                                           basis,
+                                                           isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                                           False,
+                                                           stabilizationInterval=3)
+        actSquare = isle.action.makeHubbardFermiAction(lat,
+                                                       beta,
+                                                       mu*beta/lat.nt(),
+                                                       sigmaKappa,
+                                                       hopping,
+                                                       basis,
+                                                       isle.action.HFAAlgorithm.DIRECT_SQUARE,
+                                                       False)
+
+        for rep in range(N_REP):
+            phi = _randomPhi(lat.lattSize(), False)
+
+            self.assertAlmostEqual(
+                actStabilized.eval(phi), actSquare.eval(phi), places=9,
+                msg=f"Failed check of stabilized evaluation of action in repetition {rep} "\
+                + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                + f"beta={beta}, hopping={hopping}, basis={basis}")
+            self.assertAlmostEqual(
+                np.max(np.abs(actStabilized.force(phi)-actSquare.force(phi))), 0, places=9,
+                msg=f"Failed check of stabilized force from action in repetition {rep} "\
+                + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                + f"beta={beta}, hopping={hopping}, basis={basis}")
+
+    def _testSinglePrecisionForce(self, lat, hopping, basis, beta, mu, sigmaKappa):
+        "Compare DIRECT_SINGLE in single precision against double precision."
+
+        actSingle = isle.action.makeHubbardFermiAction(lat,
+                                                       beta,
+                                                       mu*beta/lat.nt(),
+                                                       sigmaKappa,
+                                                       hopping,
+                                                       basis,
+                                                       isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                                       False,
+                                                       singlePrecisionForce=True)
+        actDouble = isle.action.makeHubbardFermiAction(lat,
+                                                       beta,
+                                                       mu*beta/lat.nt(),
+                                                       sigmaKappa,
+                                                       hopping,
+                                                       basis,
+                                                       isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                                       False)
+
+        for rep in range(N_REP):
+            phi = _randomPhi(lat.lattSize(), False)
+
+            self.assertAlmostEqual(
+                actSingle.eval(phi), actDouble.eval(phi), places=12,
+                msg=f"Failed check of evaluation of action with single precision force in repetition {rep} "\
+                + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                + f"beta={beta}, hopping={hopping}, basis={basis}")
+            self.assertAlmostEqual(
+                np.max(np.abs(actSingle.force(phi)-actDouble.force(phi))), 0, places=4,
+                msg=f"Failed check of single precision force in repetition {rep} "\
+                + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                + f"beta={beta}, hopping={hopping}, basis={basis}")
+
+
     def test_2_force(self):
         "Test force functions of all versions of the action."
 
@@ -187,6 +258,321 @@ class TestHubbardFermiAction(unittest.TestCase):
                 lat.nt(nt)
                 self._testAlgorithmssForce(lat, hopping, basis, beta, mu, sigmaKappa)
                 self._testShortcutForce(lat, hopping, basis, beta, mu, sigmaKappa)
+                self._testStabilizedForce(lat, hopping, basis, beta, mu, sigmaKappa)
+                self._testSinglePrecisionForce(lat, hopping, basis, beta, mu, sigmaKappa)
+
+
+    def test_3_batch(self):
+        "Test batched evaluation of action and force."
+
+        nconf = 4
+        for lat in LATTICES:
+            for hopping, basis, nt, beta, mu, sigmaKappa in _forAllParams():
+                lat.nt(nt)
+                act = isle.action.makeHubbardFermiAction(lat,
+                                                         beta,
+                                                         mu*beta/lat.nt(),
+                                                         sigmaKappa,
+                                                         hopping,
+                                                         basis,
+                                                         isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                                         False)
+                phis = np.array([_randomPhi(lat.lattSize(), False) for _ in range(nconf)])
+
+                actions = np.array(act.evalBatch(phis), copy=False)
+                forces = np.array(act.forceBatch(phis), copy=False)
+                for i, phi in enumerate(phis):
+                    phi = isle.Vector(phi)
+                    self.assertAlmostEqual(
+                        actions[i], act.eval(phi), places=12,
+                        msg=f"Failed check of batched evaluation of action for configuration {i} "\
+                        + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                        + f"beta={beta}, hopping={hopping}, basis={basis}")
+                    self.assertAlmostEqual(
+                        np.max(np.abs(forces[i]-act.force(phi))), 0, places=12,
+                        msg=f"Failed check of batched force for configuration {i} "\
+                        + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                        + f"beta={beta}, hopping={hopping}, basis={basis}")
+
+
+    def test_4_evalAndForce(self):
+        "Test combined evaluation of action and force."
+
+        for lat in LATTICES:
+            for hopping, basis, nt, beta, mu, sigmaKappa in _forAllParams():
+                lat.nt(nt)
+                for algorithm in (isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                  isle.action.HFAAlgorithm.DIRECT_SQUARE):
+                    act = isle.action.makeHubbardFermiAction(lat,
+                                                             beta,
+                                                             mu*beta/lat.nt(),
+                                                             sigmaKappa,
+                                                             hopping,
+                                                             basis,
+                                                             algorithm,
+                                                             False)
+                    phi = isle.Vector(_randomPhi(lat.lattSize(), False))
+
+                    actVal, force = act.evalAndForce(phi)
+                    self.assertAlmostEqual(
+                        actVal, act.eval(phi), places=10,
+                        msg=f"Failed check of action from evalAndForce for algorithm={algorithm} "\
+                        + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                        + f"beta={beta}, hopping={hopping}, basis={basis}")
+                    self.assertAlmostEqual(
+                        np.max(np.abs(np.array(force, copy=False)-act.force(phi))), 0, places=12,
+                        msg=f"Failed check of force from evalAndForce for algorithm={algorithm} "\
+                        + f"for lat={lat.name}, nt={lat.nt()}, mu={mu}, sigmaKappa={sigmaKappa}, "\
+                        + f"beta={beta}, hopping={hopping}, basis={basis}")
+
+    def test_5_localUpdate(self):
+        "Test change in action from local updates against full evaluation."
+
+        utilde = 2.0
+        for lat in LATTICES:
+            for hopping, nt, beta, sigmaKappa, delay in product(
+                    (isle.action.HFAHopping.DIA, isle.action.HFAHopping.EXP),
+                    NT, BETA, (-1, +1), (1, 4)):
+                lat.nt(nt)
+                act = isle.action.makeHubbardFermiAction(lat,
+                                                         beta,
+                                                         0,
+                                                         sigmaKappa,
+                                                         hopping,
+                                                         isle.action.HFABasis.PARTICLE_HOLE,
+                                                         isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                                         False)
+                gauge = isle.action.HubbardGaugeAction(utilde)
+                HFM = isle.HubbardFermiMatrixExp if hopping == isle.action.HFAHopping.EXP \
+                    else isle.HubbardFermiMatrixDia
+                updater = isle.LocalUpdate(HFM(lat, beta, 0, sigmaKappa), utilde, 3, delay)
+
+                phi = _randomPhi(lat.lattSize(), True)
+                newPhi, deltaAction, accepted = updater.sweep(phi, 2, 0.5, SEED)
+                self.assertGreater(accepted, 0)
+
+                expected = act.eval(newPhi) + gauge.eval(newPhi) \
+                    - act.eval(phi) - gauge.eval(phi)
+                self.assertAlmostEqual(
+                    np.exp(deltaAction - expected), 1, places=8,
+                    msg=f"Failed check of change in action from local update "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, sigmaKappa={sigmaKappa}, "\
+                    + f"beta={beta}, hopping={hopping}, delay={delay}")
+
+                # the evolver takes all parameters from the action
+                evolver = isle.evolver.LocalMetropolis(1, 0.5, isle.action.SumAction(act, gauge),
+                                                       lat, None, 3, delay)
+                self.assertEqual(evolver._updater.utilde(), utilde)
+                with self.assertRaises(ValueError):
+                    isle.evolver.LocalMetropolis(1, 0.5, gauge, lat, None)
+                with self.assertRaises(ValueError):
+                    isle.evolver.LocalMetropolis(1, 0.5, isle.action.SumAction(act, gauge, gauge),
+                                                 lat, None)
+
+    def test_6_pseudofermion(self):
+        "Test pseudofermion action against dense linear algebra and finite differences."
+
+        epsilon = 1e-5
+        for lat in LATTICES:
+            for hopping, nt, beta in product(
+                    (isle.action.HFAHopping.DIA, isle.action.HFAHopping.EXP,
+                     isle.action.HFAHopping.CHECKERBOARD), NT, BETA):
+                lat.nt(nt)
+                act = isle.action.makeHubbardFermiAction(lat,
+                                                         beta,
+                                                         0,
+                                                         +1,
+                                                         hopping,
+                                                         isle.action.HFABasis.PARTICLE_HOLE,
+                                                         isle.action.HFAAlgorithm.PSEUDOFERMION)
+                HFM = {isle.action.HFAHopping.DIA: isle.HubbardFermiMatrixDia,
+                       isle.action.HFAHopping.EXP: isle.HubbardFermiMatrixExp,
+                       isle.action.HFAHopping.CHECKERBOARD: isle.HubbardFermiMatrixCheckerboard}[hopping]
+                hfm = HFM(lat, beta, 0, +1)
+
+                phi = _randomPhi(lat.lattSize(), True)
+                act.refreshPseudofermions(phi, SEED)
+                chi = np.array(act.pseudofermions(), copy=False)
+                M = np.array(isle.Matrix(hfm.M(phi, isle.Species.PARTICLE)))
+
+                expected = np.vdot(chi, np.linalg.solve(M.conj().T @ M, chi)).real
+                self.assertAlmostEqual(
+                    act.eval(phi)/expected, 1, places=8,
+                    msg=f"Failed check of pseudofermion action "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, hopping={hopping}")
+
+                direction = np.random.normal(0, 1, lat.lattSize())
+                difference = (act.eval(isle.Vector(np.array(phi) + epsilon*direction))
+                              - act.eval(isle.Vector(np.array(phi) - epsilon*direction))) / 2 / epsilon
+                self.assertAlmostEqual(
+                    -difference / np.dot(np.array(act.force(phi)), direction), 1, places=5,
+                    msg=f"Failed check of pseudofermion force "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, hopping={hopping}")
+
+    def test_7_rational(self):
+        "Test rational action against dense linear algebra and finite differences."
+
+        for power, (lmin, lmax) in product((0.25, 0.5, 1), ((1e-4, 1e2), (1e-2, 10))):
+            approx = isle.RationalApproximation(-power, lmin, lmax, 1e-10)
+            x = np.geomspace(lmin, lmax, 37)
+            np.testing.assert_allclose([approx(xi) for xi in x], x**-power, rtol=1e-10, atol=0,
+                                       err_msg=f"Failed check of RationalApproximation for power={power}")
+
+        epsilon = 1e-5
+        power = 0.5
+        for lat in LATTICES:
+            for hopping, nt, beta in product(
+                    (isle.action.HFAHopping.DIA, isle.action.HFAHopping.EXP), NT, BETA):
+                lat.nt(nt)
+                HFM = isle.HubbardFermiMatrixExp if hopping == isle.action.HFAHopping.EXP \
+                    else isle.HubbardFermiMatrixDia
+                hfm = HFM(lat, beta, 0.1, -1)
+                phi = _randomPhi(lat.lattSize(), True)
+
+                # spectral range of M^dagger M for both species with some slack
+                Ms = {species: np.array(isle.Matrix(hfm.M(phi, species)))
+                      for species in (isle.Species.PARTICLE, isle.Species.HOLE)}
+                eigvals = np.concatenate([np.linalg.eigvalsh(M.conj().T @ M) for M in Ms.values()])
+
+                ActionType = isle.action.HubbardFermiActionExpRationalOne \
+                    if hopping == isle.action.HFAHopping.EXP \
+                       else isle.action.HubbardFermiActionDiaRationalOne
+                act = ActionType(lat.hopping()*beta/nt, 0.1, -1, power,
+                                 eigvals.min()/2, eigvals.max()*2)
+                act.refreshPseudofermions(phi, SEED)
+
+                expected = 0
+                for species, M in Ms.items():
+                    chi = np.array(act.pseudofermions(species), copy=False)
+                    evals, evecs = np.linalg.eigh(M.conj().T @ M)
+                    expected += np.vdot(chi, evecs @ (evals**-power * (evecs.conj().T @ chi))).real
+                self.assertAlmostEqual(
+                    act.eval(phi)/expected, 1, places=8,
+                    msg=f"Failed check of rational action "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, hopping={hopping}")
+
+                direction = np.random.normal(0, 1, lat.lattSize())
+                difference = (act.eval(isle.Vector(np.array(phi) + epsilon*direction))
+                              - act.eval(isle.Vector(np.array(phi) - epsilon*direction))) / 2 / epsilon
+                self.assertAlmostEqual(
+                    -difference / np.dot(np.array(act.force(phi)), direction), 1, places=5,
+                    msg=f"Failed check of rational force "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, hopping={hopping}")
+
+    def test_8_hasenbusch(self):
+        "Test Hasenbusch ratio action and multi time scale integration."
+
+        epsilon = 1e-5
+        rho = 0.3
+        for lat in LATTICES:
+            for hopping, nt, beta in product(
+                    (isle.action.HFAHopping.DIA, isle.action.HFAHopping.EXP), NT, BETA):
+                lat.nt(nt)
+                HFM = isle.HubbardFermiMatrixExp if hopping == isle.action.HFAHopping.EXP \
+                    else isle.HubbardFermiMatrixDia
+                kappa = lat.hopping()*beta/nt
+                phi = _randomPhi(lat.lattSize(), True)
+                M = np.array(isle.Matrix(HFM(kappa, 0, +1).M(phi, isle.Species.PARTICLE)))
+                Mh = np.array(isle.Matrix(HFM(kappa*rho, 0, +1).M(phi, isle.Species.PARTICLE)))
+
+                ActionType = isle.action.HubbardFermiActionExpHasenbuschOne \
+                    if hopping == isle.action.HFAHopping.EXP \
+                       else isle.action.HubbardFermiActionDiaHasenbuschOne
+                ratio = ActionType(kappa, 0, +1, rho)
+                ratio.refreshPseudofermions(phi, SEED)
+                chi = np.array(ratio.pseudofermions(), copy=False)
+
+                v = Mh.conj().T @ chi
+                expected = np.vdot(v, np.linalg.solve(M.conj().T @ M, v)).real
+                self.assertAlmostEqual(
+                    ratio.eval(phi)/expected, 1, places=8,
+                    msg=f"Failed check of Hasenbusch action "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, hopping={hopping}")
+
+                direction = np.random.normal(0, 1, lat.lattSize())
+                difference = (ratio.eval(isle.Vector(np.array(phi) + epsilon*direction))
+                              - ratio.eval(isle.Vector(np.array(phi) - epsilon*direction))) / 2 / epsilon
+                self.assertAlmostEqual(
+                    -difference / np.dot(np.array(ratio.force(phi)), direction), 1, places=5,
+                    msg=f"Failed check of Hasenbusch force "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, hopping={hopping}")
+
+                # heavy part on the fine, ratio on the coarse time scale
+                PFType = isle.action.HubbardFermiActionExpPseudofermionOne \
+                    if hopping == isle.action.HFAHopping.EXP \
+                       else isle.action.HubbardFermiActionDiaPseudofermionOne
+                heavy = PFType(kappa*rho, 0, +1)
+                heavy.refreshPseudofermions(phi, SEED+1)
+                action = isle.action.HubbardGaugeAction(1.0/nt) + heavy + ratio
+
+                pi = isle.Vector(np.random.normal(0, 1, lat.lattSize())+0j)
+                phi1, pi1, actVal1 = isle.multiTimescaleLeapfrog(phi, pi, action, [1, 1, 0],
+                                                                 1, [3, 4])
+                self.assertAlmostEqual(actVal1, action.eval(phi1), places=10,
+                                       msg="Failed check of action value after multi time scale leapfrog")
+                phi2, pi2, _ = isle.multiTimescaleLeapfrog(phi1, pi1, action, [1, 1, 0],
+                                                           1, [3, 4], -1)
+                np.testing.assert_allclose(np.array(phi2), np.array(phi), rtol=0, atol=1e-8,
+                                           err_msg="Failed check of reversibility of multi time scale leapfrog")
+                np.testing.assert_allclose(np.array(pi2), np.array(pi), rtol=0, atol=1e-8,
+                                           err_msg="Failed check of reversibility of multi time scale leapfrog")
+
+                # a single time scale is regular leapfrog
+                phiA, piA, _ = isle.multiTimescaleLeapfrog(phi, pi, action, [0, 0, 0], 1, [7])
+                phiB, piB, _ = isle.leapfrog(phi, pi, action, 1, 7)
+                np.testing.assert_allclose(np.array(phiA), np.array(phiB), rtol=1e-10, atol=1e-12,
+                                           err_msg="Failed check of multi time scale leapfrog against leapfrog")
+                np.testing.assert_allclose(np.array(piA), np.array(piB), rtol=1e-10, atol=1e-12,
+                                           err_msg="Failed check of multi time scale leapfrog against leapfrog")
+
+    def test_9_checkerboard(self):
+        "Test DIRECT_SINGLE with checkerboard hopping against logdetM and finite differences."
+
+        epsilon = 1e-5
+        for lat in LATTICES:
+            for basis, nt, beta, sigmaKappa in product(
+                    (isle.action.HFABasis.PARTICLE_HOLE, isle.action.HFABasis.SPIN),
+                    NT, BETA, (-1, +1)):
+                lat.nt(nt)
+                act = isle.action.makeHubbardFermiAction(lat,
+                                                         beta,
+                                                         0,
+                                                         sigmaKappa,
+                                                         isle.action.HFAHopping.CHECKERBOARD,
+                                                         basis,
+                                                         isle.action.HFAAlgorithm.DIRECT_SINGLE,
+                                                         False)
+                hfm = isle.HubbardFermiMatrixCheckerboard(lat, beta, 0, sigmaKappa)
+
+                phi = _randomPhi(lat.lattSize(), False)
+                # the spin basis is the particle/hole basis with phi -> -i phi
+                phiPH = phi if basis == isle.action.HFABasis.PARTICLE_HOLE \
+                    else isle.Vector(-1j*np.array(phi))
+                expected = -(isle.logdetM(hfm, phiPH, isle.Species.PARTICLE)
+                             + isle.logdetM(hfm, phiPH, isle.Species.HOLE))
+                self.assertAlmostEqual(
+                    np.exp(act.eval(phi) - expected), 1, places=10,
+                    msg=f"Failed check of checkerboard action "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, "\
+                    + f"sigmaKappa={sigmaKappa}, basis={basis}")
+
+                action, force = act.evalAndForce(phi)
+                self.assertAlmostEqual(action, act.eval(phi), places=10,
+                                       msg="Failed check of checkerboard evalAndForce")
+                np.testing.assert_allclose(np.array(force), np.array(act.force(phi)),
+                                           rtol=1e-10, atol=1e-12,
+                                           err_msg="Failed check of checkerboard evalAndForce")
+
+                direction = np.random.normal(0, 1, lat.lattSize())
+                difference = act.eval(isle.Vector(np.array(phi) + epsilon*direction)) \
+                    - act.eval(isle.Vector(np.array(phi) - epsilon*direction))
+                # undo possible jumps between branches of the logarithm
+                difference = (difference.real + 1j*np.angle(np.exp(1j*difference.imag))) / 2 / epsilon
+                self.assertAlmostEqual(
+                    -difference / np.dot(np.array(force), direction), 1, places=5,
+                    msg=f"Failed check of checkerboard force "\
+                    + f"for lat={lat.name}, nt={lat.nt()}, beta={beta}, "\
+                    + f"sigmaKappa={sigmaKappa}, basis={basis}")
 
 
 def setUpModule():
@@ -144,6 +144,14 @@ class TestHubbardFermiMatrix(unittest.TestCase):
                                            + "\n  plain = {}".format(plain)
                                            + "\n  viaLU = {}".format(viaLU))
 
+                stabilized = isle.logdetM(hfm, phi, species, stabilizationInterval=3)
+                self.assertAlmostEqual(plain, stabilized, places=5,
+                                       msg="Failed check of stabilized log(det(M)) in repetition {}".format(rep)
+                                           + "\nfor nt={}, beta={}, mu={}, sigmaKappa={}, species={}, real={}, imag={}"
+                                       .format(nt, beta, mu, sigmaKappa, species, real, imag)
+                                           + "\n  plain = {}".format(plain)
+                                           + "\n  stabilized = {}".format(stabilized))
+
 
     def _test_logdetQ(self, HFM, kappa):
         "Test log(det(Q))."
@@ -165,6 +173,46 @@ class TestHubbardFermiMatrix(unittest.TestCase):
                                    + "\nplain = {}".format(plain) \
                                    + "\nviaLU = {}".format(viaLU))
 
+            viaCR = isle.logdetQ(hfm, phi, algorithm=isle.QFactorization.CYCLIC_REDUCTION)
+            self.assertAlmostEqual(plain, viaCR, places=10,
+                                   msg="Failed check log(det(Q)) via cyclic reduction in repetition {}".format(rep)\
+                                   + "for nt={}, mu={}, sigmaKappa={}:".format(nt, mu, sigmaKappa)\
+                                   + "\nplain = {}".format(plain) \
+                                   + "\nviaCR = {}".format(viaCR))
+
+            rhs = _randomPhi(nx*nt)
+            np.testing.assert_allclose(
+                np.array(isle.solveQ(hfm, phi, rhs, algorithm=isle.QFactorization.CYCLIC_REDUCTION),
+                         copy=False),
+                np.array(isle.solveQ(hfm, phi, rhs), copy=False), rtol=1e-8, atol=1e-10,
+                err_msg="Failed check of solveQ via cyclic reduction in repetition {}".format(rep)\
+                + "for nt={}, mu={}, sigmaKappa={}".format(nt, mu, sigmaKappa))
+
+    def _test_reuseQLU(self, HFM, kappa):
+        "Test that a QLU reused across configurations gives the same results as fresh ones."
+
+        nx = kappa.rows()
+        lu = HFM.QLU()
+        # repeated nt reuse the memory, changing nt forces a reallocation
+        for nt in (4, 4, 2, 2, 1):
+            hfm = HFM(kappa/nt, 0, -1)
+            phi = _randomPhi(nx*nt)
+            isle.getQLU(hfm, phi, lu)
+            self.assertTrue(lu.isConsistent())
+            self.assertEqual((lu.nx(), lu.nt()), (nx, nt))
+
+            fresh = isle.getQLU(hfm, phi)
+            self.assertAlmostEqual(isle.logdetQ(lu), isle.logdetQ(fresh), places=10,
+                                   msg="Failed check of logdetQ with reused QLU for nt={}".format(nt))
+            self.assertAlmostEqual(isle.logdetQ(lu), isle.logdetQ(hfm, phi), places=10,
+                                   msg="Failed check of logdetQ with reused QLU for nt={}".format(nt))
+
+            rhs = _randomPhi(nx*nt)
+            np.testing.assert_allclose(np.array(isle.solveQ(lu, rhs), copy=False),
+                                       np.array(isle.solveQ(hfm, phi, rhs), copy=False),
+                                       rtol=1e-10, atol=1e-12,
+                                       err_msg="Failed check of solveQ with reused QLU for nt={}".format(nt))
+
     def test_2_logdet(self):
         "Test log(det(M)) and log(deg(Q))."
         logger = core.get_logger()
@@ -173,6 +221,7 @@ class TestHubbardFermiMatrix(unittest.TestCase):
             for HFM in self.HFMTypes:
                 self._test_logdetM(HFM, lattice.hopping())
                 self._test_logdetQ(HFM, lattice.hopping())
+                self._test_reuseQLU(HFM, lattice.hopping())
 
 
     def _test_solveM(self, HFM, kappa):
@@ -197,6 +246,193 @@ class TestHubbardFermiMatrix(unittest.TestCase):
                                                    + "\nfor nt={}, mu={}, sigmaKappa={}, species={}, real={}, imag={}:"
                                            .format(nt, mu, sigmaKappa, species, real, imag))
 
+                res = np.array(isle.solveM(hfm, phi, species, rhss, stabilizationInterval=3), copy=False)
+                np.testing.assert_allclose(M * res.T, rhss.T, rtol=1e-5, atol=0,
+                                           err_msg="Failed check of stabilized solveM in repetition {}".format(rep)
+                                                   + "\nfor nt={}, mu={}, sigmaKappa={}, species={}, real={}, imag={}:"
+                                           .format(nt, mu, sigmaKappa, species, real, imag))
+
+    def _test_applyMQ(self, HFM, kappa):
+        "Test applyM() and applyQ() against the full matrices."
+
+        nx = kappa.rows()
+        for nt, sigmaKappa in product((2, 4, 8), (-1, 1)):
+            hfm = HFM(kappa / nt, 0, sigmaKappa)
+            for rep in range(N_REP):
+                phi = _randomPhi(nx * nt)
+                vecs = np.array([_randomPhi(nx * nt) for _ in range(5)])
+                for species, dagger in product((isle.Species.PARTICLE, isle.Species.HOLE),
+                                               (False, True)):
+                    M = np.array(isle.Matrix(hfm.M(phi, species)), copy=False)
+                    if dagger:
+                        M = M.T.conj()
+                    res = np.array(isle.applyM(hfm, phi, species, isle.Vector(vecs[0]), dagger),
+                                   copy=False)
+                    np.testing.assert_allclose(res, M @ vecs[0], rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of applyM in repetition {}".format(rep)
+                                               + "\nfor nt={}, sigmaKappa={}, species={}, dagger={}"
+                                               .format(nt, sigmaKappa, species, dagger))
+                    res = np.array(isle.applyM(hfm, phi, species, isle.Matrix(vecs), dagger),
+                                   copy=False)
+                    np.testing.assert_allclose(res, vecs @ M.T, rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of applyM to many vectors in repetition {}".format(rep)
+                                               + "\nfor nt={}, sigmaKappa={}, species={}, dagger={}"
+                                               .format(nt, sigmaKappa, species, dagger))
+
+                for dagger in (False, True):
+                    Q = np.array(isle.Matrix(hfm.Q(phi)), copy=False)
+                    if dagger:
+                        Q = Q.T.conj()
+                    res = np.array(isle.applyQ(hfm, phi, isle.Vector(vecs[0]), dagger), copy=False)
+                    np.testing.assert_allclose(res, Q @ vecs[0], rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of applyQ in repetition {}".format(rep)
+                                               + "\nfor nt={}, sigmaKappa={}, dagger={}"
+                                               .format(nt, sigmaKappa, dagger))
+                    res = np.array(isle.applyQ(hfm, phi, isle.Matrix(vecs), dagger), copy=False)
+                    np.testing.assert_allclose(res, vecs @ Q.T, rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of applyQ to many vectors in repetition {}".format(rep)
+                                               + "\nfor nt={}, sigmaKappa={}, dagger={}"
+                                               .format(nt, sigmaKappa, dagger))
+
+    def _test_evenOdd(self, HFM, kappa):
+        "Test EvenOddPreconditioner against solveM()."
+
+        nx = kappa.rows()
+        for nt, levels, sigmaKappa in product((4, 8), (0, 1, 2), (-1, 1)):
+            hfm = HFM(kappa / nt, 0, sigmaKappa)
+            for species, rep in product((isle.Species.PARTICLE, isle.Species.HOLE),
+                                        range(N_REP)):
+                phi = _randomPhi(nx * nt)
+                rhss = np.array([_randomPhi(nx * nt) for _ in range(3)])
+                expected = np.array(isle.solveM(hfm, phi, species, rhss), copy=False)
+
+                eo = isle.EvenOddPreconditioner(hfm, phi, species, levels)
+                self.assertEqual(eo.ntReduced() * 2**levels, nt)
+
+                # S and S^dagger must be adjoint to each other
+                u = np.array(_randomPhi(nx * eo.ntReduced()))
+                v = np.array(_randomPhi(nx * eo.ntReduced()))
+                np.testing.assert_allclose(np.vdot(u, eo.apply(isle.Vector(v))),
+                                           np.vdot(eo.apply(isle.Vector(u), True), v),
+                                           rtol=1e-10, atol=1e-12)
+
+                # exact reduced solution must reconstruct the exact full solution
+                reduced = np.array(expected[0]).reshape(nt, nx)[::2**levels].ravel()
+                np.testing.assert_allclose(
+                    eo.apply(isle.Vector(reduced)), eo.reduce(isle.Vector(rhss[0])),
+                    rtol=1e-8, atol=1e-10,
+                    err_msg="Failed check of EvenOddPreconditioner.reduce in repetition {}".format(rep)
+                    + "\nfor nt={}, levels={}, sigmaKappa={}, species={}"
+                    .format(nt, levels, sigmaKappa, species))
+                np.testing.assert_allclose(
+                    eo.reconstruct(isle.Vector(reduced), isle.Vector(rhss[0])), expected[0],
+                    rtol=1e-8, atol=1e-10,
+                    err_msg="Failed check of EvenOddPreconditioner.reconstruct in repetition {}".format(rep)
+                    + "\nfor nt={}, levels={}, sigmaKappa={}, species={}"
+                    .format(nt, levels, sigmaKappa, species))
+
+                res = np.array(eo.solve(isle.Matrix(rhss), tolerance=1e-12), copy=False)
+                np.testing.assert_allclose(res, expected, rtol=1e-6, atol=1e-8,
+                                           err_msg="Failed check of EvenOddPreconditioner.solve in repetition {}".format(rep)
+                                           + "\nfor nt={}, levels={}, sigmaKappa={}, species={}"
+                                           .format(nt, levels, sigmaKappa, species))
+
+    def _test_allToAllPropagator(self, HFM, kappa):
+        "Test allToAllPropagator() against solveM()."
+
+        nx = kappa.rows()
+        for nt, sigmaKappa in product((1, 4, 8), (-1, 1)):
+            hfm = HFM(kappa / nt, 0, sigmaKappa)
+            for species, rep in product((isle.Species.PARTICLE, isle.Species.HOLE),
+                                        range(N_REP)):
+                phi = _randomPhi(nx * nt)
+                expected = np.array(isle.solveM(hfm, phi, species,
+                                                np.eye(nx * nt, dtype=complex)), copy=False).T
+
+                propagator = np.empty((nx, nt, nx, nt), dtype=complex)
+                isle.allToAllPropagator(hfm, phi, species, propagator)
+                # [x, t, y, t'] -> [(t, x), (t', y)]
+                res = propagator.transpose((1, 0, 3, 2)).reshape(nx * nt, nx * nt)
+                np.testing.assert_allclose(res, expected, rtol=1e-6, atol=1e-10,
+                                           err_msg="Failed check of allToAllPropagator in repetition {}".format(rep)
+                                                   + "\nfor nt={}, sigmaKappa={}, species={}:"
+                                           .format(nt, sigmaKappa, species))
+
+    def _test_solveQMany(self, HFM, kappa):
+        "Test solveQ with many right hand sides against solving for each of them separately."
+
+        nx = kappa.rows()
+        nrhs = 3
+        for nt, sigmaKappa in product((1, 2, 4), (-1, 1)):
+            hfm = HFM(kappa/nt, 0, sigmaKappa)
+            phi = _randomPhi(nx*nt)
+            lu = isle.getQLU(hfm, phi)
+            rhss = np.array([_randomPhi(nx*nt) for _ in range(nrhs)])
+            expected = [np.array(isle.solveQ(lu, isle.Vector(rhs)), copy=False) for rhs in rhss]
+
+            # more blocks than right hand sides leaves some blocks empty
+            for nblocks in (1, 2, nrhs+2):
+                res = np.array(isle.solveQ(lu, isle.Matrix(rhss), nblocks), copy=False)
+                self.assertEqual(res.shape, rhss.shape)
+                for i, (row, exp) in enumerate(zip(res, expected)):
+                    np.testing.assert_allclose(row, exp, rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of solveQ for right hand side {}".format(i)
+                                               + "\nfor nt={}, sigmaKappa={}, nblocks={}"
+                                               .format(nt, sigmaKappa, nblocks))
+
+    def _test_stochasticTrace(self, HFM, kappa):
+        "Test that fully diluted stochasticTrace() with unit noise is exact."
+
+        nx = kappa.rows()
+        for nt, noise in product((1, 4), (isle.NoiseType.Z2, isle.NoiseType.Z4)):
+            hfm = HFM(kappa / nt, 0, -1)
+            for species, rep in product((isle.Species.PARTICLE, isle.Species.HOLE),
+                                        range(N_REP)):
+                phi = _randomPhi(nx * nt)
+                Minv = np.array(isle.solveM(hfm, phi, species,
+                                            np.eye(nx * nt, dtype=complex)), copy=False).T
+                operators = [np.eye(nx, dtype=complex), np.random.normal(0, 1, (nx, nx)) + 0j]
+                expected = [np.trace(np.kron(np.eye(nt), op) @ Minv) for op in operators]
+
+                res = np.array(isle.stochasticTrace(hfm, phi, species,
+                                                    [isle.Matrix(op) for op in operators],
+                                                    3, 1234 + rep, noise, isle.Dilution(nt, nx)),
+                               copy=False)
+                for estimates, exp in zip(res, expected):
+                    np.testing.assert_allclose(estimates, exp, rtol=1e-8, atol=1e-10,
+                                               err_msg="Failed check of stochasticTrace in repetition {}".format(rep)
+                                                       + "\nfor nt={}, noise={}, species={}:"
+                                               .format(nt, noise, species))
+
+    def _test_stochasticTracePartial(self, HFM, kappa):
+        "Test that partially diluted stochasticTrace() agrees with the exact trace within errors."
+
+        nx = kappa.rows()
+        nt = 4
+        nnoise = 200
+        hfm = HFM(kappa / nt, 0, -1)
+        for dilution, noise, species in product((isle.Dilution(nt, 1), isle.Dilution(1, nx)),
+                                                (isle.NoiseType.Z2, isle.NoiseType.GAUSSIAN),
+                                                (isle.Species.PARTICLE, isle.Species.HOLE)):
+            phi = _randomPhi(nx * nt)
+            Minv = np.array(isle.solveM(hfm, phi, species,
+                                        np.eye(nx * nt, dtype=complex)), copy=False).T
+            operators = [np.eye(nx, dtype=complex), np.random.normal(0, 1, (nx, nx)) + 0j]
+            expected = [np.trace(np.kron(np.eye(nt), op) @ Minv) for op in operators]
+
+            res = np.array(isle.stochasticTrace(hfm, phi, species,
+                                                [isle.Matrix(op) for op in operators],
+                                                nnoise, 4321, noise, dilution),
+                           copy=False)
+            for estimates, exp in zip(res, expected):
+                mean = np.mean(estimates)
+                err = np.sqrt((np.var(estimates.real) + np.var(estimates.imag)) / nnoise)
+                self.assertLess(abs(mean - exp), 6*err + 1e-8,
+                                msg="Failed statistical check of stochasticTrace"
+                                + "\nfor dilution=({}, {}), noise={}, species={}:"
+                                .format(dilution.time, dilution.space, noise, species)
+                                + "\nestimate = {} +- {}, exact = {}".format(mean, err, exp))
+
     def test_3_solver(self):
         "Test Ax=b solvers."
         logger = core.get_logger()
@@ -204,6 +440,212 @@ class TestHubbardFermiMatrix(unittest.TestCase):
             logger.info("Testing solveM on %s", lattice.name)
             for HFM in self.HFMTypes:
                 self._test_solveM(HFM, lattice.hopping())
+                self._test_applyMQ(HFM, lattice.hopping())
+                self._test_evenOdd(HFM, lattice.hopping())
+                self._test_allToAllPropagator(HFM, lattice.hopping())
+                self._test_solveQMany(HFM, lattice.hopping())
+                self._test_stochasticTrace(HFM, lattice.hopping())
+                self._test_stochasticTracePartial(HFM, lattice.hopping())
+
+
+    def _test_checkerboard(self, kappa):
+        "Test HubbardFermiMatrixCheckerboard against the exact exponential and full matrices."
+
+        nx = kappa.rows()
+        denseKappa = np.array(isle.Matrix(kappa), copy=False)
+        bonds = {(x, y) for x, y in zip(*np.nonzero(denseKappa)) if x < y}
+        for nt, mu, sigmaKappa in product((4, 16), (0, 0.3), (-1, 1)):
+            hfm = isle.HubbardFermiMatrixCheckerboard(kappa / nt, mu / nt, sigmaKappa)
+            hfmExp = isle.HubbardFermiMatrixExp(kappa / nt, mu / nt, sigmaKappa)
+
+            # every bond is in exactly one class and classes do not share sites
+            classes = [hfm.bondClass(c) for c in range(hfm.nBondClasses())]
+            self.assertEqual(sorted(bond for cls in classes for bond in cls), sorted(bonds))
+            for cls in classes:
+                sites = [site for bond in cls for site in bond]
+                self.assertEqual(len(sites), len(set(sites)))
+
+            # Trotter error of the symmetric product is O(kappa^3)
+            tolerance = 2*(np.max(np.abs(denseKappa)) / nt)**3 + 1e-14
+            for species, inv in product((isle.Species.PARTICLE, isle.Species.HOLE), (False, True)):
+                expKappa = np.array(hfm.expKappa(species, inv), copy=False)
+                np.testing.assert_allclose(expKappa, expKappa.T, rtol=0, atol=1e-14,
+                                           err_msg="expKappa is not symmetric")
+                np.testing.assert_allclose(expKappa @ np.array(hfm.expKappa(species, not inv)),
+                                           np.eye(nx), rtol=0, atol=1e-12,
+                                           err_msg="expKappa(inv) is not the inverse of expKappa")
+                np.testing.assert_allclose(expKappa, np.array(hfmExp.expKappa(species, inv)),
+                                           rtol=0, atol=tolerance,
+                                           err_msg="Failed check of expKappa against exact exponential"
+                                           + "\nfor nt={}, mu={}, sigmaKappa={}, species={}, inv={}"
+                                           .format(nt, mu, sigmaKappa, species, inv))
+
+            phi = _randomPhi(nx * nt)
+            vecs = np.array([_randomPhi(nx * nt) for _ in range(3)])
+            for species in (isle.Species.PARTICLE, isle.Species.HOLE):
+                for t in range(nt):
+                    np.testing.assert_allclose(np.array(isle.Matrix(hfm.F(t, phi, species, False)))
+                                               @ np.array(isle.Matrix(hfm.F(t, phi, species, True))),
+                                               np.eye(nx), rtol=0, atol=1e-12,
+                                               err_msg="F(inv=True) is not the inverse of F")
+
+                M = np.array(isle.Matrix(hfm.M(phi, species)), copy=False)
+                sign, logabs = np.linalg.slogdet(M)
+                for interval in (0, 3):
+                    ld = isle.logdetM(hfm, phi, species, interval)
+                    self.assertAlmostEqual(ld.real, logabs, places=8,
+                                           msg="Failed check of real part of logdetM"
+                                           + "\nfor nt={}, mu={}, sigmaKappa={}, species={}"
+                                           .format(nt, mu, sigmaKappa, species))
+                    self.assertAlmostEqual(np.exp(1j*ld.imag), sign, places=8,
+                                           msg="Failed check of imaginary part of logdetM"
+                                           + "\nfor nt={}, mu={}, sigmaKappa={}, species={}"
+                                           .format(nt, mu, sigmaKappa, species))
+
+                for dagger in (False, True):
+                    dense = M.T.conj() if dagger else M
+                    res = np.array(isle.applyM(hfm, phi, species, isle.Vector(vecs[0]), dagger),
+                                   copy=False)
+                    np.testing.assert_allclose(res, dense @ vecs[0], rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of applyM for checkerboard"
+                                               + "\nfor nt={}, sigmaKappa={}, species={}, dagger={}"
+                                               .format(nt, sigmaKappa, species, dagger))
+                    res = np.array(isle.applyM(hfm, phi, species, isle.Matrix(vecs), dagger),
+                                   copy=False)
+                    np.testing.assert_allclose(res, vecs @ dense.T, rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of applyM to many vectors for checkerboard"
+                                               + "\nfor nt={}, sigmaKappa={}, species={}, dagger={}"
+                                               .format(nt, sigmaKappa, species, dagger))
+
+    def test_4_checkerboard(self):
+        "Test the checkerboard discretization of the hopping term."
+        logger = core.get_logger()
+        for lattice in self.lattices:
+            logger.info("Testing HubbardFermiMatrixCheckerboard on %s", lattice.name)
+            self._test_checkerboard(lattice.hopping())
+
+
+    def test_5_expUpdates(self):
+        "Test updates of parameters of HubbardFermiMatrixExp that re-use the eigendecomposition."
+
+        for lattice in self.lattices:
+            kappa = lattice.hopping()
+            evals, evecs = np.linalg.eigh(np.array(isle.Matrix(kappa), copy=False))
+
+            scale = 1 / 8
+            hfm = isle.HubbardFermiMatrixExp(kappa * scale, 0.1, -1)
+            for beta, mu, sigmaKappa in ((4, 0.3, -1), (4, 0.3, 1), (2, -0.2, 1), (8, 0, -1)):
+                hfm.scaleKappaTilde(beta / 8 / scale)
+                scale = beta / 8
+                hfm.updateMuTilde(mu)
+                hfm.updateSigmaKappa(sigmaKappa)
+
+                for species, inv in product((isle.Species.PARTICLE, isle.Species.HOLE), (False, True)):
+                    kappaSign = 1 if species == isle.Species.PARTICLE else sigmaKappa
+                    muSign = -1 if species == isle.Species.PARTICLE else 1
+                    exponent = (kappaSign*scale*evals + muSign*mu) * (-1 if inv else 1)
+                    expected = evecs @ np.diag(np.exp(exponent)) @ evecs.T
+                    np.testing.assert_allclose(np.array(hfm.expKappa(species, inv), copy=False),
+                                               expected, rtol=1e-10, atol=1e-12,
+                                               err_msg="Failed check of expKappa after update "
+                                               + "to beta={}, mu={}, sigmaKappa={}, species={}, inv={} on {}"
+                                               .format(beta, mu, sigmaKappa, species, inv, lattice.name))
+                    self.assertAlmostEqual(hfm.logdetExpKappa(species, inv), np.sum(exponent), places=10,
+                                           msg="Failed check of logdetExpKappa after update "
+                                           + "to beta={}, mu={}, sigmaKappa={}, species={}, inv={} on {}"
+                                           .format(beta, mu, sigmaKappa, species, inv, lattice.name))
+
+            # a new hopping matrix is diagonalized from scratch
+            hfm.updateKappaTilde(kappa / 3)
+            np.testing.assert_allclose(np.array(hfm.expKappa(isle.Species.PARTICLE, False), copy=False),
+                                       evecs @ np.diag(np.exp(evals/3)) @ evecs.T,
+                                       rtol=1e-10, atol=1e-12,
+                                       err_msg="Failed check of expKappa after updateKappaTilde on {}"
+                                       .format(lattice.name))
+
+
+    def test_6_muScan(self):
+        "Test scans in chemical potential and canonical projections from transfer matrix eigenvalues."
+
+        nt = 6
+        muTildes = np.array([-0.3, -0.05, 0, 0.1, 0.4])
+        for lattice, interval in product(self.lattices, (0, 3)):
+            kappa = lattice.hopping()
+            nx = kappa.rows()
+            phi = _randomPhi(nx*nt)
+            hfm = isle.HubbardFermiMatrixExp(kappa/nt, 0.7, -1)
+
+            logEigenvalues = {}
+            for species in (isle.Species.PARTICLE, isle.Species.HOLE):
+                logEigenvalues[species] = isle.logTransferMatrixEigenvalues(hfm, phi, species, interval)
+                scan = np.array(isle.logdetMScan(logEigenvalues[species], nt, species,
+                                                 isle.Vector(muTildes)), copy=False)
+                for muTilde, logdet in zip(muTildes, scan):
+                    expected = isle.logdetM(isle.HubbardFermiMatrixExp(kappa/nt, muTilde, -1),
+                                            phi, species)
+                    msg = "Failed check of logdetMScan for mu={}, species={}, interval={} on {}" \
+                        .format(muTilde, species, interval, lattice.name)
+                    self.assertAlmostEqual(logdet.real, expected.real, places=8, msg=msg)
+                    self.assertAlmostEqual(np.exp(1j*logdet.imag), np.exp(1j*expected.imag),
+                                           places=8, msg=msg)
+
+            logZ = np.array(isle.logCanonicalProjections(logEigenvalues[isle.Species.PARTICLE],
+                                                         logEigenvalues[isle.Species.HOLE]), copy=False)
+            self.assertEqual(len(logZ), 2*nx+1)
+            charges = np.arange(-nx, nx+1)
+            nonempty = np.isfinite(logZ.real)
+            for muTilde in muTildes:
+                # sum over sectors in log space to avoid overflow on large lattices
+                terms = logZ[nonempty] - nt*muTilde*charges[nonempty]
+                shift = np.max(terms.real)
+                total = shift + np.log(np.sum(np.exp(terms - shift)))
+                expected = sum(isle.logdetM(isle.HubbardFermiMatrixExp(kappa/nt, muTilde, -1),
+                                            phi, species)
+                               for species in (isle.Species.PARTICLE, isle.Species.HOLE))
+                msg = "Failed check of logCanonicalProjections for mu={}, interval={} on {}" \
+                    .format(muTilde, interval, lattice.name)
+                self.assertAlmostEqual(total.real, expected.real, places=8, msg=msg)
+                self.assertAlmostEqual(np.exp(1j*total.imag), np.exp(1j*expected.imag),
+                                       places=8, msg=msg)
+
+    def test_7_muScanLargeBeta(self):
+        "Test stabilized transfer matrix eigenvalues at low temperature where they span many orders of magnitude."
+
+        lattice = isle.LATTICES["c20"]
+        nt, beta, interval = 64, 16, 8
+        kappa = lattice.hopping()
+        nx = kappa.rows()
+        muTildes = np.array([-0.2, 0, 0.1, 0.3]) * beta / nt
+        phi = _randomPhi(nx*nt)
+        hfm = isle.HubbardFermiMatrixExp(kappa*beta/nt, 0, -1)
+
+        logEigenvalues = {}
+        for species in (isle.Species.PARTICLE, isle.Species.HOLE):
+            logEigenvalues[species] = isle.logTransferMatrixEigenvalues(hfm, phi, species, interval)
+            scan = np.array(isle.logdetMScan(logEigenvalues[species], nt, species,
+                                             isle.Vector(muTildes)), copy=False)
+            for muTilde, logdet in zip(muTildes, scan):
+                expected = isle.logdetM(isle.HubbardFermiMatrixExp(kappa*beta/nt, muTilde, -1),
+                                        phi, species, interval)
+                # compare ratio of determinants, log det is large here
+                self.assertAlmostEqual(np.exp(logdet - expected), 1, places=6,
+                                       msg="Failed check of logdetMScan at large beta "
+                                       f"for mu={muTilde}, species={species}")
+
+        logZ = np.array(isle.logCanonicalProjections(logEigenvalues[isle.Species.PARTICLE],
+                                                     logEigenvalues[isle.Species.HOLE]), copy=False)
+        charges = np.arange(-nx, nx+1)
+        nonempty = np.isfinite(logZ.real)
+        for muTilde in muTildes:
+            terms = logZ[nonempty] - nt*muTilde*charges[nonempty]
+            shift = np.max(terms.real)
+            total = shift + np.log(np.sum(np.exp(terms - shift)))
+            expected = sum(isle.logdetM(isle.HubbardFermiMatrixExp(kappa*beta/nt, muTilde, -1),
+                                        phi, species, interval)
+                           for species in (isle.Species.PARTICLE, isle.Species.HOLE))
+            self.assertAlmostEqual(np.exp(total - expected), 1, places=6,
+                                   msg="Failed check of logCanonicalProjections at large beta "
+                                   f"for mu={muTilde}")
 
 
 def setUpModule():